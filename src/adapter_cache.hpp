@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_plan.hpp"
+#include "errors.hpp"
+#include "random.hpp"
+#include <array>
+#include <cmath>
+
+// Resident low-rank adapters of one model instance - active only with adapter_capacity_type above zero
+// adapter_capacity slots live in one arena sized by memory_plan; acquire() maps an adapter id to a slot, loading it into the
+// least recently used unpinned slot on a miss, and pins it until release(). Adapter 0 is the base model and never takes a slot
+template<typename config_type, typename shape_type> struct adapter_cache {
+	static constexpr bool active{ config_type::adapter_capacity > 0 };
+	static constexpr uint64_t capacity{ config_type::adapter_capacity };
+	static constexpr uint64_t rank{ config_type::adapter_rank };
+	static constexpr uint64_t layer_count{ shape_type::layer_count };
+	static constexpr uint64_t embedding_dim{ shape_type::embedding_dim };
+	static constexpr uint64_t kv_dim{ shape_type::kv_dim };
+	static constexpr uint64_t base_adapter_id{ 0 };
+	// One past the last slot - rows carrying it are left to the base weights by the segmented update
+	static constexpr uint32_t no_slot{ static_cast<uint32_t>(capacity) };
+
+	using plan_type = memory_plan<config_type, shape_type>;
+
+	// Down projections are rank x embedding_dim, up projections rank x output rows
+	struct layer_adapter {
+		float* query_down{};
+		float* query_up{};
+		float* value_down{};
+		float* value_up{};
+	};
+
+	struct slot_entry {
+		uint64_t adapter_id{};
+		uint64_t last_use{};
+		uint32_t pin_count{};
+		bool loaded{};
+	};
+
+	memory_arena arena{ plan_type::layout.adapter_bytes };
+	std::array<std::array<layer_adapter, layer_count>, capacity> layers{};
+	std::array<slot_entry, capacity> entries{};
+	uint64_t use_clock{};
+	uint64_t hit_count{};
+	uint64_t load_count{};
+	uint64_t eviction_count{};
+
+	// Allocation order must match compute_adapter_slot_bytes
+	adapter_cache() {
+		if (!arena.valid()) {
+			raise_runtime_error<config_type::exceptions>("adapter_cache: failed to reserve the adapter arena");
+		}
+		for (auto& slot_layers: layers) {
+			for (layer_adapter& layer: slot_layers) {
+				layer.query_down = arena.allocate<float>(rank * embedding_dim);
+				layer.query_up	 = arena.allocate<float>(rank * embedding_dim);
+				layer.value_down = arena.allocate<float>(rank * embedding_dim);
+				layer.value_up	 = arena.allocate<float>(rank * kv_dim);
+			}
+		}
+	}
+
+	// Slot holding adapter_id, pinned once more - a miss loads it over the least recently used slot nobody has pinned
+	// The capacity is validated against max_batch_size, so an engine that releases what it acquires always finds a slot
+	uint32_t acquire(uint64_t adapter_id) {
+		++use_clock;
+		uint32_t victim{ no_slot };
+		for (uint32_t slot = 0; slot < capacity; ++slot) {
+			slot_entry& entry{ entries[slot] };
+			if (entry.loaded && entry.adapter_id == adapter_id) {
+				++entry.pin_count;
+				entry.last_use = use_clock;
+				++hit_count;
+				return slot;
+			}
+			if (entry.pin_count == 0 && (victim == no_slot || entry.last_use < entries[victim].last_use)) {
+				victim = slot;
+			}
+		}
+		if (victim == no_slot) {
+			raise_runtime_error<config_type::exceptions>("adapter_cache::acquire: every adapter slot is pinned");
+		}
+		eviction_count += entries[victim].loaded;
+		load(victim, adapter_id);
+		entries[victim] = slot_entry{ adapter_id, use_clock, 1, true };
+		++load_count;
+		return victim;
+	}
+
+	OACC_INLINE void release(uint32_t slot) noexcept {
+		--entries[slot].pin_count;
+	}
+
+	OACC_INLINE const layer_adapter& layer(uint32_t slot, uint64_t layer_index) const noexcept {
+		return layers[slot][layer_index];
+	}
+
+	// Stand-in for reading adapter weights from storage - deterministic per adapter id, so a reloaded adapter is bit-identical
+	// The LoRA alpha / rank scale is folded into the up projections
+	void load(uint32_t slot, uint64_t adapter_id) noexcept {
+		random_generator generator{ fingerprint_values(shape_type::weight_seed, adapter_id) };
+		const auto fill = [&](float* values, uint64_t count, float scale) {
+			for (uint64_t index = 0; index < count; ++index) {
+				values[index] = (generator.next_float() * 2.0f - 1.0f) * scale;
+			}
+		};
+		const float down_scale{ 1.0f / std::sqrt(static_cast<float>(embedding_dim)) };
+		const float up_scale{ 1.0f / std::sqrt(static_cast<float>(rank)) };
+		for (layer_adapter& layer: layers[slot]) {
+			fill(layer.query_down, rank * embedding_dim, down_scale);
+			fill(layer.query_up, rank * embedding_dim, up_scale);
+			fill(layer.value_down, rank * embedding_dim, down_scale);
+			fill(layer.value_up, rank * kv_dim, up_scale);
+		}
+	}
+};
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include "engine_host.hpp"
+#include <thread>
+
+// Multi-model co-hosting - three engines with different shapes and limits, each serving --requests synthetic requests, driven
+// three ways over the same engine instances: stepped in turn by one thread (serial), one thread per engine (thread_per_engine,
+// oversubscribed once engines outnumber CPUs) and the engine_host's shared pool. tokens_per_second is summed over all engines
+
+inline constexpr model_shape host_small_shape{ generate_model_shape(layer_count_type{ 2 }, head_count_type{ 4 }, kv_head_count_type{ 2 }, head_dim_type{ 32 },
+	vocab_size_type{ 2048 }) };
+
+inline constexpr model_config host_small_config{ generate_model_config(max_batch_size_type{ 8 }, max_context_length_type{ 256 }) };
+
+using host_engine_types = std::tuple<engine<stand_in_model<model_config_type<sweep_config<4, sweep_context_lengths[0]>>, model_shape_type<sweep_shape>>>,
+	engine<stand_in_model<model_config_type<sweep_config<16, sweep_context_lengths[0]>>, model_shape_type<sweep_shape>>>,
+	engine<stand_in_model<model_config_type<host_small_config>, model_shape_type<host_small_shape>>>>;
+
+template<typename engine_tuple> struct host_bench_type;
+
+template<typename... engine_types> struct host_bench_type<std::tuple<engine_types...>> {
+	using type = engine_host<unbounded_memory_bytes, engine_types...>;
+};
+
+using host_type = typename host_bench_type<host_engine_types>::type;
+
+inline void count_host_tokens(void* context, uint64_t, std::span<const token_event> events) {
+	static_cast<std::atomic<uint64_t>*>(context)->fetch_add(events.size(), std::memory_order_relaxed);
+}
+
+template<uint64_t index> void submit_host_workload(host_type& host, const synthetic_workload& workload, bool through_host) {
+	for (uint64_t request_index = 0; request_index < workload.requests.size(); ++request_index) {
+		const synthetic_request& request{ workload.requests[request_index] };
+		const request_params params{ request_index, nullptr, 0, request.generation_length, sampling_params{}, request_index, request.prompt };
+		if (through_host) {
+			host.template submit<index>(params);
+		} else {
+			host.template get<index>().submit(params);
+		}
+	}
+}
+
+// Steps engine index until it is idle, returning the tokens it produced
+template<uint64_t index> uint64_t drain_host_engine(host_type& host) {
+	uint64_t return_value{};
+	auto& instance{ host.template get<index>() };
+	while (!instance.idle()) {
+		return_value += instance.step().size();
+	}
+	return return_value;
+}
+
+template<uint64_t... indices> benchmark_result run_host_entry(const bench_options& options, std::index_sequence<indices...>) {
+	benchmark_result result{};
+	result.name = "host/engines_" + std::to_string(host_type::engine_count);
+	for (const uint64_t fingerprint: { fingerprint_values(std::tuple_element_t<indices, host_engine_types>::config_type::fingerprint,
+			 std::tuple_element_t<indices, host_engine_types>::shape_type::fingerprint)... }) {
+		result.fingerprint = fingerprint_values(result.fingerprint, fingerprint);
+	}
+	std::atomic<uint64_t> host_tokens{};
+	host_type host{ &count_host_tokens, &host_tokens };
+	result.parameters = { { "engine_count", host_type::engine_count }, { "worker_count", host.pool.worker_count() }, { "cpu_count", read_host_resources().cpu_count() },
+		{ "requests_per_engine", options.request_count } };
+	benchmark_metric& serial{ result.add_metric("serial_tokens_per_second", "tok/s", true) };
+	benchmark_metric& threaded{ result.add_metric("thread_per_engine_tokens_per_second", "tok/s", true) };
+	benchmark_metric& pooled{ result.add_metric("tokens_per_second", "tok/s", true) };
+	benchmark_metric& steals{ result.add_metric("steals", "tasks", false) };
+
+	std::cerr << "running " << result.name << std::endl;
+	synthetic_workload workload{};
+	workload.generate(options.request_count, options.seed);
+	const auto tokens_per_second = [](uint64_t tokens, uint64_t elapsed_ns) {
+		return static_cast<double>(tokens) * 1.0e9 / static_cast<double>(std::max<uint64_t>(elapsed_ns, 1));
+	};
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const bool record{ repetition >= options.warmup_repetitions };
+
+		(submit_host_workload<indices>(host, workload, false), ...);
+		uint64_t start_ns{ monotonic_nanoseconds() };
+		uint64_t tokens{};
+		while (!(host.template get<indices>().idle() && ...)) {
+			((tokens += host.template get<indices>().step().size()), ...);
+		}
+		const double serial_rate{ tokens_per_second(tokens, monotonic_nanoseconds() - start_ns) };
+
+		(submit_host_workload<indices>(host, workload, false), ...);
+		std::array<uint64_t, host_type::engine_count> thread_tokens{};
+		start_ns = monotonic_nanoseconds();
+		{
+			std::array<std::thread, host_type::engine_count> threads{ std::thread{ [&] {
+				thread_tokens[indices] = drain_host_engine<indices>(host);
+			} }... };
+			for (std::thread& thread: threads) {
+				thread.join();
+			}
+		}
+		const double threaded_rate{ tokens_per_second((thread_tokens[indices] + ...), monotonic_nanoseconds() - start_ns) };
+
+		host_tokens.store(0);
+		const uint64_t start_steals{ host.pool.steal_count.load() };
+		start_ns = monotonic_nanoseconds();
+		(submit_host_workload<indices>(host, workload, true), ...);
+		host.wait_idle();
+		const double pooled_rate{ tokens_per_second(host_tokens.load(), monotonic_nanoseconds() - start_ns) };
+
+		if (record) {
+			serial.samples.emplace_back(serial_rate);
+			threaded.samples.emplace_back(threaded_rate);
+			pooled.samples.emplace_back(pooled_rate);
+			steals.samples.emplace_back(static_cast<double>(host.pool.steal_count.load() - start_steals));
+		}
+	}
+	return result;
+}
+
+inline benchmark_report run_host_suite(const bench_options& options) {
+	benchmark_report report{ "host", {} };
+	report.results.emplace_back(run_host_entry(options, std::make_index_sequence<host_type::engine_count>{}));
+	return report;
+}
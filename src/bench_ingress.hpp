@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include "json_reader.hpp"
+#include "json_writer.hpp"
+#include "request_reader.hpp"
+#include <cmath>
+#include <numbers>
+
+// Request parsing at ingress - the same corpus of request bodies parsed by parse_request() (on_demand) and by parse_json()
+// into a DOM, the per-node allocating parser it replaces for requests. Prompts are printable text with a newline or quote
+// now and then, so most bodies carry escapes, and their lengths are log-normal around each entry's median. Throughput is
+// body bytes per second; on_demand passes start from a fresh copy of the corpus, as it decodes escapes in place, and the copy
+// is not timed
+
+inline constexpr uint64_t ingress_median_prompt_bytes[]{ 256, 16384 };
+inline constexpr uint64_t ingress_corpus_bytes{ 4ull << 20 };
+
+struct ingress_corpus {
+	std::string bytes{};
+	std::vector<uint64_t> offsets{ 0 };
+	uint64_t prompt_bytes{};
+};
+
+inline ingress_corpus generate_ingress_corpus(uint64_t median_prompt_bytes, uint64_t seed) {
+	random_generator generator{ seed };
+	ingress_corpus corpus{};
+	std::string prompt{};
+	for (uint64_t id = 0; corpus.bytes.size() < ingress_corpus_bytes; ++id) {
+		const double normal{ std::sqrt(-2.0 * std::log(static_cast<double>(generator.next_float()) + 0x1p-25)) *
+			std::cos(2.0 * std::numbers::pi * static_cast<double>(generator.next_float())) };
+		prompt.resize(std::max<uint64_t>(static_cast<uint64_t>(static_cast<double>(median_prompt_bytes) * std::exp(0.5 * normal)), 1));
+		for (char& character: prompt) {
+			const uint64_t draw{ generator.next_below(128) };
+			character = draw == 0 ? '\n' : draw == 1 ? '"' : static_cast<char>(' ' + draw % 95);
+		}
+		json_writer writer{};
+		writer.begin_object();
+		writer.member("id", id);
+		writer.member("prompt", std::string_view{ prompt });
+		writer.member("max_tokens", uint64_t{ 64 });
+		writer.member("temperature", 0.7);
+		writer.member("top_k", uint64_t{ 40 });
+		writer.member("seed", generator.next_below(1u << 31));
+		writer.end_object();
+		corpus.bytes += writer.buffer;
+		corpus.offsets.emplace_back(corpus.bytes.size());
+		corpus.prompt_bytes += prompt.size();
+	}
+	return corpus;
+}
+
+inline benchmark_result run_ingress_entry(const bench_options& options, uint64_t median_prompt_bytes) {
+	benchmark_result result{};
+	result.name		   = "ingress/prompt_" + std::to_string(median_prompt_bytes);
+	result.fingerprint = fingerprint_values(median_prompt_bytes, ingress_corpus_bytes);
+	result.parameters  = { { "median_prompt_bytes", median_prompt_bytes }, { "corpus_bytes", ingress_corpus_bytes } };
+	benchmark_metric& on_demand{ result.add_metric("on_demand_gb_per_second", "GB/s", true) };
+	benchmark_metric& on_demand_requests{ result.add_metric("on_demand_requests_per_second", "requests/s", true) };
+	benchmark_metric& dom{ result.add_metric("dom_gb_per_second", "GB/s", true) };
+
+	std::cerr << "running " << result.name << std::endl;
+	const ingress_corpus corpus{ generate_ingress_corpus(median_prompt_bytes, options.seed) };
+	const uint64_t request_count{ corpus.offsets.size() - 1 };
+	const double gigabytes{ static_cast<double>(corpus.bytes.size()) / 1.0e9 };
+	std::string work{};
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		work = corpus.bytes;
+		uint64_t prompt_bytes{};
+		const bench_clock::time_point on_demand_start{ bench_clock::now() };
+		for (uint64_t index = 0; index < request_count; ++index) {
+			request_params request{};
+			const std::span<char> body{ work.data() + corpus.offsets[index], corpus.offsets[index + 1] - corpus.offsets[index] };
+			if (parse_request(body, request) == request_parse_status::ok) {
+				prompt_bytes += request.prompt_text.size();
+			}
+		}
+		const double on_demand_seconds{ elapsed_seconds(on_demand_start, bench_clock::now()) };
+
+		uint64_t dom_prompt_bytes{};
+		const bench_clock::time_point dom_start{ bench_clock::now() };
+		for (uint64_t index = 0; index < request_count; ++index) {
+			json_value document{};
+			const std::string_view body{ corpus.bytes.data() + corpus.offsets[index], corpus.offsets[index + 1] - corpus.offsets[index] };
+			if (parse_json(body, document)) {
+				const json_value* prompt{ document.find("prompt") };
+				dom_prompt_bytes += prompt ? prompt->string.size() : 0;
+			}
+		}
+		const double dom_seconds{ elapsed_seconds(dom_start, bench_clock::now()) };
+
+		if (prompt_bytes != corpus.prompt_bytes || dom_prompt_bytes != corpus.prompt_bytes) {
+			std::cerr << "ingress: parsed prompts do not match the corpus\n";
+			return result;
+		}
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		on_demand.samples.emplace_back(gigabytes / on_demand_seconds);
+		on_demand_requests.samples.emplace_back(static_cast<double>(request_count) / on_demand_seconds);
+		dom.samples.emplace_back(gigabytes / dom_seconds);
+	}
+	return result;
+}
+
+inline benchmark_report run_ingress_suite(const bench_options& options) {
+	benchmark_report report{ "ingress", {} };
+	for (const uint64_t median_prompt_bytes: ingress_median_prompt_bytes) {
+		report.results.emplace_back(run_ingress_entry(options, median_prompt_bytes));
+	}
+	return report;
+}
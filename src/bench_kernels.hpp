@@ -0,0 +1,494 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include "memory_arena.hpp"
+#include "memory_plan.hpp"
+#include "kernels.hpp"
+#include "weight_format.hpp"
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+#endif
+
+// Kernel microbenchmarks - every kernel of the stand-in model at the shapes one configuration of the sweep grid implies,
+// reported against a roofline measured on the local machine
+
+// Operands the model streams from memory (weights, KV cache) are rotated through enough copies to exceed the last level
+// cache, as they are across layers and slots in a real step; activations stay hot
+// Twice the reported last level cache, never less than 64 MiB
+inline uint64_t kernel_cold_bytes() noexcept {
+	uint64_t cache_bytes{};
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+	cache_bytes = static_cast<uint64_t>(std::max<long>(0, sysconf(_SC_LEVEL3_CACHE_SIZE)));
+#endif
+	return std::max<uint64_t>(64ull * 1024 * 1024, 2 * cache_bytes);
+}
+
+inline constexpr double kernel_min_sample_seconds{ 0.002 };
+
+// Machine ceilings measured once per run with the same compiler flags as the kernels, so a kernel's distance to them is
+// the headroom left in the code rather than in the instruction set the build targets
+// The memory roof is the better of STREAM triad and a read-only sweep - weight streaming is almost entirely reads
+struct roofline_baseline {
+	double triad_gb_per_second{};
+	double read_gb_per_second{};
+	double peak_gflop_per_second{};
+
+	double memory_gb_per_second() const noexcept {
+		return std::max(triad_gb_per_second, read_gb_per_second);
+	}
+
+	// min(peak compute, arithmetic intensity * bandwidth)
+	double attainable_gflop_per_second(double flop_count, double byte_count) const noexcept {
+		return std::min(peak_gflop_per_second, flop_count / byte_count * memory_gb_per_second());
+	}
+};
+
+// STREAM triad a = b + s * c, counted as three streams like STREAM does, and a single-stream read-only sweep over b
+// Each array is half of kernel_cold_bytes(), so the working set is well past the last level cache
+inline void measure_stream_bandwidth(uint64_t repetitions, roofline_baseline& baseline) {
+	// Enough independent sums that the read sweep is bound by memory rather than by add latency
+	constexpr uint64_t read_lane_count{ 32 };
+	const uint64_t element_count{ align_up(kernel_cold_bytes() / 2 / sizeof(float), read_lane_count) };
+	memory_arena arena{ 3 * arena_bytes<float>(element_count) };
+	float* a{ arena.allocate<float>(element_count) };
+	float* b{ arena.allocate<float>(element_count) };
+	float* c{ arena.allocate<float>(element_count) };
+	for (uint64_t index = 0; index < element_count; ++index) {
+		a[index] = 0.0f;
+		b[index] = 1.0f;
+		c[index] = 2.0f;
+	}
+	volatile float scale_source{ 3.0f };
+	const float scale{ scale_source };
+	double best_triad_seconds{ std::numeric_limits<double>::max() };
+	double best_read_seconds{ std::numeric_limits<double>::max() };
+	float read_sum{};
+	for (uint64_t repetition = 0; repetition < repetitions + 1; ++repetition) {
+		bench_clock::time_point start{ bench_clock::now() };
+		for (uint64_t index = 0; index < element_count; ++index) {
+			a[index] = b[index] + scale * c[index];
+		}
+		best_triad_seconds = std::min(best_triad_seconds, elapsed_seconds(start, bench_clock::now()));
+		start			   = bench_clock::now();
+		float read_lanes[read_lane_count]{};
+		for (uint64_t index = 0; index < element_count; index += read_lane_count) {
+			for (uint64_t lane = 0; lane < read_lane_count; ++lane) {
+				read_lanes[lane] += b[index + lane];
+			}
+		}
+		for (const float lane_sum: read_lanes) {
+			read_sum += lane_sum;
+		}
+		best_read_seconds = std::min(best_read_seconds, elapsed_seconds(start, bench_clock::now()));
+	}
+	volatile float sink{ a[element_count - 1] + read_sum };
+	static_cast<void>(sink);
+	baseline.triad_gb_per_second = static_cast<double>(3 * element_count * sizeof(float)) / best_triad_seconds / 1.0e9;
+	baseline.read_gb_per_second	 = static_cast<double>(element_count * sizeof(float)) / best_read_seconds / 1.0e9;
+}
+
+// Independent multiply-add chains wide enough to hide latency but small enough to stay in registers
+inline void measure_peak_flops(uint64_t repetitions, roofline_baseline& baseline) {
+	constexpr uint64_t lane_count{ 48 };
+	constexpr uint64_t iteration_count{ 1ull << 22 };
+	volatile float multiplier_source{ 0.999999f };
+	volatile float addend_source{ 1.0e-7f };
+	const float multiplier{ multiplier_source };
+	const float addend{ addend_source };
+	float accumulators[lane_count];
+	double best_seconds{ std::numeric_limits<double>::max() };
+	for (uint64_t repetition = 0; repetition < repetitions + 1; ++repetition) {
+		for (uint64_t lane = 0; lane < lane_count; ++lane) {
+			accumulators[lane] = static_cast<float>(lane) * 0.001f;
+		}
+		const bench_clock::time_point start{ bench_clock::now() };
+		for (uint64_t iteration = 0; iteration < iteration_count; ++iteration) {
+			for (uint64_t lane = 0; lane < lane_count; ++lane) {
+				accumulators[lane] = accumulators[lane] * multiplier + addend;
+			}
+		}
+		best_seconds = std::min(best_seconds, elapsed_seconds(start, bench_clock::now()));
+	}
+	float sum{};
+	for (uint64_t lane = 0; lane < lane_count; ++lane) {
+		sum += accumulators[lane];
+	}
+	volatile float sink{ sum };
+	static_cast<void>(sink);
+	baseline.peak_gflop_per_second = static_cast<double>(2 * lane_count * iteration_count) / best_seconds / 1.0e9;
+}
+
+// Cold operands fill their first copy from the generator and replicate it
+struct kernel_operand {
+	memory_arena arena{};
+	float* data{};
+	uint64_t element_count{};
+	uint64_t copy_count{};
+
+	kernel_operand(uint64_t element_count_new, bool cold, random_generator& generator)
+		: element_count{ element_count_new },
+		  copy_count{ cold ? std::max<uint64_t>(1, kernel_cold_bytes() / (element_count_new * sizeof(float))) : 1 } {
+		arena = memory_arena{ copy_count * arena_bytes<float>(element_count) };
+		data  = arena.allocate<float>(copy_count * element_count);
+		for (uint64_t index = 0; index < element_count; ++index) {
+			data[index] = generator.next_float() - 0.5f;
+		}
+		for (uint64_t copy_index = 1; copy_index < copy_count; ++copy_index) {
+			std::memcpy(data + copy_index * element_count, data, element_count * sizeof(float));
+		}
+	}
+
+	OACC_INLINE float* copy(uint64_t rotation) const noexcept {
+		return data + (rotation % copy_count) * element_count;
+	}
+};
+
+// A cold rows x cols matrix in one weight format - quantized once from f32, then replicated like kernel_operand
+template<typename format_type, uint64_t rows, uint64_t cols> struct quantized_operand {
+	using storage_type = typename format_type::storage_type;
+
+	static constexpr uint64_t storage_count{ rows * format_type::template row_stride<cols> };
+
+	memory_arena arena{};
+	storage_type* data{};
+	uint64_t copy_count{ std::max<uint64_t>(1, kernel_cold_bytes() / (storage_count * sizeof(storage_type))) };
+
+	explicit quantized_operand(random_generator& generator) {
+		arena = memory_arena{ copy_count * arena_bytes<storage_type>(storage_count) };
+		data  = arena.allocate<storage_type>(copy_count * storage_count);
+		std::vector<float> row_values(cols);
+		for (uint64_t row = 0; row < rows; ++row) {
+			for (float& value: row_values) {
+				value = generator.next_float() - 0.5f;
+			}
+			format_type::template quantize<cols>(data + row * format_type::template row_stride<cols>, row_values.data());
+		}
+		for (uint64_t copy_index = 1; copy_index < copy_count; ++copy_index) {
+			std::memcpy(data + copy_index * storage_count, data, storage_count * sizeof(storage_type));
+		}
+	}
+
+	OACC_INLINE const storage_type* copy(uint64_t rotation) const noexcept {
+		return data + (rotation % copy_count) * storage_count;
+	}
+
+	static constexpr uint64_t bytes() noexcept {
+		return storage_count * sizeof(storage_type);
+	}
+};
+
+// Times one kernel call - the iteration count is calibrated so each sample lasts at least kernel_min_sample_seconds
+// Kernels that only move data pass flop_count 0 - their roofline fraction is achieved over measured memory bandwidth
+template<typename kernel_function> void run_kernel_benchmark(benchmark_report& report, benchmark_result result, const roofline_baseline& baseline,
+	const bench_options& options, double flop_count, double byte_count, kernel_function&& kernel) {
+	result.parameters.emplace_back("flop_count", static_cast<uint64_t>(flop_count));
+	result.parameters.emplace_back("byte_count", static_cast<uint64_t>(byte_count));
+	benchmark_metric& time{ result.add_metric("time_us", "us", false) };
+	benchmark_metric& gflops{ result.add_metric("gflop_per_second", "GFLOP/s", true) };
+	benchmark_metric& bandwidth{ result.add_metric("gb_per_second", "GB/s", true) };
+	benchmark_metric& roofline{ result.add_metric("roofline_fraction", "fraction", true) };
+
+	// Keeps advancing across samples so cold operands never restart from the copies the previous sample left in cache
+	uint64_t rotation{};
+	uint64_t iteration_count{ 1 };
+	for (;;) {
+		const bench_clock::time_point start{ bench_clock::now() };
+		for (uint64_t iteration = 0; iteration < iteration_count; ++iteration) {
+			kernel(rotation++);
+		}
+		if (elapsed_seconds(start, bench_clock::now()) >= kernel_min_sample_seconds) {
+			break;
+		}
+		iteration_count *= 2;
+	}
+	const double attainable{ baseline.attainable_gflop_per_second(flop_count, byte_count) };
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const bench_clock::time_point start{ bench_clock::now() };
+		for (uint64_t iteration = 0; iteration < iteration_count; ++iteration) {
+			kernel(rotation++);
+		}
+		const double seconds{ elapsed_seconds(start, bench_clock::now()) / static_cast<double>(iteration_count) };
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		time.samples.emplace_back(seconds * 1.0e6);
+		gflops.samples.emplace_back(flop_count / seconds / 1.0e9);
+		bandwidth.samples.emplace_back(byte_count / seconds / 1.0e9);
+		roofline.samples.emplace_back(flop_count > 0.0 ? flop_count / seconds / 1.0e9 / attainable : byte_count / seconds / 1.0e9 / baseline.memory_gb_per_second());
+	}
+	report.results.emplace_back(std::move(result));
+}
+
+// Every kernel of one forward step at the shapes config and sweep_shape imply:
+// decode GEMVs at max_batch_size tokens, the prefill GEMMs at prefill_chunk_length tokens, attention over max_context_length,
+// embedding gathers from one prefill chunk up to a prefill of every slot at max_prompt_length
+template<const model_config& config> void run_kernel_entry(const bench_options& options, const roofline_baseline& baseline, benchmark_report& report) {
+	using config_type = model_config_type<config>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using plan_type	  = memory_plan<config_type, shape_type>;
+
+	static constexpr uint64_t batch_size{ config_type::max_batch_size };
+	static constexpr uint64_t context_length{ config_type::max_context_length };
+	static constexpr uint64_t chunk_length{ plan_type::prefill_chunk_length };
+	static constexpr uint64_t embedding_dim{ shape_type::embedding_dim };
+	static constexpr uint64_t ffn_dim{ shape_type::ffn_dim };
+	static constexpr uint64_t vocab_size{ shape_type::vocab_size };
+	static constexpr uint64_t head_dim{ shape_type::head_dim };
+	static constexpr uint64_t head_count{ shape_type::head_count };
+	static constexpr uint64_t kv_dim{ shape_type::kv_dim };
+	static constexpr uint64_t kv_group_size{ shape_type::kv_group_size };
+	static constexpr double float_bytes{ sizeof(float) };
+
+	const std::string prefix{ "kernels/batch_" + std::to_string(batch_size) + "/context_" + std::to_string(context_length) + "/" };
+	const auto make_result = [&](const char* kernel_name, uint64_t token_count) {
+		benchmark_result result{};
+		result.name		   = prefix + kernel_name;
+		result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+		result.parameters  = { { "max_batch_size", batch_size }, { "max_context_length", context_length }, { "token_count", token_count } };
+		return result;
+	};
+
+	std::cerr << "running " << prefix << "*" << std::endl;
+	random_generator generator{ options.seed };
+	const kernel_operand activations{ chunk_length * std::max(ffn_dim, vocab_size), false, generator };
+	const kernel_operand outputs{ chunk_length * std::max(ffn_dim, vocab_size), false, generator };
+
+	const auto bench_gemv = [&]<uint64_t rows, uint64_t cols>(const char* kernel_name, uint64_t token_count) {
+		const kernel_operand matrix{ rows * cols, true, generator };
+		const double flop_count{ 2.0 * rows * cols * static_cast<double>(token_count) };
+		const double byte_count{ float_bytes * (rows * cols + static_cast<double>(token_count) * (rows + cols)) };
+		run_kernel_benchmark(report, make_result(kernel_name, token_count), baseline, options, flop_count, byte_count, [&](uint64_t rotation) {
+			gemv<rows, cols>(outputs.data, matrix.copy(rotation), activations.data, token_count);
+		});
+	};
+	bench_gemv.template operator()<embedding_dim, embedding_dim>("gemv_attention", batch_size);
+	bench_gemv.template operator()<ffn_dim, embedding_dim>("gemv_ffn_up", batch_size);
+	bench_gemv.template operator()<embedding_dim, ffn_dim>("gemv_ffn_down", batch_size);
+	bench_gemv.template operator()<vocab_size, embedding_dim>("gemv_output", batch_size);
+
+	// Prefill projections at one chunk through the packed gemm, and through gemv as the reference - matmul takes gemm here
+	const auto bench_gemm = [&]<uint64_t rows, uint64_t cols>(const char* matrix_name) {
+		static constexpr gemm_blocking blocking{ compute_gemm_blocking(rows, cols, chunk_length, f32_rows::columns_per_element) };
+		const kernel_operand matrix{ rows * cols, true, generator };
+		const kernel_operand pack{ blocking.pack_float_count(), false, generator };
+		const double flop_count{ 2.0 * rows * cols * static_cast<double>(chunk_length) };
+		const double byte_count{ float_bytes * (rows * cols + static_cast<double>(chunk_length) * (rows + cols)) };
+		run_kernel_benchmark(report, make_result((std::string{ "gemm_prefill_" } + matrix_name).c_str(), chunk_length), baseline, options, flop_count, byte_count,
+			[&](uint64_t rotation) {
+				gemm<rows, cols, chunk_length>(outputs.data, matrix.copy(rotation), activations.data, chunk_length, pack.data);
+			});
+		run_kernel_benchmark(report, make_result((std::string{ "gemv_prefill_" } + matrix_name).c_str(), chunk_length), baseline, options, flop_count, byte_count,
+			[&](uint64_t rotation) {
+				gemv<rows, cols>(outputs.data, matrix.copy(rotation), activations.data, chunk_length);
+			});
+	};
+	bench_gemm.template operator()<embedding_dim, embedding_dim>("attention");
+	bench_gemm.template operator()<ffn_dim, embedding_dim>("ffn_up");
+	bench_gemm.template operator()<embedding_dim, ffn_dim>("ffn_down");
+
+	// The decode GEMVs again with every narrower weight format, dequantization fused into the dot product
+	// byte_count counts the weights at their stored width, which is where the speedup on memory-bound decode comes from
+	const auto bench_quantized_gemv = [&]<weight_dtype_type dtype, uint64_t rows, uint64_t cols>(const char* kernel_name, const char* dtype_name, uint64_t token_count) {
+		using format_type = weight_format<dtype>;
+		const quantized_operand<format_type, rows, cols> matrix{ generator };
+		const double flop_count{ 2.0 * rows * cols * static_cast<double>(token_count) };
+		const double byte_count{ static_cast<double>(matrix.bytes()) + float_bytes * static_cast<double>(token_count) * (rows + cols) };
+		run_kernel_benchmark(report, make_result((std::string{ kernel_name } + "_" + dtype_name).c_str(), token_count), baseline, options, flop_count, byte_count,
+			[&](uint64_t rotation) {
+				gemv<rows, cols, format_type>(outputs.data, matrix.copy(rotation), activations.data, token_count);
+			});
+	};
+	const auto bench_dtype = [&]<weight_dtype_type dtype>(const char* dtype_name) {
+		bench_quantized_gemv.template operator()<dtype, embedding_dim, embedding_dim>("gemv_attention", dtype_name, batch_size);
+		bench_quantized_gemv.template operator()<dtype, ffn_dim, embedding_dim>("gemv_ffn_up", dtype_name, batch_size);
+		bench_quantized_gemv.template operator()<dtype, embedding_dim, ffn_dim>("gemv_ffn_down", dtype_name, batch_size);
+		bench_quantized_gemv.template operator()<dtype, vocab_size, embedding_dim>("gemv_output", dtype_name, batch_size);
+	};
+	bench_dtype.template operator()<weight_dtype_type::bf16>("bf16");
+	bench_dtype.template operator()<weight_dtype_type::q8>("q8");
+	bench_dtype.template operator()<weight_dtype_type::q4>("q4");
+
+	{
+		const kernel_operand keys{ context_length * kv_dim, true, generator };
+		const kernel_operand values{ context_length * kv_dim, true, generator };
+		const kernel_operand scores{ context_length, false, generator };
+		const double flop_count{ 4.0 * head_count * head_dim * context_length };
+		const double byte_count{ float_bytes * 2.0 * context_length * kv_dim };
+		run_kernel_benchmark(report, make_result("attention", context_length), baseline, options, flop_count, byte_count, [&](uint64_t rotation) {
+			const float* key_cache{ keys.copy(rotation) };
+			const float* value_cache{ values.copy(rotation) };
+			for (uint64_t head = 0; head < head_count; ++head) {
+				const uint64_t kv_offset{ (head / kv_group_size) * head_dim };
+				attention_head<head_dim>(outputs.data + head * head_dim, activations.data + head * head_dim, key_cache + kv_offset, value_cache + kv_offset, kv_dim,
+					context_length, scores.data);
+			}
+		});
+	}
+
+	// Uniform token ids rarely repeat; byte-tokenized text uses at most 95 distinct ids, so most rows are duplicates
+	// byte_count is what the scalar gather moves (every row read from the table and written), for both variants, so
+	// gb_per_second compares as effective bandwidth
+	{
+		static constexpr uint64_t max_token_count{ batch_size * config_type::max_prompt_length };
+		const kernel_operand table{ vocab_size * embedding_dim, true, generator };
+		const kernel_operand gathered{ max_token_count * embedding_dim, false, generator };
+		std::vector<uint64_t> dedup_table(gather_table_capacity(max_token_count));
+		std::vector<uint32_t> tokens(max_token_count);
+		for (const bool text: { false, true }) {
+			for (uint32_t& token: tokens) {
+				token = text ? static_cast<uint32_t>(' ' + generator.next_below(95)) : static_cast<uint32_t>(generator.next_below(vocab_size));
+			}
+			for (const uint64_t token_count: { chunk_length, max_token_count }) {
+				const double byte_count{ float_bytes * 2.0 * static_cast<double>(token_count * embedding_dim) };
+				const std::string suffix{ text ? "_text" : "_uniform" };
+				run_kernel_benchmark(report, make_result(("embedding_gather" + suffix).c_str(), token_count), baseline, options, 0.0, byte_count, [&](uint64_t rotation) {
+					gather_rows<embedding_dim>(gathered.data, table.copy(rotation), tokens.data(), token_count);
+				});
+				run_kernel_benchmark(report, make_result(("embedding_gather_dedup" + suffix).c_str(), token_count), baseline, options, 0.0, byte_count,
+					[&](uint64_t rotation) {
+						gather_rows_dedup<embedding_dim>(gathered.data, table.copy(rotation), tokens.data(), token_count, dedup_table.data());
+					});
+			}
+		}
+	}
+
+	{
+		const kernel_operand weight{ embedding_dim, false, generator };
+		const double flop_count{ 5.0 * embedding_dim * batch_size };
+		const double byte_count{ float_bytes * (2.0 * embedding_dim * batch_size + embedding_dim) };
+		run_kernel_benchmark(report, make_result("rms_norm", batch_size), baseline, options, flop_count, byte_count, [&](uint64_t) {
+			rms_norm<embedding_dim>(outputs.data, activations.data, weight.data, batch_size);
+		});
+	}
+
+	{
+		const double flop_count{ static_cast<double>(vocab_size * batch_size) };
+		const double byte_count{ float_bytes * vocab_size * batch_size };
+		const sampling_params params{ 0.8f, 40 };
+		random_generator sampler{ options.seed };
+		uint32_t token_sink{};
+		run_kernel_benchmark(report, make_result("sample_top_k", batch_size), baseline, options, flop_count, byte_count, [&](uint64_t) {
+			for (uint64_t row = 0; row < batch_size; ++row) {
+				token_sink += sample_top_k(activations.data + row * vocab_size, vocab_size, params, sampler);
+			}
+		});
+		volatile uint32_t sink{ token_sink };
+		static_cast<void>(sink);
+	}
+
+	// Output head plus sampling of a decode batch, greedy and top-40 at temperature 0.8 - unfused writes every row's logits and
+	// samples from them, fused merges each vocab tile into the rows' candidates and never writes the logits
+	{
+		const kernel_operand matrix{ vocab_size * embedding_dim, true, generator };
+		std::vector<logit_candidates> candidates(batch_size);
+		std::vector<float> tile_logits(output_tile_row_count * batch_size);
+		const double flop_count{ 2.0 * vocab_size * embedding_dim * batch_size };
+		const double fused_byte_count{ float_bytes * (vocab_size * embedding_dim + static_cast<double>(batch_size) * embedding_dim) };
+		const double unfused_byte_count{ fused_byte_count + 2.0 * float_bytes * vocab_size * batch_size };
+		for (const auto& [mode_name, params]: { std::pair{ "greedy", sampling_params{ 0.0f, 1 } }, std::pair{ "top_k", sampling_params{ 0.8f, 40 } } }) {
+			random_generator sampler{ options.seed };
+			uint32_t token_sink{};
+			run_kernel_benchmark(report, make_result((std::string{ "lm_head_" } + mode_name + "_unfused").c_str(), batch_size), baseline, options, flop_count,
+				unfused_byte_count, [&](uint64_t rotation) {
+					gemv<vocab_size, embedding_dim>(outputs.data, matrix.copy(rotation), activations.data, batch_size);
+					for (uint64_t row = 0; row < batch_size; ++row) {
+						token_sink += sample_top_k(outputs.data + row * vocab_size, vocab_size, params, sampler);
+					}
+				});
+			run_kernel_benchmark(report, make_result((std::string{ "lm_head_" } + mode_name + "_fused").c_str(), batch_size), baseline, options, flop_count,
+				fused_byte_count, [&](uint64_t rotation) {
+					for (logit_candidates& row_candidates: candidates) {
+						row_candidates.reset(sample_candidate_count(params));
+					}
+					gemv_top_k<vocab_size, embedding_dim>(candidates.data(), matrix.copy(rotation), activations.data, batch_size, tile_logits.data(), 0);
+					for (logit_candidates& row_candidates: candidates) {
+						token_sink += sample_candidates(row_candidates, params, sampler);
+					}
+				});
+			volatile uint32_t sink{ token_sink };
+			static_cast<void>(sink);
+		}
+	}
+
+	// Mixture-of-experts routing of one prefill chunk over bench_expert_count experts: gating top-k per row, then the counting sort
+	{
+		static constexpr uint64_t bench_expert_count{ 8 };
+		static constexpr uint64_t bench_expert_top_k{ 2 };
+		static constexpr uint64_t route_count{ chunk_length * bench_expert_top_k };
+		std::vector<uint32_t> route_experts(route_count);
+		std::vector<float> route_weights(route_count);
+		std::vector<uint32_t> offsets(bench_expert_count + 1);
+		std::vector<uint32_t> grouped(route_count);
+		const double flop_count{ static_cast<double>(chunk_length * bench_expert_count * bench_expert_top_k) };
+		const double byte_count{ float_bytes * chunk_length * bench_expert_count + 4.0 * sizeof(uint32_t) * route_count };
+		run_kernel_benchmark(report, make_result("expert_routing", chunk_length), baseline, options, flop_count, byte_count, [&](uint64_t) {
+			for (uint64_t row = 0; row < chunk_length; ++row) {
+				gating_top_k<bench_expert_count, bench_expert_top_k>(activations.data + row * bench_expert_count, route_experts.data() + row * bench_expert_top_k,
+					route_weights.data() + row * bench_expert_top_k);
+			}
+			group_routes_by_expert<bench_expert_count>(route_experts.data(), route_count, 0, offsets.data(), grouped.data());
+		});
+	}
+
+	// Low-rank adapter deltas of the query projection for a decode batch where every row runs its own adapter - the worst case
+	// of segmented adapter serving, one segment per row
+	{
+		static constexpr uint64_t bench_adapter_rank{ 16 };
+		const kernel_operand adapter_weights{ batch_size * 2 * bench_adapter_rank * embedding_dim, true, generator };
+		std::vector<uint32_t> row_indices(batch_size);
+		std::vector<float> scratch(batch_size * bench_adapter_rank);
+		const double flop_count{ 4.0 * bench_adapter_rank * embedding_dim * batch_size };
+		const double byte_count{ float_bytes * (2.0 * bench_adapter_rank * embedding_dim + 2.0 * embedding_dim) * batch_size };
+		run_kernel_benchmark(report, make_result("lora_segments", batch_size), baseline, options, flop_count, byte_count, [&](uint64_t rotation) {
+			const float* weights{ adapter_weights.copy(rotation) };
+			for (uint64_t row = 0; row < batch_size; ++row) {
+				row_indices[row] = static_cast<uint32_t>(row);
+				const float* down{ weights + row * 2 * bench_adapter_rank * embedding_dim };
+				lora_segment<embedding_dim, embedding_dim, bench_adapter_rank>(outputs.data, activations.data, down, down + bench_adapter_rank * embedding_dim,
+					row_indices.data() + row, 1, scratch.data());
+			}
+		});
+	}
+}
+
+template<uint64_t... batch_indices> void run_kernel_grid(const bench_options& options, const roofline_baseline& baseline, benchmark_report& report,
+	std::index_sequence<batch_indices...>) {
+	(run_kernel_entry<sweep_config<sweep_batch_sizes[batch_indices], sweep_context_lengths[std::size(sweep_context_lengths) - 1]>>(options, baseline, report), ...);
+}
+
+// The baseline itself is reported first as roofline/stream_triad, roofline/stream_read and roofline/peak_flop
+inline benchmark_report run_kernel_suite(const bench_options& options) {
+	benchmark_report report{ "kernels", {} };
+	std::cerr << "measuring roofline baseline" << std::endl;
+	roofline_baseline baseline{};
+	measure_stream_bandwidth(options.repetitions, baseline);
+	measure_peak_flops(options.repetitions, baseline);
+
+	const auto add_baseline_result = [&](const char* name, const char* metric_name, const char* unit, double value) {
+		benchmark_result& result{ report.results.emplace_back(benchmark_result{ name, 0, {}, {} }) };
+		result.add_metric(metric_name, unit, true).samples.emplace_back(value);
+	};
+	add_baseline_result("roofline/stream_triad", "gb_per_second", "GB/s", baseline.triad_gb_per_second);
+	add_baseline_result("roofline/stream_read", "gb_per_second", "GB/s", baseline.read_gb_per_second);
+	add_baseline_result("roofline/peak_flop", "gflop_per_second", "GFLOP/s", baseline.peak_gflop_per_second);
+
+	run_kernel_grid(options, baseline, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
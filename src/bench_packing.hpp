@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+// Prefill batching - the same batches of prompts, with lengths drawn from a long-tailed distribution, prefilled three ways:
+// packed (prefill_packed_top_k, what the engine does), padded (every prompt of a batch padded to its longest, the rows a
+// padded batch computes) and one prefill per prompt. Throughput counts prompt tokens only, so padded rows are pure cost;
+// padding_fraction is the share of a padded batch's rows that are padding, which packing brings to zero
+
+// Log-normal prompt lengths - most prompts are short, a few run to the context limit
+inline constexpr double packing_median_prompt_length{ 48.0 };
+inline constexpr double packing_prompt_length_sigma{ 1.2 };
+inline constexpr uint64_t packing_batch_count{ 8 };
+
+inline uint64_t long_tail_prompt_length(random_generator& generator, uint64_t max_length) {
+	const double uniform_01{ static_cast<double>(generator.next_float()) + 0x1p-25 };
+	const double uniform_02{ static_cast<double>(generator.next_float()) };
+	const double normal{ std::sqrt(-2.0 * std::log(uniform_01)) * std::cos(2.0 * std::numbers::pi * uniform_02) };
+	const double length{ packing_median_prompt_length * std::exp(packing_prompt_length_sigma * normal) };
+	return std::clamp<uint64_t>(static_cast<uint64_t>(length), 1, max_length);
+}
+
+template<uint64_t batch_size> benchmark_result run_packing_entry(const bench_options& options) {
+	using config_type = model_config_type<sweep_config<batch_size, sweep_context_lengths[1]>>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using model_type  = stand_in_model<config_type, shape_type>;
+
+	benchmark_result result{};
+	result.name		   = "packing/batch_" + std::to_string(batch_size) + "/context_" + std::to_string(config_type::max_context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "prefill_chunk_length", model_type::prefill_chunk_length } };
+	benchmark_metric& packed{ result.add_metric("packed_tokens_per_second", "tokens/s", true) };
+	benchmark_metric& padded{ result.add_metric("padded_tokens_per_second", "tokens/s", true) };
+	benchmark_metric& sequential{ result.add_metric("per_sequence_tokens_per_second", "tokens/s", true) };
+	benchmark_metric& padding{ result.add_metric("padding_fraction", "fraction", false) };
+
+	std::cerr << "running " << result.name << std::endl;
+	random_generator generator{ options.seed };
+	std::vector<std::vector<uint32_t>> prompts(packing_batch_count * batch_size);
+	for (std::vector<uint32_t>& prompt: prompts) {
+		prompt.resize(long_tail_prompt_length(generator, config_type::max_prompt_length));
+		for (uint32_t& token: prompt) {
+			token = static_cast<uint32_t>(generator.next_below(model_type::vocab_size));
+		}
+	}
+	// The padded copies - every prompt of a batch extended to the batch's longest by repeating its first token
+	std::vector<std::vector<uint32_t>> padded_prompts(prompts);
+	uint64_t token_count{};
+	uint64_t padded_row_count{};
+	for (uint64_t batch = 0; batch < packing_batch_count; ++batch) {
+		uint64_t longest{};
+		for (uint64_t sequence = 0; sequence < batch_size; ++sequence) {
+			token_count += prompts[batch * batch_size + sequence].size();
+			longest = std::max<uint64_t>(longest, prompts[batch * batch_size + sequence].size());
+		}
+		for (uint64_t sequence = 0; sequence < batch_size; ++sequence) {
+			std::vector<uint32_t>& prompt{ padded_prompts[batch * batch_size + sequence] };
+			prompt.resize(longest, prompt[0]);
+		}
+		padded_row_count += batch_size * longest;
+	}
+
+	const auto model{ std::make_unique<model_type>() };
+	std::array<const uint32_t*, batch_size> tokens{};
+	std::array<uint32_t, batch_size + 1> offsets{};
+	std::array<uint32_t, batch_size> slots{};
+	std::array<uint32_t, batch_size> start_positions{};
+	std::array<sampling_params, batch_size> sampling{};
+	for (uint64_t sequence = 0; sequence < batch_size; ++sequence) {
+		slots[sequence] = static_cast<uint32_t>(sequence);
+	}
+	const auto prefill_batches = [&](const std::vector<std::vector<uint32_t>>& batch_prompts) {
+		for (uint64_t batch = 0; batch < packing_batch_count; ++batch) {
+			for (uint64_t sequence = 0; sequence < batch_size; ++sequence) {
+				const std::vector<uint32_t>& prompt{ batch_prompts[batch * batch_size + sequence] };
+				tokens[sequence]	  = prompt.data();
+				offsets[sequence + 1] = static_cast<uint32_t>(offsets[sequence] + prompt.size());
+			}
+			model->prefill_packed_top_k(tokens.data(), offsets.data(), slots.data(), start_positions.data(), sampling.data(), batch_size);
+		}
+	};
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		bench_clock::time_point start{ bench_clock::now() };
+		prefill_batches(prompts);
+		const double packed_seconds{ elapsed_seconds(start, bench_clock::now()) };
+
+		start = bench_clock::now();
+		prefill_batches(padded_prompts);
+		const double padded_seconds{ elapsed_seconds(start, bench_clock::now()) };
+
+		start = bench_clock::now();
+		for (uint64_t index = 0; index < prompts.size(); ++index) {
+			model->prefill_top_k(index % batch_size, prompts[index].data(), prompts[index].size(), 0, sampling[index % batch_size]);
+		}
+		const double sequential_seconds{ elapsed_seconds(start, bench_clock::now()) };
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		packed.samples.emplace_back(static_cast<double>(token_count) / packed_seconds);
+		padded.samples.emplace_back(static_cast<double>(token_count) / padded_seconds);
+		sequential.samples.emplace_back(static_cast<double>(token_count) / sequential_seconds);
+		padding.samples.emplace_back(static_cast<double>(padded_row_count - token_count) / static_cast<double>(padded_row_count));
+	}
+	return result;
+}
+
+template<uint64_t... batch_indices> void run_packing_grid(const bench_options& options, benchmark_report& report, std::index_sequence<batch_indices...>) {
+	(report.results.emplace_back(run_packing_entry<sweep_batch_sizes[batch_indices]>(options)), ...);
+}
+
+inline benchmark_report run_packing_suite(const bench_options& options) {
+	benchmark_report report{ "packing", {} };
+	run_packing_grid(options, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include <thread>
+
+// Vocab-parallel output layer - for every sweep batch size, decodes a full batch on 1, 2 and 4 ranks emulated by threads that
+// share one shared_memory_group, sampling top-40 at temperature 0.8. step_us and exchanged_bytes_per_step are the sharded
+// head that all-gathers each row's candidates; gathered_logits_* the same steps when every rank gathers full rows of logits
+// and samples from them. Bytes are what all ranks received per step. Ranks time-share the cores of this host, so step times
+// only compare like with like at the same rank count
+
+inline constexpr uint64_t rank_counts[]{ 1, 2, 4 };
+inline constexpr uint64_t rank_prompt_length{ 16 };
+inline constexpr uint64_t rank_step_count{ 16 };
+
+template<uint64_t batch_size, uint64_t rank_count, uint64_t rank> inline constexpr model_config rank_config{ generate_model_config(
+	sweep_config<batch_size, sweep_context_lengths[0]>, gpu_count_type{ rank_count }, gpu_rank_type{ rank }, vocab_parallel_type{ rank_count > 1 }) };
+
+// Runs the decode loop of one rank - only rank 0 records, after the final collective of each loop, when every rank has counted its bytes
+template<const model_config& config> void run_rank_decode(const bench_options& options, benchmark_result* result) {
+	using config_type = model_config_type<config>;
+	using model_type  = stand_in_model<config_type, model_shape_type<sweep_shape>>;
+	static constexpr uint64_t batch_size{ config_type::max_batch_size };
+
+	const auto model{ std::make_unique<model_type>() };
+	const auto exchanged_bytes = [&]() -> uint64_t {
+		if constexpr (decltype(model->rank_group)::enabled) {
+			return model->rank_group.get().group.bytes_exchanged.load();
+		} else {
+			return 0;
+		}
+	};
+	random_generator generator{ options.seed };
+	uint32_t prompt[rank_prompt_length];
+	uint32_t slots[batch_size];
+	uint32_t tokens[batch_size];
+	uint32_t positions[batch_size];
+	sampling_params sampling[batch_size];
+	for (uint64_t index = 0; index < rank_prompt_length; ++index) {
+		prompt[index] = static_cast<uint32_t>(generator.next_below(model_type::vocab_size));
+	}
+	for (uint64_t slot = 0; slot < batch_size; ++slot) {
+		model->prefill(slot, prompt, rank_prompt_length, 0);
+		slots[slot]	   = static_cast<uint32_t>(slot);
+		sampling[slot] = sampling_params{ 0.8f, 40 };
+	}
+
+	// Both loops restart from the same tokens and positions, overwriting the KV the previous loop appended
+	const auto decode_loop = [&](bool gather_logits, uint64_t metric_index, bool record) {
+		for (uint64_t slot = 0; slot < batch_size; ++slot) {
+			tokens[slot]	= prompt[slot % rank_prompt_length];
+			positions[slot] = static_cast<uint32_t>(rank_prompt_length);
+		}
+		const uint64_t start_bytes{ exchanged_bytes() };
+		const uint64_t start_ns{ monotonic_nanoseconds() };
+		for (uint64_t step = 0; step < rank_step_count; ++step) {
+			if (gather_logits) {
+				const float* logits{ model->decode(slots, tokens, positions, batch_size) };
+				for (uint64_t row = 0; row < batch_size; ++row) {
+					tokens[row] = sample_top_k(logits + row * model_type::vocab_size, model_type::vocab_size, sampling[row], generator);
+				}
+			} else {
+				logit_candidates* candidates{ model->decode_top_k(slots, tokens, positions, sampling, batch_size) };
+				for (uint64_t row = 0; row < batch_size; ++row) {
+					tokens[row] = sample_candidates(candidates[row], sampling[row], generator);
+				}
+			}
+			for (uint64_t row = 0; row < batch_size; ++row) {
+				++positions[row];
+			}
+		}
+		const uint64_t elapsed_ns{ monotonic_nanoseconds() - start_ns };
+		if (record) {
+			result->metrics[metric_index].samples.emplace_back(static_cast<double>(elapsed_ns) / 1.0e3 / rank_step_count);
+			result->metrics[metric_index + 1].samples.emplace_back(static_cast<double>(exchanged_bytes() - start_bytes) / rank_step_count);
+		}
+	};
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const bool record{ result && repetition >= options.warmup_repetitions };
+		decode_loop(false, 0, record);
+		decode_loop(true, 2, record);
+	}
+}
+
+template<uint64_t batch_size, uint64_t rank_count, uint64_t... ranks> benchmark_result run_rank_entry(const bench_options& options, std::index_sequence<ranks...>) {
+	using config_type = model_config_type<rank_config<batch_size, rank_count, 0>>;
+	using shape_type  = model_shape_type<sweep_shape>;
+
+	benchmark_result result{};
+	result.name		   = "ranks/batch_" + std::to_string(batch_size) + "/ranks_" + std::to_string(rank_count);
+	result.fingerprint = fingerprint_values(config_type::rank_group_fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", batch_size }, { "gpu_count", rank_count }, { "vocab_size", shape_type::vocab_size },
+		 { "local_vocab_size", memory_plan<config_type, shape_type>::local_vocab_size } };
+	result.add_metric("step_us", "us", false);
+	result.add_metric("exchanged_bytes_per_step", "B", false);
+	result.add_metric("gathered_logits_step_us", "us", false);
+	result.add_metric("gathered_logits_bytes_per_step", "B", false);
+
+	std::cerr << "running " << result.name << std::endl;
+	std::array<std::thread, rank_count> threads{ std::thread{ [&] {
+		run_rank_decode<rank_config<batch_size, rank_count, ranks>>(options, ranks == 0 ? &result : nullptr);
+	} }... };
+	for (std::thread& thread: threads) {
+		thread.join();
+	}
+	return result;
+}
+
+template<uint64_t batch_size, uint64_t... rank_indices> void run_rank_counts(const bench_options& options, benchmark_report& report, std::index_sequence<rank_indices...>) {
+	(report.results.emplace_back(run_rank_entry<batch_size, rank_counts[rank_indices]>(options, std::make_index_sequence<rank_counts[rank_indices]>{})), ...);
+}
+
+template<uint64_t... batch_indices> void run_rank_grid(const bench_options& options, benchmark_report& report, std::index_sequence<batch_indices...>) {
+	(run_rank_counts<sweep_batch_sizes[batch_indices]>(options, report, std::make_index_sequence<std::size(rank_counts)>{}), ...);
+}
+
+inline benchmark_report run_rank_suite(const bench_options& options) {
+	benchmark_report report{ "ranks", {} };
+	run_rank_grid(options, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include "replica_router.hpp"
+
+// Data-parallel routing - replica_count engine processes behind a replica_router, serving requests that open with one of a few
+// shared prefixes (system prompts, documents) followed by a unique suffix, once per routing policy. The prefixes are as many as
+// the replicas have sequence slots together, so a router that keeps each prefix on one replica lets every prefix cache hold its
+// share, while one that scatters them makes each cache cycle through all of them. cache_hit_rate is the share of prompt tokens
+// the prefix caches reused; tokens_per_second counts generated tokens, up to router_concurrency requests kept in flight
+// The replicas are separate processes - on a host with fewer cores than replicas they time-share, and throughput shows it
+
+inline constexpr uint64_t router_replica_counts[]{ 2, 4 };
+inline constexpr uint64_t router_batch_size{ 4 };
+inline constexpr uint64_t router_request_count{ 128 };
+inline constexpr uint64_t router_min_prefix_length{ 64 };
+inline constexpr uint64_t router_max_prefix_length{ 128 };
+inline constexpr uint64_t router_min_suffix_length{ 8 };
+inline constexpr uint64_t router_max_suffix_length{ 24 };
+inline constexpr uint64_t router_generation_length{ 8 };
+
+inline constexpr model_config router_config{ generate_model_config(sweep_config<router_batch_size, sweep_context_lengths[0]>, prefix_cache_type::enabled) };
+
+using router_engine = engine<stand_in_model<model_config_type<router_config>, model_shape_type<sweep_shape>>>;
+
+// Requests in flight at once - enough to keep every replica's batch full with as many again queued
+template<uint64_t replica_count> inline constexpr uint64_t router_concurrency{ 2 * replica_count * router_batch_size };
+
+inline std::vector<std::vector<uint32_t>> generate_router_workload(uint64_t request_count, uint64_t prefix_count, uint64_t seed) {
+	random_generator generator{ seed };
+	std::vector<std::vector<uint32_t>> prefixes(prefix_count);
+	for (std::vector<uint32_t>& prefix: prefixes) {
+		prefix.resize(router_min_prefix_length + generator.next_below(router_max_prefix_length - router_min_prefix_length + 1));
+		for (uint32_t& token: prefix) {
+			token = static_cast<uint32_t>(generator.next_below(router_engine::model_type::vocab_size));
+		}
+	}
+	std::vector<std::vector<uint32_t>> prompts(request_count);
+	for (std::vector<uint32_t>& prompt: prompts) {
+		prompt = prefixes[generator.next_below(prefix_count)];
+		const uint64_t suffix_length{ router_min_suffix_length + generator.next_below(router_max_suffix_length - router_min_suffix_length + 1) };
+		for (uint64_t index = 0; index < suffix_length; ++index) {
+			prompt.emplace_back(static_cast<uint32_t>(generator.next_below(router_engine::model_type::vocab_size)));
+		}
+		prompt.resize(std::min<uint64_t>(prompt.size(), router_engine::max_prompt_length));
+	}
+	return prompts;
+}
+
+template<uint64_t replica_count> benchmark_result run_router_entry(const bench_options& options, routing_policy policy, const char* variant) {
+	using config_type = typename router_engine::config_type;
+	using shape_type  = typename router_engine::shape_type;
+
+	benchmark_result result{};
+	result.name		   = std::string{ "router/" } + variant + "/replicas_" + std::to_string(replica_count) + "/batch_" + std::to_string(router_batch_size);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "replica_count", replica_count }, { "max_batch_size", router_batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "prefix_count", replica_count * router_batch_size }, { "concurrency", router_concurrency<replica_count> } };
+	benchmark_metric& throughput{ result.add_metric("tokens_per_second", "tokens/s", true) };
+	benchmark_metric& hit_rate{ result.add_metric("cache_hit_rate", "fraction", true) };
+	benchmark_metric& ttft{ result.add_metric("ttft_ms", "ms", false) };
+
+	std::cerr << "running " << result.name << std::endl;
+	const std::vector<std::vector<uint32_t>> prompts{ generate_router_workload(std::max(options.request_count, router_request_count), replica_count * router_batch_size,
+		options.seed) };
+	replica_router<router_engine, replica_count> router{ policy };
+	if (router.start() != zygote_status::ready) {
+		std::cerr << "router: failed to start the replicas\n";
+		return result;
+	}
+	std::vector<bench_clock::time_point> submit_times(prompts.size());
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const uint64_t lookup_start{ router.lookup_token_count() };
+		const uint64_t reused_start{ router.reused_token_count() };
+		const bench_clock::time_point start{ bench_clock::now() };
+		uint64_t next_request{};
+		uint64_t in_flight{};
+		uint64_t token_count{};
+		while (next_request < prompts.size() || in_flight > 0) {
+			for (; next_request < prompts.size() && in_flight < router_concurrency<replica_count>; ++next_request, ++in_flight) {
+				const std::vector<uint32_t>& prompt{ prompts[next_request] };
+				submit_times[next_request] = bench_clock::now();
+				if (router.submit(request_params{ next_request, prompt.data(), prompt.size(), router_generation_length, sampling_params{}, next_request }) !=
+					request_status::accepted) {
+					break;
+				}
+			}
+			const std::span<const token_event> events{ router.poll() };
+			const bench_clock::time_point now{ bench_clock::now() };
+			for (const token_event& event: events) {
+				if (event.first && repetition >= options.warmup_repetitions) {
+					ttft.samples.emplace_back(elapsed_milliseconds(submit_times[event.request_id], now));
+				}
+				in_flight -= event.finished;
+			}
+			token_count += events.size();
+			if (events.empty()) {
+				std::this_thread::yield();
+			}
+		}
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		throughput.samples.emplace_back(static_cast<double>(token_count) / elapsed_seconds(start, bench_clock::now()));
+		const uint64_t lookup_count{ router.lookup_token_count() - lookup_start };
+		hit_rate.samples.emplace_back(lookup_count == 0 ? 0.0 : static_cast<double>(router.reused_token_count() - reused_start) / static_cast<double>(lookup_count));
+	}
+	router.stop();
+	return result;
+}
+
+template<uint64_t... replica_indices> void run_router_grid(const bench_options& options, benchmark_report& report, std::index_sequence<replica_indices...>) {
+	((report.results.emplace_back(run_router_entry<router_replica_counts[replica_indices]>(options, routing_policy::round_robin, "round_robin")),
+		 report.results.emplace_back(run_router_entry<router_replica_counts[replica_indices]>(options, routing_policy::kv_aware, "kv_aware"))),
+		...);
+}
+
+inline benchmark_report run_router_suite(const bench_options& options) {
+	benchmark_report report{ "router", {} };
+#if defined(_WIN32)
+	std::cerr << "router: fork is not available on this platform\n";
+#else
+	run_router_grid(options, report, std::make_index_sequence<std::size(router_replica_counts)>{});
+#endif
+	return report;
+}
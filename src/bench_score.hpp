@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+
+// Prompt scoring - a scoring configuration (max_generation_length of zero) serves a burst of prompts between a quarter of the
+// context and all of it, and its throughput is set against raw prefill: the same prompts pushed through the model's layers with
+// no output head at all. Both are reported in GFLOP/s of the matmul and attention work each does, so flop_efficiency is the
+// share of raw prefill's rate that scoring keeps once the fused output head and the logprob events are added
+
+inline constexpr uint64_t score_batch_size{ 16 };
+
+template<uint64_t context_length> inline constexpr model_config score_config{ generate_model_config(max_batch_size_type{ score_batch_size },
+	max_context_length_type{ context_length }, max_generation_length_type::disabled, benchmark_type::enabled) };
+
+// Multiply-adds of one prompt through every layer - projections, feed forward and causal attention - plus the output head when scored
+template<typename shape_type> constexpr double prompt_flop_count(uint64_t token_count, bool output_head) noexcept {
+	constexpr double layer_matrix_flops{ 2.0 *
+		static_cast<double>(2 * shape_type::embedding_dim * shape_type::embedding_dim + 2 * shape_type::kv_dim * shape_type::embedding_dim +
+			3 * shape_type::ffn_dim * shape_type::embedding_dim) };
+	const double positions{ static_cast<double>(token_count) };
+	double return_value{ positions * static_cast<double>(shape_type::layer_count) * layer_matrix_flops };
+	return_value += 2.0 * static_cast<double>(shape_type::layer_count * shape_type::embedding_dim) * positions * (positions + 1.0);
+	if (output_head) {
+		return_value += 2.0 * static_cast<double>(shape_type::vocab_size * shape_type::embedding_dim) * (positions - 1.0);
+	}
+	return return_value;
+}
+
+template<uint64_t context_length> benchmark_result run_score_entry(const bench_options& options) {
+	using config_type = model_config_type<score_config<context_length>>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using engine_type = engine<stand_in_model<config_type, shape_type>>;
+
+	benchmark_result result{};
+	result.name		   = "score/context_" + std::to_string(context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", config_type::max_batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "max_prompt_length", config_type::max_prompt_length }, { "kv_cache_bytes", engine_type::model_type::plan_type::layout.kv_cache_bytes } };
+	benchmark_metric& throughput{ result.add_metric("tokens_per_second", "tokens/s", true) };
+	benchmark_metric& score_rate{ result.add_metric("gflop_per_second", "GFLOP/s", true) };
+	benchmark_metric& prefill_rate{ result.add_metric("prefill_gflop_per_second", "GFLOP/s", true) };
+	benchmark_metric& efficiency{ result.add_metric("flop_efficiency", "fraction", true) };
+
+	std::cerr << "running " << result.name << std::endl;
+	synthetic_workload workload{};
+	workload.min_prompt_length = context_length / 4;
+	workload.max_prompt_length = context_length;
+	workload.generate(options.request_count, options.seed);
+	double score_flops{};
+	double prefill_flops{};
+	for (const synthetic_request& request: workload.requests) {
+		score_flops += prompt_flop_count<shape_type>(request.prompt.size(), true);
+		prefill_flops += prompt_flop_count<shape_type>(request.prompt.size(), false);
+	}
+
+	const auto engine_instance{ std::make_unique<engine_type>() };
+	std::vector<uint32_t> tokens(context_length);
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		bench_clock::time_point start{ bench_clock::now() };
+		for (uint64_t index = 0; index < workload.requests.size(); ++index) {
+			engine_instance->submit(request_params{ index, nullptr, 0, 0, sampling_params{}, index, workload.requests[index].prompt });
+		}
+		uint64_t token_count{};
+		while (!engine_instance->idle()) {
+			token_count += engine_instance->step().size();
+			engine_instance->complete_streaming();
+		}
+		const double score_seconds{ elapsed_seconds(start, bench_clock::now()) };
+
+		start = bench_clock::now();
+		for (const synthetic_request& request: workload.requests) {
+			const uint64_t token_count{ engine_instance->tokenizer.encode(request.prompt, tokens.data(), context_length) };
+			engine_instance->model.prefill_hidden(0, tokens.data(), token_count, 0, engine_type::model_type::no_adapter_slot);
+		}
+		const double prefill_seconds{ elapsed_seconds(start, bench_clock::now()) };
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		throughput.samples.emplace_back(static_cast<double>(token_count) / score_seconds);
+		score_rate.samples.emplace_back(score_flops / score_seconds / 1.0e9);
+		prefill_rate.samples.emplace_back(prefill_flops / prefill_seconds / 1.0e9);
+		efficiency.samples.emplace_back(score_flops / score_seconds / (prefill_flops / prefill_seconds));
+	}
+	return result;
+}
+
+template<uint64_t... context_indices> void run_score_grid(const bench_options& options, benchmark_report& report, std::index_sequence<context_indices...>) {
+	(report.results.emplace_back(run_score_entry<sweep_context_lengths[context_indices]>(options)), ...);
+}
+
+inline benchmark_report run_score_suite(const bench_options& options) {
+	benchmark_report report{ "score", {} };
+	run_score_grid(options, report, std::make_index_sequence<std::size(sweep_context_lengths)>{});
+	return report;
+}
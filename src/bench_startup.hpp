@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+
+// Cold start - constructs a fresh engine per repetition for every sweep configuration and reports its startup profile
+// Each repetition maps new arenas, so page faults are paid again just as in a newly started process
+// subsystem_init_ms is what building every active subsystem eagerly would add to time_to_ready_ms - the startup lazy
+// initialization saves. The subsystems variant of each configuration activates all of them (prefix cache, two ranks)
+// Once ready, every instance serves one request - first_token_ms and first_request_ms with the page faults it caused show
+// what the warmup variant moves from the first request into startup
+
+template<uint64_t batch_size, uint64_t context_length> inline constexpr model_config startup_subsystems_config{ generate_model_config(
+	sweep_config<batch_size, context_length>, prefix_cache_type::enabled, gpu_count_type{ 2 }) };
+
+template<uint64_t batch_size, uint64_t context_length> inline constexpr model_config startup_warmup_config{ generate_model_config(sweep_config<batch_size, context_length>,
+	warmup_type::enabled, numa_prefault_type::enabled) };
+
+// Prompt and generation length of the first request - a full prefill chunk when the configuration allows it
+inline constexpr uint64_t first_request_prompt_length{ 64 };
+inline constexpr uint64_t first_request_generation_length{ 16 };
+
+template<const model_config& config> benchmark_result run_startup_entry(const bench_options& options, const char* variant) {
+	using config_type = model_config_type<config>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using engine_type = engine<stand_in_model<config_type, shape_type>>;
+
+	benchmark_result result{};
+	result.name		   = std::string{ "startup/" } + variant + "/batch_" + std::to_string(config_type::max_batch_size) + "/context_" + std::to_string(config_type::max_context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", config_type::max_batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "arena_bytes", memory_plan<config_type, shape_type>::layout.total_bytes() }, { "prefix_cache", config_type::prefix_cache },
+		 { "gpu_count", config_type::gpu_count }, { "warmup", config_type::warmup } };
+	benchmark_metric& time_to_ready{ result.add_metric("time_to_ready_ms", "ms", false) };
+	benchmark_metric& subsystem_init{ result.add_metric("subsystem_init_ms", "ms", false) };
+	benchmark_metric& minor_faults{ result.add_metric("minor_faults", "faults", false) };
+	benchmark_metric& first_token{ result.add_metric("first_token_ms", "ms", false) };
+	benchmark_metric& first_request{ result.add_metric("first_request_ms", "ms", false) };
+	benchmark_metric& first_request_faults{ result.add_metric("first_request_faults", "faults", false) };
+	std::array<benchmark_metric*, startup_phase_count> phases{};
+	for (uint64_t index = 0; index < startup_phase_count; ++index) {
+		phases[index] = &result.add_metric(std::string{ startup_phase_names[index] } + "_ms", "ms", false);
+	}
+
+	std::cerr << "running " << result.name << std::endl;
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const uint64_t faults_before{ minor_page_faults() };
+		const auto engine_instance{ std::make_unique<engine_type>() };
+		const uint64_t faults{ minor_page_faults() - faults_before };
+		const uint64_t init_start_ns{ monotonic_nanoseconds() };
+		engine_instance->initialize_subsystems();
+		const uint64_t init_ns{ monotonic_nanoseconds() - init_start_ns };
+		const std::string prompt(std::min(first_request_prompt_length, engine_type::max_prompt_length), 'a');
+		const uint64_t request_faults_before{ minor_page_faults() };
+		const uint64_t request_start_ns{ monotonic_nanoseconds() };
+		uint64_t first_token_ns{};
+		engine_instance->submit(request_params{ 0, nullptr, 0, first_request_generation_length, sampling_params{}, 0, prompt });
+		while (!engine_instance->idle()) {
+			for (const token_event& event: engine_instance->step()) {
+				if (event.first) {
+					first_token_ns = monotonic_nanoseconds() - request_start_ns;
+				}
+			}
+		}
+		const uint64_t request_ns{ monotonic_nanoseconds() - request_start_ns };
+		const uint64_t request_faults{ minor_page_faults() - request_faults_before };
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		const auto& startup{ engine_instance->model.startup };
+		time_to_ready.samples.emplace_back(static_cast<double>(startup.time_to_ready_ns()) / 1.0e6);
+		minor_faults.samples.emplace_back(static_cast<double>(faults));
+		subsystem_init.samples.emplace_back(static_cast<double>(init_ns) / 1.0e6);
+		first_token.samples.emplace_back(static_cast<double>(first_token_ns) / 1.0e6);
+		first_request.samples.emplace_back(static_cast<double>(request_ns) / 1.0e6);
+		first_request_faults.samples.emplace_back(static_cast<double>(request_faults));
+		for (uint64_t index = 0; index < startup_phase_count; ++index) {
+			phases[index]->samples.emplace_back(static_cast<double>(startup.phase_ns[index]) / 1.0e6);
+		}
+	}
+	return result;
+}
+
+template<uint64_t batch_size, uint64_t... context_indices> void run_startup_row(const bench_options& options, benchmark_report& report,
+	std::index_sequence<context_indices...>) {
+	(report.results.emplace_back(run_startup_entry<sweep_config<batch_size, sweep_context_lengths[context_indices]>>(options, "default")), ...);
+	(report.results.emplace_back(run_startup_entry<startup_subsystems_config<batch_size, sweep_context_lengths[context_indices]>>(options, "subsystems")), ...);
+	(report.results.emplace_back(run_startup_entry<startup_warmup_config<batch_size, sweep_context_lengths[context_indices]>>(options, "warmup")), ...);
+}
+
+template<uint64_t... batch_indices> void run_startup_grid(const bench_options& options, benchmark_report& report, std::index_sequence<batch_indices...>) {
+	(run_startup_row<sweep_batch_sizes[batch_indices]>(options, report, std::make_index_sequence<std::size(sweep_context_lengths)>{}), ...);
+}
+
+inline benchmark_report run_startup_suite(const bench_options& options) {
+	benchmark_report report{ "startup", {} };
+	run_startup_grid(options, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
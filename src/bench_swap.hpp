@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_sweep.hpp"
+#include "hot_swap.hpp"
+
+// Model upgrade under load - a closed loop keeps max_batch_size requests in flight on a hot_swap_engine while a model with new
+// weights is loaded in the background and swapped in. max_step_gap_ms is the longest the serving thread went without a step
+// during the upgrade, steady_step_gap_ms the same before it; load_ms runs from load() to the swap, drain_ms from the swap to
+// the old engine's release, and load_tokens counts the tokens served meanwhile. restart_outage_ms is the baseline: destroying
+// the old engine and building the new one in place, serving nothing
+
+inline constexpr model_shape swap_shape{ generate_model_shape(sweep_shape, weight_seed_type{ 0x73776170ull }) };
+
+template<uint64_t batch_size> using swap_engine_pair = std::tuple<engine<stand_in_model<model_config_type<sweep_config<batch_size, sweep_context_lengths[1]>>, model_shape_type<sweep_shape>>>,
+	engine<stand_in_model<model_config_type<sweep_config<batch_size, sweep_context_lengths[1]>>, model_shape_type<swap_shape>>>>;
+
+template<typename engine_tuple> struct swap_bench_type;
+
+template<typename... engine_types> struct swap_bench_type<std::tuple<engine_types...>> {
+	using type = hot_swap_engine<engine_types...>;
+};
+
+template<uint64_t batch_size> benchmark_result run_swap_entry(const bench_options& options) {
+	using engine_pair	= swap_engine_pair<batch_size>;
+	using swap_type		= typename swap_bench_type<engine_pair>::type;
+	using old_engine	= std::tuple_element_t<0, engine_pair>;
+	using new_engine	= std::tuple_element_t<1, engine_pair>;
+	using config_type	= typename old_engine::config_type;
+	using shape_type	= typename old_engine::shape_type;
+
+	benchmark_result result{};
+	result.name		   = "swap/batch_" + std::to_string(batch_size) + "/context_" + std::to_string(config_type::max_context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint, new_engine::shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "weight_bytes", memory_plan<config_type, shape_type>::layout.weight_bytes } };
+	benchmark_metric& steady_gap{ result.add_metric("steady_step_gap_ms", "ms", false) };
+	benchmark_metric& swap_gap{ result.add_metric("max_step_gap_ms", "ms", false) };
+	benchmark_metric& load_time{ result.add_metric("load_ms", "ms", false) };
+	benchmark_metric& drain_time{ result.add_metric("drain_ms", "ms", false) };
+	benchmark_metric& load_tokens{ result.add_metric("load_tokens", "tokens", true) };
+	benchmark_metric& restart_outage{ result.add_metric("restart_outage_ms", "ms", false) };
+
+	std::cerr << "running " << result.name << std::endl;
+	synthetic_workload workload{};
+	workload.generate(std::max<uint64_t>(options.request_count, batch_size), options.seed);
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		swap_type server{};
+		server.template load<0>();
+		while (!server.loaded()) {
+			server.step();
+			std::this_thread::yield();
+		}
+		uint64_t next_request{};
+		uint64_t in_flight{};
+		uint64_t last_step_ns{ monotonic_nanoseconds() };
+		uint64_t max_gap_ns{};
+		uint64_t token_count{};
+		// Tops the loop up to batch_size requests, steps once and records the gap since the previous step
+		const auto serve_step = [&] {
+			for (; in_flight < batch_size; ++in_flight, ++next_request) {
+				const synthetic_request& request{ workload.requests[next_request % workload.requests.size()] };
+				server.submit(request_params{ next_request, nullptr, 0, request.generation_length, sampling_params{}, next_request, request.prompt });
+			}
+			const std::span<const token_event> events{ server.step() };
+			for (const token_event& event: events) {
+				in_flight -= event.finished;
+			}
+			token_count += events.size();
+			const uint64_t now_ns{ monotonic_nanoseconds() };
+			max_gap_ns	 = std::max(max_gap_ns, now_ns - last_step_ns);
+			last_step_ns = now_ns;
+		};
+		for (uint64_t step = 0; step < 64; ++step) {
+			serve_step();
+		}
+		const uint64_t steady_gap_ns{ max_gap_ns };
+		max_gap_ns	= 0;
+		token_count = 0;
+		const uint64_t load_start_ns{ monotonic_nanoseconds() };
+		server.template load<1>();
+		while (server.swap_count < 2) {
+			serve_step();
+		}
+		const uint64_t swap_ns{ monotonic_nanoseconds() };
+		const uint64_t swap_tokens{ token_count };
+		while (server.released_count.load() == 0) {
+			serve_step();
+		}
+		const uint64_t drain_ns{ monotonic_nanoseconds() - swap_ns };
+
+		// Baseline: the same upgrade as a restart, during which nothing is served
+		auto restarted{ std::make_unique<old_engine>() };
+		const uint64_t restart_start_ns{ monotonic_nanoseconds() };
+		restarted.reset();
+		auto replacement{ std::make_unique<new_engine>() };
+		replacement->warmup();
+		const uint64_t restart_ns{ monotonic_nanoseconds() - restart_start_ns };
+
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		steady_gap.samples.emplace_back(static_cast<double>(steady_gap_ns) / 1.0e6);
+		swap_gap.samples.emplace_back(static_cast<double>(max_gap_ns) / 1.0e6);
+		load_time.samples.emplace_back(static_cast<double>(swap_ns - load_start_ns) / 1.0e6);
+		drain_time.samples.emplace_back(static_cast<double>(drain_ns) / 1.0e6);
+		load_tokens.samples.emplace_back(static_cast<double>(swap_tokens));
+		restart_outage.samples.emplace_back(static_cast<double>(restart_ns) / 1.0e6);
+	}
+	return result;
+}
+
+template<uint64_t... batch_indices> void run_swap_grid(const bench_options& options, benchmark_report& report, std::index_sequence<batch_indices...>) {
+	(report.results.emplace_back(run_swap_entry<sweep_batch_sizes[batch_indices]>(options)), ...);
+}
+
+inline benchmark_report run_swap_suite(const bench_options& options) {
+	benchmark_report report{ "swap", {} };
+	run_swap_grid(options, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
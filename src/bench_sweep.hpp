@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "engine.hpp"
+#include <iostream>
+#include <memory>
+#include <utility>
+
+// End-to-end sweep - every (max_batch_size, max_context_length) pair below is a separate compile-time configuration,
+// each serving the same synthetic workload on the stand-in model
+
+inline constexpr uint64_t sweep_batch_sizes[]{ 1, 4, 16 };
+inline constexpr uint64_t sweep_context_lengths[]{ 256, 1024 };
+
+// Shared by every grid entry so only the serving limits change between results
+inline constexpr model_shape sweep_shape{ generate_model_shape(layer_count_type{ 4 }, head_count_type{ 8 }, kv_head_count_type{ 4 }, head_dim_type{ 32 },
+	vocab_size_type{ 4096 }) };
+
+template<uint64_t batch_size, uint64_t context_length> inline constexpr model_config sweep_config{ generate_model_config(max_batch_size_type{ batch_size },
+	max_context_length_type{ context_length }, benchmark_type::enabled) };
+
+struct synthetic_request {
+	std::string prompt{};
+	uint64_t generation_length{};
+};
+
+// Fixed, seeded workload of printable text prompts - prompt lengths (in bytes, one token each) uniform in
+// [min_prompt_length, max_prompt_length], fixed generation length. Prompts longer than a configuration's max_prompt_length are truncated when submitted, never rejected
+struct synthetic_workload {
+	uint64_t min_prompt_length{ 8 };
+	uint64_t max_prompt_length{ 64 };
+	uint64_t generation_length{ 16 };
+	std::vector<synthetic_request> requests{};
+
+	void generate(uint64_t request_count, uint64_t seed) {
+		random_generator generator{ seed };
+		requests.resize(request_count);
+		for (synthetic_request& request: requests) {
+			request.prompt.resize(min_prompt_length + generator.next_below(max_prompt_length - min_prompt_length + 1));
+			for (char& character: request.prompt) {
+				character = static_cast<char>(' ' + generator.next_below(95));
+			}
+			request.generation_length = generation_length;
+		}
+	}
+};
+
+// Serves the whole workload as one burst at t = 0 and records time-to-first-token, inter-token latency and throughput
+template<typename engine_type> void run_sweep_repetition(engine_type& engine_instance, const synthetic_workload& workload, benchmark_metric* throughput, benchmark_metric* ttft,
+	benchmark_metric* itl) {
+	const uint64_t request_count{ workload.requests.size() };
+	std::vector<bench_clock::time_point> last_token_times(request_count);
+	const bench_clock::time_point start{ bench_clock::now() };
+	for (uint64_t index = 0; index < request_count; ++index) {
+		const synthetic_request& request{ workload.requests[index] };
+		const std::string_view prompt{ request.prompt.data(), std::min<uint64_t>(request.prompt.size(), engine_type::max_prompt_length) };
+		engine_instance.submit(request_params{ index, nullptr, 0, request.generation_length, sampling_params{}, index, prompt });
+	}
+	uint64_t token_count{};
+	while (!engine_instance.idle()) {
+		const std::span<const token_event> events{ engine_instance.step() };
+		const bench_clock::time_point now{ bench_clock::now() };
+		for (const token_event& event: events) {
+			if (event.first) {
+				if (ttft) {
+					ttft->samples.emplace_back(elapsed_milliseconds(start, now));
+				}
+			} else if (itl) {
+				itl->samples.emplace_back(elapsed_milliseconds(last_token_times[event.request_id], now));
+			}
+			last_token_times[event.request_id] = now;
+		}
+		token_count += events.size();
+		engine_instance.complete_streaming();
+	}
+	if (throughput) {
+		throughput->samples.emplace_back(static_cast<double>(token_count) / elapsed_seconds(start, bench_clock::now()));
+	}
+}
+
+template<const model_config& config> benchmark_result run_sweep_entry(const bench_options& options, const synthetic_workload& workload) {
+	using config_type = model_config_type<config>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using engine_type = engine<stand_in_model<config_type, shape_type>>;
+
+	benchmark_result result{};
+	result.name		   = "sweep/batch_" + std::to_string(config_type::max_batch_size) + "/context_" + std::to_string(config_type::max_context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", config_type::max_batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "max_prompt_length", config_type::max_prompt_length }, { "max_generation_length", config_type::max_generation_length },
+		 { "parameter_count", shape_type::parameter_count } };
+	benchmark_metric& throughput{ result.add_metric("tokens_per_second", "tokens/s", true) };
+	benchmark_metric& ttft{ result.add_metric("ttft_ms", "ms", false) };
+	benchmark_metric& itl{ result.add_metric("itl_ms", "ms", false) };
+
+	phase_metric_set phases{};
+	phases.add_to(result);
+
+	std::cerr << "running " << result.name << std::endl;
+	const auto engine_instance{ std::make_unique<engine_type>() };
+	for (uint64_t repetition = 0; repetition < options.warmup_repetitions; ++repetition) {
+		run_sweep_repetition(*engine_instance, workload, nullptr, nullptr, nullptr);
+	}
+	for (uint64_t repetition = 0; repetition < options.repetitions; ++repetition) {
+		engine_instance->phase_metrics.get().reset();
+		run_sweep_repetition(*engine_instance, workload, &throughput, &ttft, &itl);
+		phases.record(engine_instance->phase_metrics.get());
+	}
+	return result;
+}
+
+template<uint64_t batch_size, uint64_t... context_indices> void run_sweep_row(const bench_options& options, const synthetic_workload& workload, benchmark_report& report,
+	std::index_sequence<context_indices...>) {
+	(report.results.emplace_back(run_sweep_entry<sweep_config<batch_size, sweep_context_lengths[context_indices]>>(options, workload)), ...);
+}
+
+template<uint64_t... batch_indices> void run_sweep_grid(const bench_options& options, const synthetic_workload& workload, benchmark_report& report,
+	std::index_sequence<batch_indices...>) {
+	(run_sweep_row<sweep_batch_sizes[batch_indices]>(options, workload, report, std::make_index_sequence<std::size(sweep_context_lengths)>{}), ...);
+}
+
+inline benchmark_report run_sweep_suite(const bench_options& options) {
+	benchmark_report report{ "sweep", {} };
+	synthetic_workload workload{};
+	workload.generate(options.request_count, options.seed);
+	run_sweep_grid(options, workload, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+	return report;
+}
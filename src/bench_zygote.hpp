@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "bench_startup.hpp"
+#include "zygote.hpp"
+#include <fstream>
+
+// Worker spawn - for every sweep batch size at the largest context, compares building an engine in-process (cold_start_ms)
+// with forking a ready worker from an engine_zygote (spawn_ms). Each worker serves one request, reports its latency and is
+// measured from /proc before it exits: shared_mb is what it shares with the zygote and its siblings, private_mb what it owns
+
+#if !defined(_WIN32)
+// Everything up to run_zygote_suite forks and talks over pipes, so it only exists where fork() does
+
+// Resident memory of one process from /proc/<pid>/smaps_rollup, in bytes - all zero where that file is unavailable
+struct process_memory {
+	uint64_t rss{};
+	uint64_t shared{};
+	uint64_t private_bytes{};
+};
+
+inline process_memory read_process_memory(int64_t pid) {
+	process_memory return_value{};
+	std::ifstream file{ "/proc/" + std::to_string(pid) + "/smaps_rollup" };
+	std::string key{};
+	uint64_t kilobytes{};
+	std::string unit{};
+	while (file >> key) {
+		if (!(file >> kilobytes)) {
+			file.clear();
+			std::getline(file, unit);
+			continue;
+		}
+		file >> unit;
+		if (key == "Rss:") {
+			return_value.rss = kilobytes * 1024;
+		} else if (key == "Shared_Clean:" || key == "Shared_Dirty:") {
+			return_value.shared += kilobytes * 1024;
+		} else if (key == "Private_Clean:" || key == "Private_Dirty:") {
+			return_value.private_bytes += kilobytes * 1024;
+		}
+	}
+	return return_value;
+}
+
+template<uint64_t batch_size> inline constexpr model_config zygote_warmup_config{ generate_model_config(sweep_config<batch_size, sweep_context_lengths[1]>,
+	warmup_type::enabled) };
+
+template<const model_config& config> benchmark_result run_zygote_entry(const bench_options& options, const char* variant) {
+	using config_type = model_config_type<config>;
+	using shape_type  = model_shape_type<sweep_shape>;
+	using engine_type = engine<stand_in_model<config_type, shape_type>>;
+
+	benchmark_result result{};
+	result.name		   = std::string{ "zygote/" } + variant + "/batch_" + std::to_string(config_type::max_batch_size) + "/context_" + std::to_string(config_type::max_context_length);
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	result.parameters  = { { "max_batch_size", config_type::max_batch_size }, { "max_context_length", config_type::max_context_length },
+		 { "weight_bytes", memory_plan<config_type, shape_type>::layout.weight_bytes }, { "warmup", config_type::warmup } };
+	benchmark_metric& cold_start{ result.add_metric("cold_start_ms", "ms", false) };
+	benchmark_metric& spawn{ result.add_metric("spawn_ms", "ms", false) };
+	benchmark_metric& first_request{ result.add_metric("first_request_ms", "ms", false) };
+	benchmark_metric& rss{ result.add_metric("rss_mb", "MiB", false) };
+	benchmark_metric& shared{ result.add_metric("shared_mb", "MiB", true) };
+	benchmark_metric& private_memory{ result.add_metric("private_mb", "MiB", false) };
+
+	std::cerr << "running " << result.name << std::endl;
+	// Workers report first-request latency on result_pipe, then block on release_pipe until they have been measured
+	int result_pipe[2]{};
+	int release_pipe[2]{};
+	if (pipe(result_pipe) != 0 || pipe(release_pipe) != 0) {
+		std::cerr << "zygote: failed to create pipes\n";
+		return result;
+	}
+	engine_zygote<engine_type> zygote{};
+	const zygote_status started{ zygote.start([&](engine_type& worker_engine, uint64_t worker_id) {
+		const std::string prompt(std::min(first_request_prompt_length, engine_type::max_prompt_length), 'a');
+		const uint64_t start_ns{ monotonic_nanoseconds() };
+		worker_engine.submit(request_params{ worker_id, nullptr, 0, first_request_generation_length, sampling_params{}, worker_id, prompt });
+		while (!worker_engine.idle()) {
+			worker_engine.step();
+		}
+		const uint64_t request_ns{ monotonic_nanoseconds() - start_ns };
+		char release{};
+		const bool reported{ write(result_pipe[1], &request_ns, sizeof(request_ns)) == static_cast<ssize_t>(sizeof(request_ns)) };
+		return reported && read(release_pipe[0], &release, 1) == 1 ? 0 : 1;
+	}) };
+
+	for (uint64_t repetition = 0; started == zygote_status::ready && repetition < options.warmup_repetitions + options.repetitions; ++repetition) {
+		const uint64_t cold_start_ns{ monotonic_nanoseconds() };
+		static_cast<void>(std::make_unique<engine_type>());
+		const uint64_t cold_ns{ monotonic_nanoseconds() - cold_start_ns };
+
+		zygote_spawn_reply reply{};
+		const uint64_t spawn_start_ns{ monotonic_nanoseconds() };
+		if (zygote.spawn(repetition, reply) != zygote_status::ready) {
+			std::cerr << "zygote: spawn failed\n";
+			break;
+		}
+		const uint64_t spawn_ns{ reply.ready_ns - spawn_start_ns };
+		uint64_t request_ns{};
+		const bool reported{ read(result_pipe[0], &request_ns, sizeof(request_ns)) == static_cast<ssize_t>(sizeof(request_ns)) };
+		const process_memory memory{ read_process_memory(reply.pid) };
+		const char release{};
+		if (write(release_pipe[1], &release, 1) != 1 || !reported) {
+			std::cerr << "zygote: worker did not report\n";
+			break;
+		}
+		if (repetition < options.warmup_repetitions) {
+			continue;
+		}
+		cold_start.samples.emplace_back(static_cast<double>(cold_ns) / 1.0e6);
+		spawn.samples.emplace_back(static_cast<double>(spawn_ns) / 1.0e6);
+		first_request.samples.emplace_back(static_cast<double>(request_ns) / 1.0e6);
+		rss.samples.emplace_back(static_cast<double>(memory.rss) / 1048576.0);
+		shared.samples.emplace_back(static_cast<double>(memory.shared) / 1048576.0);
+		private_memory.samples.emplace_back(static_cast<double>(memory.private_bytes) / 1048576.0);
+	}
+	zygote.stop();
+	for (int fd: { result_pipe[0], result_pipe[1], release_pipe[0], release_pipe[1] }) {
+		close(fd);
+	}
+	return result;
+}
+
+template<uint64_t... batch_indices> void run_zygote_grid(const bench_options& options, benchmark_report& report, std::index_sequence<batch_indices...>) {
+	(report.results.emplace_back(run_zygote_entry<sweep_config<sweep_batch_sizes[batch_indices], sweep_context_lengths[1]>>(options, "default")), ...);
+	(report.results.emplace_back(run_zygote_entry<zygote_warmup_config<sweep_batch_sizes[batch_indices]>>(options, "warmup")), ...);
+}
+#endif
+
+inline benchmark_report run_zygote_suite(const bench_options& options) {
+	benchmark_report report{ "zygote", {} };
+#if defined(_WIN32)
+	std::cerr << "zygote: fork is not available on this platform\n";
+#else
+	run_zygote_grid(options, report, std::make_index_sequence<std::size(sweep_batch_sizes)>{});
+#endif
+	return report;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "json_writer.hpp"
+#include "request_timeline.hpp"
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <string>
+#include <utility>
+
+using bench_clock = std::chrono::steady_clock;
+
+OACC_INLINE double elapsed_milliseconds(bench_clock::time_point start, bench_clock::time_point end) noexcept {
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+OACC_INLINE double elapsed_seconds(bench_clock::time_point start, bench_clock::time_point end) noexcept {
+	return std::chrono::duration<double>(end - start).count();
+}
+
+// Nearest-rank percentile over already sorted samples, fraction in [0, 1]
+inline double sorted_percentile(const std::vector<double>& sorted_samples, double fraction) noexcept {
+	if (sorted_samples.empty()) {
+		return 0.0;
+	}
+	const double rank{ fraction * static_cast<double>(sorted_samples.size() - 1) };
+	return sorted_samples[static_cast<uint64_t>(rank + 0.5)];
+}
+
+struct metric_summary {
+	uint64_t count{};
+	double mean{};
+	double min{};
+	double p50{};
+	double p90{};
+	double p99{};
+	double max{};
+};
+
+inline metric_summary summarize(std::vector<double> samples) {
+	metric_summary return_value{};
+	if (samples.empty()) {
+		return return_value;
+	}
+	std::sort(samples.begin(), samples.end());
+	return_value.count = samples.size();
+	return_value.mean  = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	return_value.min   = samples.front();
+	return_value.p50   = sorted_percentile(samples, 0.50);
+	return_value.p90   = sorted_percentile(samples, 0.90);
+	return_value.p99   = sorted_percentile(samples, 0.99);
+	return_value.max   = samples.back();
+	return return_value;
+}
+
+// Raw samples are always kept so reports can be compared statistically, not just by their summaries
+struct benchmark_metric {
+	std::string name{};
+	std::string unit{};
+	bool higher_is_better{};
+	std::vector<double> samples{};
+};
+
+// One benchmark instance - parameters record the configuration values that distinguish it inside its suite
+struct benchmark_result {
+	std::string name{};
+	uint64_t fingerprint{};
+	std::vector<std::pair<std::string, uint64_t>> parameters{};
+	std::deque<benchmark_metric> metrics{};
+
+	// References stay valid as further metrics are added
+	benchmark_metric& add_metric(std::string metric_name, std::string unit, bool higher_is_better) {
+		return metrics.emplace_back(benchmark_metric{ std::move(metric_name), std::move(unit), higher_is_better, {} });
+	}
+};
+
+// p50 and p99 of every request phase, read from the engine's histograms - one sample per record() call, typically per repetition
+struct phase_metric_set {
+	std::array<benchmark_metric*, request_phase_count> p50{};
+	std::array<benchmark_metric*, request_phase_count> p99{};
+
+	void add_to(benchmark_result& result) {
+		for (uint64_t index = 0; index < request_phase_count; ++index) {
+			p50[index] = &result.add_metric(std::string{ request_phase_names[index] } + "_p50_us", "us", false);
+			p99[index] = &result.add_metric(std::string{ request_phase_names[index] } + "_p99_us", "us", false);
+		}
+	}
+
+	void record(const request_phase_metrics& metrics) {
+		for (uint64_t index = 0; index < request_phase_count; ++index) {
+			p50[index]->samples.emplace_back(static_cast<double>(metrics.phases[index].percentile(0.50)));
+			p99[index]->samples.emplace_back(static_cast<double>(metrics.phases[index].percentile(0.99)));
+		}
+	}
+};
+
+// The JSON document every oacc_bench suite emits
+struct benchmark_report {
+	std::string suite{};
+	std::vector<benchmark_result> results{};
+
+	std::string to_json() const {
+		json_writer writer{};
+		writer.begin_object();
+		writer.member("suite", std::string_view{ suite });
+		writer.key("benchmarks");
+		writer.begin_array();
+		for (const benchmark_result& result: results) {
+			char fingerprint_text[24];
+			std::snprintf(fingerprint_text, sizeof(fingerprint_text), "%016llx", static_cast<unsigned long long>(result.fingerprint));
+			writer.begin_object();
+			writer.member("name", std::string_view{ result.name });
+			writer.member("fingerprint", std::string_view{ fingerprint_text });
+			writer.key("parameters");
+			writer.begin_object();
+			for (const auto& [parameter_name, parameter_value]: result.parameters) {
+				writer.member(parameter_name, parameter_value);
+			}
+			writer.end_object();
+			writer.key("metrics");
+			writer.begin_object();
+			for (const benchmark_metric& metric: result.metrics) {
+				const metric_summary summary{ summarize(metric.samples) };
+				writer.key(metric.name);
+				writer.begin_object();
+				writer.member("unit", std::string_view{ metric.unit });
+				writer.member("higher_is_better", metric.higher_is_better);
+				writer.member("count", summary.count);
+				writer.member("mean", summary.mean);
+				writer.member("min", summary.min);
+				writer.member("p50", summary.p50);
+				writer.member("p90", summary.p90);
+				writer.member("p99", summary.p99);
+				writer.member("max", summary.max);
+				writer.key("samples");
+				writer.begin_array();
+				for (const double sample: metric.samples) {
+					writer.value(sample);
+				}
+				writer.end_array();
+				writer.end_object();
+			}
+			writer.end_object();
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+		writer.buffer += '\n';
+		return writer.buffer;
+	}
+};
+
+// Command line options shared by every oacc_bench suite - suites ignore what does not apply to them
+struct bench_options {
+	std::string suite{ "sweep" };
+	std::string output_path{};
+	// oacc_baseline's Mann-Whitney test can reject at its default alpha of 0.05 from four samples per side, but only when they do not
+	// overlap at all - five leaves room for some overlap
+	uint64_t repetitions{ 5 };
+	uint64_t warmup_repetitions{ 1 };
+	uint64_t request_count{ 16 };
+	uint64_t seed{ 1234 };
+};
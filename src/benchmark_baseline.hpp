@@ -0,0 +1,438 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "json_reader.hpp"
+#include "random.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+// Named local baselines of oacc_bench reports and a statistical comparator between two reports
+// Results are matched by benchmark name; a matching name with a different configuration fingerprint is reported as
+// config_changed rather than compared, since the numbers no longer measure the same thing
+
+enum class baseline_status {
+	ok,
+	invalid_name,
+	open_failed,
+	parse_failed,
+	write_failed,
+};
+
+// Inverse of benchmark_report::to_json - summaries are not read back, they are recomputed from the samples
+inline bool report_from_json(const json_value& document, benchmark_report& report) {
+	const json_value* suite{ document.find("suite") };
+	const json_value* benchmarks{ document.find("benchmarks") };
+	if (!suite || suite->type != json_value::kind::string || !benchmarks || benchmarks->type != json_value::kind::array) {
+		return false;
+	}
+	report.suite = suite->string;
+	report.results.clear();
+	for (const json_value& entry: benchmarks->elements) {
+		const json_value* name{ entry.find("name") };
+		const json_value* fingerprint{ entry.find("fingerprint") };
+		const json_value* parameters{ entry.find("parameters") };
+		const json_value* metrics{ entry.find("metrics") };
+		if (!name || !fingerprint || !parameters || !metrics || fingerprint->type != json_value::kind::string) {
+			return false;
+		}
+		benchmark_result& result{ report.results.emplace_back() };
+		result.name = name->string;
+		if (std::from_chars(fingerprint->string.data(), fingerprint->string.data() + fingerprint->string.size(), result.fingerprint, 16).ec != std::errc{}) {
+			return false;
+		}
+		for (const auto& [parameter_name, parameter_value]: parameters->members) {
+			result.parameters.emplace_back(parameter_name, static_cast<uint64_t>(parameter_value.as_number()));
+		}
+		for (const auto& [metric_name, metric_value]: metrics->members) {
+			const json_value* unit{ metric_value.find("unit") };
+			const json_value* higher_is_better{ metric_value.find("higher_is_better") };
+			const json_value* samples{ metric_value.find("samples") };
+			if (!unit || !higher_is_better || !samples) {
+				return false;
+			}
+			benchmark_metric& metric{ result.add_metric(metric_name, unit->string, higher_is_better->boolean) };
+			for (const json_value& sample: samples->elements) {
+				metric.samples.emplace_back(sample.as_number());
+			}
+		}
+	}
+	return true;
+}
+
+inline baseline_status load_benchmark_report(const std::filesystem::path& path, benchmark_report& report) {
+	std::ifstream stream{ path, std::ios::binary };
+	if (!stream) {
+		return baseline_status::open_failed;
+	}
+	std::stringstream contents{};
+	contents << stream.rdbuf();
+	json_value document{};
+	if (!parse_json(contents.str(), document) || !report_from_json(document, report)) {
+		return baseline_status::parse_failed;
+	}
+	return baseline_status::ok;
+}
+
+// One JSON file per baseline name under directory - names are restricted so they can never escape it
+struct baseline_store {
+	std::filesystem::path directory{ ".oacc_baselines" };
+
+	static bool valid_name(std::string_view name) noexcept {
+		if (name.empty() || name.front() == '.') {
+			return false;
+		}
+		for (const char character: name) {
+			const bool allowed{ (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') ||
+				character == '.' || character == '_' || character == '-' };
+			if (!allowed) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::filesystem::path path_for(std::string_view name) const {
+		return directory / (std::string{ name } + ".json");
+	}
+
+	baseline_status save(std::string_view name, const benchmark_report& report) const {
+		if (!valid_name(name)) {
+			return baseline_status::invalid_name;
+		}
+		std::error_code error{};
+		std::filesystem::create_directories(directory, error);
+		std::ofstream stream{ path_for(name), std::ios::binary };
+		stream << report.to_json();
+		return stream ? baseline_status::ok : baseline_status::write_failed;
+	}
+
+	baseline_status load(std::string_view name, benchmark_report& report) const {
+		if (!valid_name(name)) {
+			return baseline_status::invalid_name;
+		}
+		return load_benchmark_report(path_for(name), report);
+	}
+
+	std::vector<std::string> list() const {
+		std::vector<std::string> return_value{};
+		std::error_code error{};
+		for (const auto& entry: std::filesystem::directory_iterator{ directory, error }) {
+			if (entry.path().extension() == ".json") {
+				return_value.emplace_back(entry.path().stem().string());
+			}
+		}
+		std::sort(return_value.begin(), return_value.end());
+		return return_value;
+	}
+};
+
+inline double sample_median(std::vector<double> samples) {
+	std::sort(samples.begin(), samples.end());
+	return sorted_percentile(samples, 0.5);
+}
+
+// Below this many samples per side the exact null distribution of U is used, assuming no ties
+inline constexpr uint64_t mann_whitney_exact_limit{ 20 };
+
+// Smallest two-sided p-value the test can produce for these sample counts - when it is not below alpha,
+// no difference can ever be called significant and more repetitions are needed
+inline double mann_whitney_min_p_value(uint64_t lhs_count, uint64_t rhs_count) noexcept {
+	double combinations{ 1.0 };
+	for (uint64_t index = 1; index <= lhs_count; ++index) {
+		combinations = combinations * static_cast<double>(rhs_count + index) / static_cast<double>(index);
+	}
+	return std::min(1.0, 2.0 / combinations);
+}
+
+// Two-sided Mann-Whitney U test - exact for small samples, normal approximation with tie and continuity correction otherwise
+inline double mann_whitney_p_value(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+	const uint64_t lhs_count{ lhs.size() };
+	const uint64_t rhs_count{ rhs.size() };
+	const uint64_t total_count{ lhs_count + rhs_count };
+	if (lhs_count == 0 || rhs_count == 0) {
+		return 1.0;
+	}
+	std::vector<std::pair<double, bool>> combined{};
+	combined.reserve(total_count);
+	for (const double sample: lhs) {
+		combined.emplace_back(sample, true);
+	}
+	for (const double sample: rhs) {
+		combined.emplace_back(sample, false);
+	}
+	std::sort(combined.begin(), combined.end(), [](const auto& left, const auto& right) {
+		return left.first < right.first;
+	});
+	double lhs_rank_sum{};
+	double tie_term{};
+	for (uint64_t start = 0; start < total_count;) {
+		uint64_t end{ start + 1 };
+		while (end < total_count && combined[end].first == combined[start].first) {
+			++end;
+		}
+		const double tie_count{ static_cast<double>(end - start) };
+		const double mid_rank{ static_cast<double>(start + end + 1) / 2.0 };
+		for (uint64_t index = start; index < end; ++index) {
+			lhs_rank_sum += combined[index].second ? mid_rank : 0.0;
+		}
+		tie_term += tie_count * tie_count * tie_count - tie_count;
+		start = end;
+	}
+	const double u_statistic{ lhs_rank_sum - static_cast<double>(lhs_count * (lhs_count + 1)) / 2.0 };
+
+	if (lhs_count <= mann_whitney_exact_limit && rhs_count <= mann_whitney_exact_limit && tie_term == 0.0) {
+		// counts[i][j][u] = orderings of i lhs and j rhs samples with U = u, built from which side holds the largest sample
+		const uint64_t max_u{ lhs_count * rhs_count };
+		std::vector<std::vector<double>> counts((lhs_count + 1) * (rhs_count + 1), std::vector<double>(max_u + 1));
+		for (uint64_t i = 0; i <= lhs_count; ++i) {
+			for (uint64_t j = 0; j <= rhs_count; ++j) {
+				std::vector<double>& current{ counts[i * (rhs_count + 1) + j] };
+				if (i == 0 || j == 0) {
+					current[0] = 1.0;
+					continue;
+				}
+				const std::vector<double>& lhs_largest{ counts[(i - 1) * (rhs_count + 1) + j] };
+				const std::vector<double>& rhs_largest{ counts[i * (rhs_count + 1) + j - 1] };
+				for (uint64_t u = 0; u <= i * j; ++u) {
+					current[u] = (u >= j ? lhs_largest[u - j] : 0.0) + rhs_largest[u];
+				}
+			}
+		}
+		const std::vector<double>& distribution{ counts.back() };
+		const uint64_t observed{ static_cast<uint64_t>(u_statistic + 0.5) };
+		double total{};
+		double lower{};
+		double upper{};
+		for (uint64_t u = 0; u <= max_u; ++u) {
+			total += distribution[u];
+			lower += u <= observed ? distribution[u] : 0.0;
+			upper += u >= observed ? distribution[u] : 0.0;
+		}
+		return std::min(1.0, 2.0 * std::min(lower, upper) / total);
+	}
+
+	const double product{ static_cast<double>(lhs_count * rhs_count) };
+	const double total{ static_cast<double>(total_count) };
+	const double variance{ product / 12.0 * ((total + 1.0) - tie_term / (total * (total - 1.0))) };
+	if (variance <= 0.0) {
+		return 1.0;
+	}
+	const double z{ std::max(0.0, std::abs(u_statistic - product / 2.0) - 0.5) / std::sqrt(variance) };
+	return std::erfc(z / std::sqrt(2.0));
+}
+
+struct change_interval {
+	double low{};
+	double high{};
+};
+
+// Percentile bootstrap interval for median(candidate) / median(baseline) - 1, seeded so a comparison is reproducible
+inline change_interval bootstrap_median_change(const std::vector<double>& baseline, const std::vector<double>& candidate, uint64_t resample_count, double confidence,
+	uint64_t seed) {
+	random_generator generator{ seed };
+	std::vector<double> changes(resample_count);
+	std::vector<double> baseline_resample(baseline.size());
+	std::vector<double> candidate_resample(candidate.size());
+	for (double& change: changes) {
+		for (double& sample: baseline_resample) {
+			sample = baseline[generator.next_below(baseline.size())];
+		}
+		for (double& sample: candidate_resample) {
+			sample = candidate[generator.next_below(candidate.size())];
+		}
+		change = sample_median(candidate_resample) / sample_median(baseline_resample) - 1.0;
+	}
+	std::sort(changes.begin(), changes.end());
+	const double tail{ (1.0 - confidence) / 2.0 };
+	return change_interval{ sorted_percentile(changes, tail), sorted_percentile(changes, 1.0 - tail) };
+}
+
+enum class comparison_verdict {
+	unchanged,
+	improved,
+	regressed,
+	insufficient_samples,
+	config_changed,
+	missing,
+	added,
+};
+
+inline constexpr std::string_view comparison_verdict_names[]{ "unchanged", "improved", "regressed", "insufficient_samples", "config_changed", "missing", "added" };
+
+// A change is only called when all three agree: Mann-Whitney rejects at alpha, the bootstrap interval excludes zero,
+// and the median moved by at least min_relative_change
+struct comparison_options {
+	double alpha{ 0.05 };
+	double min_relative_change{ 0.02 };
+	uint64_t resample_count{ 2000 };
+	double confidence{ 0.95 };
+	uint64_t seed{ 1234 };
+};
+
+// Benchmark-level verdicts (config_changed, missing, added) carry an empty metric name
+// possible_regression marks an insufficient_samples metric whose median still moved by min_relative_change in the worse direction
+struct metric_comparison {
+	std::string benchmark{};
+	std::string metric{};
+	std::string unit{};
+	uint64_t baseline_fingerprint{};
+	uint64_t candidate_fingerprint{};
+	uint64_t baseline_count{};
+	uint64_t candidate_count{};
+	double baseline_median{};
+	double candidate_median{};
+	double relative_change{};
+	change_interval interval{};
+	double p_value{ 1.0 };
+	comparison_verdict verdict{};
+	bool possible_regression{};
+};
+
+struct comparison_report {
+	std::vector<metric_comparison> comparisons{};
+
+	uint64_t count(comparison_verdict verdict) const noexcept {
+		return static_cast<uint64_t>(std::count_if(comparisons.begin(), comparisons.end(), [&](const metric_comparison& comparison) {
+			return comparison.verdict == verdict;
+		}));
+	}
+
+	uint64_t possible_regression_count() const noexcept {
+		return static_cast<uint64_t>(std::count_if(comparisons.begin(), comparisons.end(), [](const metric_comparison& comparison) {
+			return comparison.possible_regression;
+		}));
+	}
+
+	std::string to_json() const {
+		json_writer writer{};
+		writer.begin_object();
+		writer.member("regressed", count(comparison_verdict::regressed));
+		writer.member("improved", count(comparison_verdict::improved));
+		writer.member("possible_regressions", possible_regression_count());
+		writer.key("comparisons");
+		writer.begin_array();
+		for (const metric_comparison& comparison: comparisons) {
+			char baseline_fingerprint[24];
+			char candidate_fingerprint[24];
+			std::snprintf(baseline_fingerprint, sizeof(baseline_fingerprint), "%016llx", static_cast<unsigned long long>(comparison.baseline_fingerprint));
+			std::snprintf(candidate_fingerprint, sizeof(candidate_fingerprint), "%016llx", static_cast<unsigned long long>(comparison.candidate_fingerprint));
+			writer.begin_object();
+			writer.member("benchmark", std::string_view{ comparison.benchmark });
+			writer.member("metric", std::string_view{ comparison.metric });
+			writer.member("unit", std::string_view{ comparison.unit });
+			writer.member("baseline_fingerprint", std::string_view{ baseline_fingerprint });
+			writer.member("candidate_fingerprint", std::string_view{ candidate_fingerprint });
+			writer.member("baseline_count", comparison.baseline_count);
+			writer.member("candidate_count", comparison.candidate_count);
+			writer.member("baseline_median", comparison.baseline_median);
+			writer.member("candidate_median", comparison.candidate_median);
+			writer.member("relative_change", comparison.relative_change);
+			writer.member("interval_low", comparison.interval.low);
+			writer.member("interval_high", comparison.interval.high);
+			writer.member("p_value", comparison.p_value);
+			writer.member("verdict", comparison_verdict_names[static_cast<uint64_t>(comparison.verdict)]);
+			writer.member("possible_regression", comparison.possible_regression);
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+		writer.buffer += '\n';
+		return writer.buffer;
+	}
+};
+
+inline metric_comparison compare_metric(const benchmark_result& baseline_result, const benchmark_metric& baseline, const benchmark_metric& candidate,
+	const comparison_options& options) {
+	metric_comparison return_value{};
+	return_value.benchmark			   = baseline_result.name;
+	return_value.metric				   = candidate.name;
+	return_value.unit				   = candidate.unit;
+	return_value.baseline_fingerprint  = baseline_result.fingerprint;
+	return_value.candidate_fingerprint = baseline_result.fingerprint;
+	return_value.baseline_count		   = baseline.samples.size();
+	return_value.candidate_count	   = candidate.samples.size();
+	if (baseline.samples.empty() || candidate.samples.empty()) {
+		return_value.verdict = comparison_verdict::insufficient_samples;
+		return return_value;
+	}
+	return_value.baseline_median  = sample_median(baseline.samples);
+	return_value.candidate_median = sample_median(candidate.samples);
+	return_value.relative_change  = return_value.candidate_median / return_value.baseline_median - 1.0;
+	if (mann_whitney_min_p_value(baseline.samples.size(), candidate.samples.size()) >= options.alpha) {
+		return_value.verdict			 = comparison_verdict::insufficient_samples;
+		return_value.possible_regression = std::abs(return_value.relative_change) >= options.min_relative_change && (return_value.relative_change > 0.0) != candidate.higher_is_better;
+		return return_value;
+	}
+	return_value.p_value  = mann_whitney_p_value(baseline.samples, candidate.samples);
+	return_value.interval = bootstrap_median_change(baseline.samples, candidate.samples, options.resample_count, options.confidence, options.seed);
+	const bool significant{ return_value.p_value < options.alpha && (return_value.interval.low > 0.0 || return_value.interval.high < 0.0) &&
+		std::abs(return_value.relative_change) >= options.min_relative_change };
+	if (significant) {
+		const bool increased{ return_value.relative_change > 0.0 };
+		return_value.verdict = increased == candidate.higher_is_better ? comparison_verdict::improved : comparison_verdict::regressed;
+	}
+	return return_value;
+}
+
+inline comparison_report compare_reports(const benchmark_report& baseline, const benchmark_report& candidate, const comparison_options& options = {}) {
+	comparison_report return_value{};
+	const auto find_result = [](const benchmark_report& report, const std::string& name) -> const benchmark_result* {
+		for (const benchmark_result& result: report.results) {
+			if (result.name == name) {
+				return &result;
+			}
+		}
+		return nullptr;
+	};
+	for (const benchmark_result& candidate_result: candidate.results) {
+		const benchmark_result* baseline_result{ find_result(baseline, candidate_result.name) };
+		if (!baseline_result || baseline_result->fingerprint != candidate_result.fingerprint) {
+			metric_comparison& comparison{ return_value.comparisons.emplace_back() };
+			comparison.benchmark			 = candidate_result.name;
+			comparison.candidate_fingerprint = candidate_result.fingerprint;
+			comparison.baseline_fingerprint	 = baseline_result ? baseline_result->fingerprint : 0;
+			comparison.verdict				 = baseline_result ? comparison_verdict::config_changed : comparison_verdict::added;
+			continue;
+		}
+		for (const benchmark_metric& candidate_metric: candidate_result.metrics) {
+			const auto baseline_metric{ std::find_if(baseline_result->metrics.begin(), baseline_result->metrics.end(), [&](const benchmark_metric& metric) {
+				return metric.name == candidate_metric.name;
+			}) };
+			if (baseline_metric == baseline_result->metrics.end()) {
+				metric_comparison& comparison{ return_value.comparisons.emplace_back() };
+				comparison.benchmark = candidate_result.name;
+				comparison.metric	 = candidate_metric.name;
+				comparison.verdict	 = comparison_verdict::added;
+				continue;
+			}
+			return_value.comparisons.emplace_back(compare_metric(*baseline_result, *baseline_metric, candidate_metric, options));
+		}
+	}
+	for (const benchmark_result& baseline_result: baseline.results) {
+		if (!find_result(candidate, baseline_result.name)) {
+			metric_comparison& comparison{ return_value.comparisons.emplace_back() };
+			comparison.benchmark			= baseline_result.name;
+			comparison.baseline_fingerprint = baseline_result.fingerprint;
+			comparison.verdict				= comparison_verdict::missing;
+		}
+	}
+	return return_value;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_plan.hpp"
+#include "errors.hpp"
+#include <algorithm>
+#include <barrier>
+#include <atomic>
+
+// Shared-memory stand-in for inter-GPU collectives - every rank of a group is a thread of one process, each calling
+// the same collective in the same order with its own rank index, exactly as NCCL-style ranks would
+// Each rank owns one staging slot of slot_capacity floats; results are reduced in rank order so every rank gets bit-identical output
+template<uint64_t rank_count, uint64_t slot_capacity, bool exceptions> struct shared_memory_group {
+	memory_arena arena{ rank_count * arena_bytes<float>(slot_capacity) };
+	float* slots{ arena.allocate<float>(rank_count * slot_capacity) };
+	std::barrier<> barrier{ static_cast<std::ptrdiff_t>(rank_count) };
+	// Bytes each rank received from its peers, summed over ranks - what an interconnect would have carried
+	std::atomic<uint64_t> bytes_exchanged{};
+
+	shared_memory_group() {
+		if (!slots) {
+			raise_runtime_error<exceptions>("shared_memory_group: failed to reserve staging slots");
+		}
+	}
+
+	OACC_INLINE float* slot(uint64_t rank) const noexcept {
+		return slots + rank * slot_capacity;
+	}
+
+	OACC_INLINE void check_count(uint64_t count) const {
+		if (count > slot_capacity) {
+			raise_runtime_error<exceptions>("shared_memory_group: collective larger than its staging slot");
+		}
+	}
+
+	void wait() {
+		barrier.arrive_and_wait();
+	}
+
+	// data = sum over every rank's data, count floats
+	void all_reduce_sum(uint64_t rank, float* data, uint64_t count) {
+		check_count(count);
+		std::copy_n(data, count, slot(rank));
+		barrier.arrive_and_wait();
+		std::copy_n(slot(0), count, data);
+		for (uint64_t peer = 1; peer < rank_count; ++peer) {
+			const float* peer_data{ slot(peer) };
+			for (uint64_t index = 0; index < count; ++index) {
+				data[index] += peer_data[index];
+			}
+		}
+		bytes_exchanged.fetch_add((rank_count - 1) * count * sizeof(float), std::memory_order_relaxed);
+		barrier.arrive_and_wait();
+	}
+
+	// out[rank * count .. (rank + 1) * count) = in of that rank
+	template<typename value_type> void all_gather(uint64_t rank, const value_type* in, uint64_t count, value_type* out) {
+		static_assert(sizeof(value_type) % sizeof(float) == 0 && alignof(value_type) <= arena_alignment);
+		constexpr uint64_t floats_per_value{ sizeof(value_type) / sizeof(float) };
+		check_count(count * floats_per_value);
+		std::copy_n(in, count, reinterpret_cast<value_type*>(slot(rank)));
+		barrier.arrive_and_wait();
+		for (uint64_t peer = 0; peer < rank_count; ++peer) {
+			std::copy_n(reinterpret_cast<const value_type*>(slot(peer)), count, out + peer * count);
+		}
+		bytes_exchanged.fetch_add((rank_count - 1) * count * sizeof(value_type), std::memory_order_relaxed);
+		barrier.arrive_and_wait();
+	}
+};
+
+// One group per fingerprint - a free function so that ranks, whose config types differ in gpu_rank, still reach the same instance
+template<uint64_t group_fingerprint, typename group_type> group_type& shared_group_instance() {
+	static group_type group{};
+	return group;
+}
+
+// Collectives subsystem of one rank - active only when gpu_count > 1
+// All ranks of a group share one shared_memory_group, keyed by rank_group_fingerprint and created by whichever rank touches it first
+// Staging slots hold one full activation tile per rank, the largest tensor a rank exchanges per step
+template<typename config_type, typename shape_type> struct collectives {
+	static constexpr bool active{ config_type::gpu_count > 1 };
+	static constexpr uint64_t rank_count{ config_type::gpu_count };
+	static constexpr uint64_t rank{ config_type::gpu_rank };
+	static constexpr uint64_t slot_capacity{ memory_plan<config_type, shape_type>::activation_row_count *
+		std::max({ shape_type::embedding_dim, shape_type::ffn_dim, shape_type::vocab_size }) };
+
+	using group_type = shared_memory_group<rank_count, slot_capacity, config_type::exceptions>;
+
+	group_type& group{ shared_group_instance<fingerprint_values(config_type::rank_group_fingerprint, shape_type::fingerprint), group_type>() };
+
+	void all_reduce_sum(float* data, uint64_t count) {
+		group.all_reduce_sum(rank, data, count);
+	}
+
+	template<typename value_type> void all_gather(const value_type* in, uint64_t count, value_type* out) {
+		group.all_gather(rank, in, count, out);
+	}
+
+	void wait() {
+		group.wait();
+	}
+};
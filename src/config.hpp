@@ -22,4 +22,14 @@
 	#define OACC_INLINE inline __attribute__((always_inline))
 #else
 	#define OACC_INLINE inline
+#endif
+
+// Read prefetch into every cache level - a hint only, compiled out where the compiler has no intrinsic for it
+#if defined(_MSC_VER)
+	#include <xmmintrin.h>
+	#define OACC_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+	#define OACC_PREFETCH(address) __builtin_prefetch(address, 0, 3)
+#else
+	#define OACC_PREFETCH(address) static_cast<void>(address)
 #endif
\ No newline at end of file
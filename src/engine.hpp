@@ -0,0 +1,570 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "stand_in_model.hpp"
+#include "request_timeline.hpp"
+#include "tokenizer.hpp"
+#include "prefix_cache.hpp"
+#include "collectives.hpp"
+#include "subsystem.hpp"
+#include "prefault.hpp"
+#include "runtime_sizing.hpp"
+#include "request_overrides.hpp"
+#include "request_trace.hpp"
+#include <type_traits>
+#include <deque>
+#include <span>
+
+// A request as submitted - either pre-tokenized prompt_tokens or raw prompt_text, which is tokenized on admission
+// Both are borrowed and must outlive the request's prefill
+// adapter_id selects a low-rank adapter, 0 runs the base model; overrides tighten the engine's limits for this request alone
+struct request_params {
+	uint64_t id{};
+	const uint32_t* prompt_tokens{};
+	uint64_t prompt_length{};
+	uint64_t generation_length{};
+	sampling_params sampling{};
+	uint64_t seed{};
+	std::string_view prompt_text{};
+	uint64_t adapter_id{};
+	request_overrides overrides{};
+};
+
+// Why submit() refused a request - requests are runtime input, so limits are reported rather than raised
+enum class request_status {
+	accepted,
+	empty_prompt,
+	prompt_too_long,
+	adapters_disabled,
+	model_unavailable,
+	queue_full,
+	duplicate_override,
+};
+
+// One generated token - first marks the token produced by prefill, finished the last token of the request
+// In scoring mode one event per prompt token instead, with the log-probability the model gives it after the tokens before it;
+// the first prompt token has nothing before it and carries 0
+struct token_event {
+	uint64_t request_id{};
+	uint32_t token{};
+	bool first{};
+	bool finished{};
+	float logprob{};
+};
+
+// Per-phase latency histograms - only under benchmark_type::enabled, and only once the first request completes
+template<typename config_type> struct phase_metrics_subsystem : request_phase_metrics {
+	static constexpr bool active{ config_type::benchmark };
+};
+
+// Request trace capture - only under trace_capture_type::enabled, built on the first arrival so the capture clock starts there
+template<typename config_type> struct trace_capture_subsystem : trace_recorder {
+	static constexpr bool active{ config_type::trace_capture };
+};
+
+// Continuous-batching engine over the fixed sequence slots of one model instance
+// Each step() admits pending requests into free slots and prefills them together as one packed batch, then runs a single decode
+// step for every other active slot
+// Slot count, context and generation limits are all compile-time constants from model_config_type - a request can only tighten its
+// own through request_overrides, resolved once on admission into request_limits kept in its slot
+// With benchmark_type::enabled every request carries a request_timeline and completed requests feed per-phase histograms;
+// with it disabled both collapse to empty members and no clock is read
+// Optional subsystems are lazy_subsystem members: compiled out when their config fields leave them inactive, built on first use otherwise
+// With trace_capture_type::enabled every accepted request and every cancellation is recorded as a request trace line, as requested
+// and before any clamping, so oacc_replay can replay the capture
+// With warmup_type::enabled the constructor also runs warmup(), so the instance is only marked ready once nothing is left cold
+// Every active slot pins its adapter in the model's adapter cache from admission until it finishes or is cancelled
+// Constructed from a runtime_sizing, the engine serves at most its max_batch_size slots at once and admits a request only while
+// the KV blocks reserved for its prompt and generation fit in kv_block_count; warmup then commits only that much KV
+// With a max_generation_length of zero the engine scores instead: an admitted request is prefilled chunk by chunk into the one
+// KV slot, streams a logprob event per prompt token from the same step and releases its slot - no decode step, no sampling
+template<typename model_type_new> struct engine {
+	using model_type		 = model_type_new;
+	using config_type		 = typename model_type::config_type;
+	using shape_type		 = typename model_type::shape_type;
+	using tokenizer_type	 = byte_tokenizer<shape_type::vocab_size>;
+	using timeline_type		 = std::conditional_t<config_type::benchmark, request_timeline, disabled_request_timeline>;
+	using adapter_cache_type = typename model_type::adapter_cache_type;
+
+	static constexpr uint64_t max_batch_size		= config_type::max_batch_size;
+	static constexpr uint64_t max_context_length	= config_type::max_context_length;
+	static constexpr uint64_t max_prompt_length		= config_type::max_prompt_length;
+	static constexpr uint64_t max_generation_length = config_type::max_generation_length;
+	static constexpr uint64_t vocab_size			= shape_type::vocab_size;
+	static constexpr bool scoring					= config_type::scoring;
+	// A scoring step streams the events of whole prompts, so it has room for at least one of the longest
+	static constexpr uint64_t max_event_count = scoring ? std::max(2 * max_batch_size, max_prompt_length) : 2 * max_batch_size;
+
+	static constexpr runtime_sizing declared_sizing{ compute_runtime_sizing(model_type::plan_type::shape, model_type::plan_type::limits, unbounded_memory_bytes) };
+
+	struct queued_request {
+		request_params params{};
+		[[no_unique_address]] timeline_type timeline{};
+	};
+
+	struct sequence_slot {
+		uint64_t request_id{};
+		uint64_t generated_count{};
+		uint64_t generation_length{};
+		uint32_t position{};
+		uint32_t last_token{};
+		uint32_t adapter_slot{ model_type::no_adapter_slot };
+		uint64_t kv_block_count{};
+		request_limits limits{};
+		sampling_params sampling{};
+		random_generator generator{ 0 };
+		bool active{};
+		[[no_unique_address]] timeline_type timeline{};
+	};
+
+	// Requests admitted by one step, prefilled together as one packed batch once admission stops - sequence s prefills
+	// offsets[s + 1] - offsets[s] tokens from tokens[s], the part of its prompt the prefix cache did not cover
+	struct packed_admissions {
+		std::array<const uint32_t*, max_batch_size> tokens{};
+		std::array<uint32_t, max_batch_size + 1> offsets{};
+		std::array<uint32_t, max_batch_size> slots{};
+		std::array<uint32_t, max_batch_size> start_positions{};
+		std::array<uint32_t, max_batch_size> adapter_slots{};
+		std::array<sampling_params, max_batch_size> sampling{};
+		uint64_t count{};
+	};
+
+	model_type model{};
+	tokenizer_type tokenizer{};
+	memory_arena prompt_arena{};
+	uint32_t* prompt_buffer{};
+	std::array<sequence_slot, max_batch_size> slots{};
+	packed_admissions admitted{};
+	std::deque<queued_request> pending{};
+	std::array<token_event, max_event_count> events{};
+	uint64_t event_count{};
+	uint64_t active_count{};
+	runtime_sizing sizing{ declared_sizing };
+	uint64_t reserved_block_count{};
+
+	// Timelines of requests finished by the last step, waiting for the caller to confirm their tokens were streamed
+	std::array<timeline_type, max_event_count> finished_timelines{};
+	uint64_t finished_count{};
+	[[no_unique_address]] lazy_subsystem<phase_metrics_subsystem<config_type>> phase_metrics{};
+	[[no_unique_address]] lazy_subsystem<prefix_cache<config_type, shape_type>> prefixes{};
+	[[no_unique_address]] lazy_subsystem<collectives<config_type, shape_type>> rank_collectives{};
+	[[no_unique_address]] lazy_subsystem<trace_capture_subsystem<config_type>> trace_capture{};
+
+	engine() : engine(declared_sizing) {
+	}
+
+	// Continues the model's startup profile - the instance is ready once the engine's own arena and the tokenizer are in place
+	explicit engine(const runtime_sizing& sizing_new) : sizing{ sizing_new } {
+		if (!sizing.fits || sizing.max_batch_size > max_batch_size || sizing.kv_block_count > declared_sizing.kv_block_count) {
+			raise_runtime_error<config_type::exceptions>("engine: runtime sizing does not fit this host or exceeds the declared limits");
+		}
+		uint64_t phase_start_ns{ monotonic_nanoseconds() };
+		reserve_prompt_arena();
+		phase_start_ns = model.startup.record(startup_phase::arena_reservation, phase_start_ns);
+		tokenizer.load(shape_type::weight_seed);
+		phase_start_ns = model.startup.record(startup_phase::tokenizer_load, phase_start_ns);
+		if constexpr (config_type::warmup) {
+			warmup();
+			model.startup.record(startup_phase::warmup, phase_start_ns);
+		}
+		model.startup.mark_ready();
+	}
+
+	void reserve_prompt_arena() {
+		prompt_arena  = memory_arena{ compute_prompt_arena_bytes(model_type::plan_type::limits) };
+		prompt_buffer = prompt_arena.allocate<uint32_t>(max_batch_size * max_prompt_length);
+		if (!prompt_buffer) {
+			raise_runtime_error<config_type::exceptions>("engine: failed to reserve the prompt arena");
+		}
+	}
+
+	// Called in a worker forked from an idle, fully constructed engine (see engine_zygote) - replaces every arena that is
+	// written while serving and drops the subsystems, so nothing the worker writes is shared with its siblings
+	// Weights, tables and the tokenizer stay as they were, shared copy-on-write and never written
+	void prepare_worker() {
+		model.reserve_worker_arenas();
+		reserve_prompt_arena();
+		phase_metrics.reset();
+		prefixes.reset();
+		rank_collectives.reset();
+		trace_capture.reset();
+		if constexpr (config_type::warmup) {
+			warmup();
+		}
+	}
+
+	// Builds every active subsystem now instead of on first use - except trace capture, whose clock must not start before the first arrival
+	void initialize_subsystems() {
+		model.adapters.initialize();
+		phase_metrics.initialize();
+		prefixes.initialize();
+		rank_collectives.initialize();
+	}
+
+	// Takes every first-request cost up front: commits the pages of every arena written while serving (split across NUMA nodes
+	// under numa_prefault_type::enabled - weights are resident since initialization), builds the active subsystems, then runs
+	// one full prefill chunk and one decode step over every slot, sampling each row
+	// Only valid while idle - the synthetic steps overwrite KV, which is why the prefix cache is cleared afterwards
+	void warmup() {
+		if (!idle()) {
+			raise_runtime_error<config_type::exceptions>("engine::warmup: requests are in flight");
+		}
+		if (sizing.kv_block_count == declared_sizing.kv_block_count) {
+			prefault_arenas({ &model.kv_arena, &model.activation_arena, &prompt_arena }, config_type::numa_prefault);
+		} else {
+			prefault_arenas({ &model.activation_arena, &prompt_arena }, config_type::numa_prefault);
+			const uint64_t sequence_count{ std::min(sizing.max_batch_size, model_type::kv_slot_count) };
+			const uint64_t slot_block_count{ std::min(sizing.kv_block_count / sequence_count, ceil_div(max_context_length, kv_block_token_count)) };
+			model.prefault_kv(sequence_count, std::min(slot_block_count * kv_block_token_count, max_context_length));
+		}
+		initialize_subsystems();
+		constexpr uint64_t prompt_length{ model_type::prefill_chunk_length };
+		std::string prompt(prompt_length, ' ');
+		for (uint64_t index = 0; index < prompt_length; ++index) {
+			prompt[index] = static_cast<char>(' ' + index % 95);
+		}
+		const uint64_t token_count{ tokenizer.encode(prompt, prompt_buffer, max_prompt_length) };
+		if constexpr (scoring) {
+			model.score(prompt_buffer, token_count);
+			return;
+		}
+		random_generator generator{ shape_type::weight_seed };
+		const sampling_params sampling{ 1.0f, static_cast<uint32_t>(max_sample_top_k) };
+		sample_candidates(*model.prefill_top_k(0, prompt_buffer, token_count, 0, sampling), sampling, generator);
+		uint32_t decode_slots[max_batch_size];
+		uint32_t decode_tokens[max_batch_size];
+		uint32_t decode_positions[max_batch_size];
+		sampling_params decode_sampling[max_batch_size];
+		for (uint64_t slot_index = 0; slot_index < sizing.max_batch_size; ++slot_index) {
+			decode_slots[slot_index]	 = static_cast<uint32_t>(slot_index);
+			decode_tokens[slot_index]	 = prompt_buffer[slot_index % token_count];
+			decode_positions[slot_index] = static_cast<uint32_t>(std::min(token_count, max_context_length - 1));
+			decode_sampling[slot_index]	 = sampling;
+		}
+		logit_candidates* candidates{ model.decode_top_k(decode_slots, decode_tokens, decode_positions, decode_sampling, sizing.max_batch_size) };
+		for (uint64_t row = 0; row < sizing.max_batch_size; ++row) {
+			sample_candidates(candidates[row], sampling, generator);
+		}
+		if constexpr (decltype(prefixes)::enabled) {
+			prefixes.get().clear();
+		}
+	}
+
+	// The checks submit() makes before queuing - they depend on nothing but the request, so callers on other threads can make them too
+	// A request carrying prompt_text gets the largest token count its text can encode to as prompt_length
+	static request_status check_request(request_params& request) noexcept {
+		if (!request.prompt_tokens) {
+			request.prompt_length = tokenizer_type::max_token_count(request.prompt_text.size());
+		}
+		if (request.overrides.has_duplicates()) {
+			return request_status::duplicate_override;
+		}
+		if (request.prompt_length == 0) {
+			return request_status::empty_prompt;
+		}
+		if (request.prompt_length > resolve_request_limits<config_type>(request.overrides).max_prompt_length) {
+			return request_status::prompt_too_long;
+		}
+		if (!model_type::adapters_enabled && request.adapter_id != adapter_cache_type::base_adapter_id) {
+			return request_status::adapters_disabled;
+		}
+		return request_status::accepted;
+	}
+
+	// Generation length submit() gives a request that passed check_request: clamped to its max_generation_length and whatever of
+	// its context - or of the KV budget of an engine built with sizing_new - remains after the prompt, and zero when scoring
+	static uint64_t resolve_generation_length(const request_params& request, const runtime_sizing& sizing_new) noexcept {
+		if constexpr (scoring) {
+			return 0;
+		} else {
+			const request_limits limits{ resolve_request_limits<config_type>(request.overrides) };
+			const uint64_t token_budget{ std::min(limits.max_context_length, sizing_new.kv_block_count * kv_block_token_count) };
+			return std::clamp<uint64_t>(request.generation_length, 1, std::min(limits.max_generation_length, token_budget - request.prompt_length));
+		}
+	}
+
+	request_status submit(request_params request) {
+		if (const request_status status{ check_request(request) }; status != request_status::accepted) {
+			return status;
+		}
+		if constexpr (decltype(trace_capture)::enabled) {
+			trace_capture.get().record_arrival(request.id, request.prompt_length, request.generation_length);
+		}
+		request.generation_length = resolve_generation_length(request, sizing);
+		queued_request& queued{ pending.emplace_back(queued_request{ request, {} }) };
+		if constexpr (config_type::benchmark) {
+			queued.timeline.start(monotonic_nanoseconds());
+		}
+		return request_status::accepted;
+	}
+
+	// Drops a request wherever it is - still queued or already holding a slot - and returns false if it was not found
+	// A cancelled request produces no further token events
+	bool cancel(uint64_t request_id) {
+		if (!drop_request(request_id)) {
+			return false;
+		}
+		if constexpr (decltype(trace_capture)::enabled) {
+			trace_capture.get().record_cancellation(request_id);
+		}
+		return true;
+	}
+
+	bool drop_request(uint64_t request_id) {
+		for (auto iterator = pending.begin(); iterator != pending.end(); ++iterator) {
+			if (iterator->params.id == request_id) {
+				pending.erase(iterator);
+				return true;
+			}
+		}
+		for (sequence_slot& slot: slots) {
+			if (slot.active && slot.request_id == request_id) {
+				release_slot(slot);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	OACC_INLINE bool idle() const noexcept {
+		return active_count == 0 && pending.empty();
+	}
+
+	// Called once the events of the last step have been delivered to their clients - closes the stream phase of every request
+	// that finished in that step; step() calls it itself if the caller did not
+	OACC_INLINE void complete_streaming() noexcept {
+		if constexpr (config_type::benchmark) {
+			const uint64_t now_ns{ monotonic_nanoseconds() };
+			for (uint64_t index = 0; index < finished_count; ++index) {
+				finished_timelines[index].mark(request_phase::stream, now_ns);
+				phase_metrics.get().record(finished_timelines[index]);
+			}
+		}
+		finished_count = 0;
+	}
+
+	// Runs one scheduling iteration and returns the tokens it produced, valid until the next call
+	std::span<const token_event> step() {
+		complete_streaming();
+		event_count = 0;
+		uint32_t decode_slots[max_batch_size];
+		uint32_t decode_tokens[max_batch_size];
+		uint32_t decode_positions[max_batch_size];
+		uint32_t decode_adapters[max_batch_size];
+		sampling_params decode_sampling[max_batch_size];
+		uint64_t decode_count{};
+		for (uint64_t slot_index = 0; slot_index < max_batch_size; ++slot_index) {
+			if (slots[slot_index].active) {
+				decode_slots[decode_count]	   = static_cast<uint32_t>(slot_index);
+				decode_tokens[decode_count]	   = slots[slot_index].last_token;
+				decode_positions[decode_count] = slots[slot_index].position;
+				decode_adapters[decode_count]  = slots[slot_index].adapter_slot;
+				decode_sampling[decode_count]  = slots[slot_index].sampling;
+				++decode_count;
+			}
+		}
+		admit_pending();
+		if (decode_count > 0) {
+			logit_candidates* candidates{ model.decode_top_k(decode_slots, decode_tokens, decode_positions, decode_sampling, decode_count, decode_adapters) };
+			for (uint64_t row = 0; row < decode_count; ++row) {
+				sequence_slot& slot{ slots[decode_slots[row]] };
+				++slot.position;
+				emit_token(slot, candidates[row]);
+			}
+		}
+		return { events.data(), event_count };
+	}
+
+	// KV blocks a request reserves from admission to release - its whole prompt and generation, so an admitted request never runs out
+	static OACC_INLINE uint64_t required_block_count(const request_params& request) noexcept {
+		return ceil_div(request.prompt_length + request.generation_length, kv_block_token_count);
+	}
+
+	// Admits in queue order while the head request's KV blocks fit - a request that does not fit waits for running ones to finish
+	// The admitted prompts are then prefilled in one packed batch, with no padding between them
+	void admit_pending() {
+		admitted.count = 0;
+		// A free slot stays under consideration until it is taken, since admit() may place a request in a different free slot
+		for (uint64_t slot_index = 0; slot_index < sizing.max_batch_size && !pending.empty();) {
+			if (slots[slot_index].active) {
+				++slot_index;
+				continue;
+			}
+			if (reserved_block_count + required_block_count(pending.front().params) > sizing.kv_block_count) {
+				break;
+			}
+			// A scored prompt streams all its events from this step - one that does not fit waits for the next
+			if (scoring && event_count + pending.front().params.prompt_length > max_event_count) {
+				break;
+			}
+			if (!admit(slot_index)) {
+				break;
+			}
+		}
+		if (!scoring && admitted.count > 0) {
+			prefill_admitted();
+		}
+	}
+
+	// Takes the front of the queue into a free slot - free_slot unless the prefix cache finds a free slot that already holds part of
+	// the prompt - and adds it to the step's packed batch; a scored request is prefilled and finished right away instead
+	// Text prompts are tokenized into the prompt buffer of their place in the batch, so they stay put until the batch is prefilled
+	// Returns false if the request went back to the front of the queue instead
+	bool admit(uint64_t free_slot) {
+		const queued_request queued{ pending.front() };
+		const request_params& request{ queued.params };
+		pending.pop_front();
+		uint64_t slot_index{ free_slot };
+		timeline_type timeline{ queued.timeline };
+		if constexpr (config_type::benchmark) {
+			timeline.mark(request_phase::queue, monotonic_nanoseconds());
+		}
+		const request_limits limits{ resolve_request_limits<config_type>(request.overrides) };
+		const uint32_t* prompt_tokens{ request.prompt_tokens };
+		uint64_t prompt_length{ request.prompt_length };
+		if (!prompt_tokens) {
+			uint32_t* slot_prompt{ prompt_buffer + admitted.count * max_prompt_length };
+			prompt_length = tokenizer.encode(request.prompt_text, slot_prompt, limits.max_prompt_length);
+			prompt_tokens = slot_prompt;
+		}
+		if constexpr (config_type::benchmark) {
+			timeline.mark(request_phase::tokenize, monotonic_nanoseconds());
+		}
+		// The last prompt token is always prefilled, it produces the first generated token
+		// Scored sequences keep no KV past their admission, so there is never a prefix to reuse
+		uint64_t reused_length{};
+		if constexpr (decltype(prefixes)::enabled && !scoring) {
+			const auto match{ prefixes.get().lookup(prompt_tokens, prompt_length - 1, request.adapter_id) };
+			reused_length = match.token_count;
+			// A prefix held by a request of this batch has no KV until the batch is prefilled - the request waits a step to reuse it,
+			// and its lookup is counted when it is repeated then
+			if (reused_length > 0 && admitted_in_batch(match.slot)) {
+				prefixes.get().lookup_token_count -= prompt_length - 1;
+				pending.push_front(queued);
+				return false;
+			}
+			if (reused_length > 0 && !slots[match.slot].active) {
+				slot_index = match.slot;
+			} else if (reused_length > 0) {
+				model.copy_kv_prefix(slot_index, match.slot, reused_length);
+			}
+			prefixes.get().reused_token_count += reused_length;
+			// Registered now rather than after the prefill, so no later request of the batch matches what the slot held before
+			prefixes.get().insert(slot_index, prompt_tokens, prompt_length, request.adapter_id);
+		}
+		sequence_slot& slot{ slots[slot_index] };
+		slot.timeline		   = timeline;
+		slot.request_id		   = request.id;
+		slot.generated_count   = 0;
+		slot.generation_length = request.generation_length;
+		slot.position		   = static_cast<uint32_t>(prompt_length);
+		slot.sampling		   = request.sampling;
+		slot.generator		   = random_generator{ request.seed };
+		slot.adapter_slot	   = model_type::no_adapter_slot;
+		slot.kv_block_count	   = required_block_count(request);
+		slot.limits			   = limits;
+		slot.active			   = true;
+		++active_count;
+		reserved_block_count += slot.kv_block_count;
+		if constexpr (model_type::adapters_enabled) {
+			if (request.adapter_id != adapter_cache_type::base_adapter_id) {
+				slot.adapter_slot = model.adapters.get().acquire(request.adapter_id);
+			}
+		}
+		if constexpr (scoring) {
+			const float* logprobs{ model.score(prompt_tokens, prompt_length, slot.adapter_slot) };
+			if constexpr (config_type::benchmark) {
+				slot.timeline.mark(request_phase::prefill, monotonic_nanoseconds());
+			}
+			emit_logprobs(slot, prompt_tokens, logprobs, prompt_length);
+			return true;
+		}
+		const uint64_t sequence{ admitted.count++ };
+		admitted.tokens[sequence]		   = prompt_tokens + reused_length;
+		admitted.offsets[sequence + 1]	   = static_cast<uint32_t>(admitted.offsets[sequence] + prompt_length - reused_length);
+		admitted.slots[sequence]		   = static_cast<uint32_t>(slot_index);
+		admitted.start_positions[sequence] = static_cast<uint32_t>(reused_length);
+		admitted.adapter_slots[sequence]   = slot.adapter_slot;
+		admitted.sampling[sequence]		   = slot.sampling;
+		return true;
+	}
+
+	OACC_INLINE bool admitted_in_batch(uint64_t slot_index) const noexcept {
+		for (uint64_t sequence = 0; sequence < admitted.count; ++sequence) {
+			if (admitted.slots[sequence] == slot_index) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Prefills the step's admissions as one packed batch and emits their first tokens
+	void prefill_admitted() {
+		logit_candidates* candidates{ model.prefill_packed_top_k(admitted.tokens.data(), admitted.offsets.data(), admitted.slots.data(), admitted.start_positions.data(),
+			admitted.sampling.data(), admitted.count, admitted.adapter_slots.data()) };
+		const uint64_t now_ns{ config_type::benchmark ? monotonic_nanoseconds() : 0 };
+		for (uint64_t sequence = 0; sequence < admitted.count; ++sequence) {
+			sequence_slot& slot{ slots[admitted.slots[sequence]] };
+			if constexpr (config_type::benchmark) {
+				slot.timeline.mark(request_phase::prefill, now_ns);
+			}
+			emit_token(slot, candidates[sequence]);
+		}
+	}
+
+	// Samples from the candidates the fused output head selected for the slot - the full logits row is never materialized
+	OACC_INLINE void emit_token(sequence_slot& slot, logit_candidates& candidates) noexcept {
+		slot.last_token = sample_candidates(candidates, slot.sampling, slot.generator);
+		++slot.generated_count;
+		const bool finished{ slot.generated_count >= slot.generation_length || slot.position >= slot.limits.max_context_length };
+		events[event_count++] = token_event{ slot.request_id, slot.last_token, slot.generated_count == 1, finished };
+		if (finished) {
+			if constexpr (config_type::benchmark) {
+				slot.timeline.mark(request_phase::decode, monotonic_nanoseconds());
+			}
+			finished_timelines[finished_count++] = slot.timeline;
+			release_slot(slot);
+		}
+	}
+
+	// Scoring mode - one event per prompt token, then the request is finished and its slot released
+	// The token pointer may be the slot's prompt buffer, so every event is written before the slot is given up
+	OACC_INLINE void emit_logprobs(sequence_slot& slot, const uint32_t* tokens, const float* logprobs, uint64_t token_count) noexcept {
+		events[event_count++] = token_event{ slot.request_id, tokens[0], true, token_count == 1, 0.0f };
+		for (uint64_t index = 1; index < token_count; ++index) {
+			events[event_count++] = token_event{ slot.request_id, tokens[index], false, index + 1 == token_count, logprobs[index - 1] };
+		}
+		if constexpr (config_type::benchmark) {
+			slot.timeline.mark(request_phase::decode, monotonic_nanoseconds());
+		}
+		finished_timelines[finished_count++] = slot.timeline;
+		release_slot(slot);
+	}
+
+	// Frees the slot with its KV blocks and unpins its adapter
+	OACC_INLINE void release_slot(sequence_slot& slot) noexcept {
+		if constexpr (model_type::adapters_enabled) {
+			if (slot.adapter_slot != model_type::no_adapter_slot) {
+				model.adapters.get().release(slot.adapter_slot);
+			}
+		}
+		slot.active = false;
+		--active_count;
+		reserved_block_count -= slot.kv_block_count;
+	}
+};
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "engine.hpp"
+#include "work_stealing_pool.hpp"
+#include <array>
+#include <tuple>
+#include <vector>
+
+// Receives the tokens one engine of an engine_host produced in one step - called on a pool worker, never concurrently for the same engine
+using host_event_sink = void (*)(void* context, uint64_t engine_index, std::span<const token_event> events);
+
+// Several engines, each with its own model_config_type and shape, served from one process
+// memory_budget_bytes is split between the engines at compile time in proportion to what each commits at its declared limits,
+// and every engine is built with the runtime_sizing of its share, so the engines' arenas partition the budget. A budget that
+// covers every engine at its declared limits leaves them all there
+// All engines step on one work_stealing_pool with no more workers than CPUs or engines. An engine with work has exactly one step
+// task queued or running, so only one worker touches it at a time; a worker that runs out of engines steals another worker's
+template<uint64_t memory_budget_bytes, typename... engine_types> struct engine_host {
+	static constexpr uint64_t engine_count{ sizeof...(engine_types) };
+	static constexpr uint64_t declared_bytes{ (engine_types::declared_sizing.committed_bytes() + ...) };
+
+	template<uint64_t index> using engine_type = std::tuple_element_t<index, std::tuple<engine_types...>>;
+
+	template<typename engine_type_new> static constexpr runtime_sizing partition_sizing() {
+		using plan_type = typename engine_type_new::model_type::plan_type;
+		if (memory_budget_bytes >= declared_bytes) {
+			return engine_type_new::declared_sizing;
+		}
+		const double share{ static_cast<double>(engine_type_new::declared_sizing.committed_bytes()) / static_cast<double>(declared_bytes) };
+		return compute_runtime_sizing(plan_type::shape, plan_type::limits, static_cast<uint64_t>(static_cast<double>(memory_budget_bytes) * share));
+	}
+
+	static constexpr std::array<runtime_sizing, engine_count> sizings{ partition_sizing<engine_types>()... };
+	static_assert((partition_sizing<engine_types>().fits && ...), "engine_host: the memory budget does not cover one slot of every engine");
+
+	// Requests submitted since the engine's last step - moved into the engine by its next step, on the worker running it
+	struct engine_lane {
+		std::mutex mutex{};
+		std::vector<request_params> inbox{};
+		std::vector<request_params> arrivals{};
+		bool scheduled{};
+	};
+
+	std::tuple<std::unique_ptr<engine_types>...> engines{};
+	std::array<engine_lane, engine_count> lanes{};
+	host_event_sink sink{};
+	void* sink_context{};
+	std::atomic<uint64_t> in_flight_count{};
+	std::mutex idle_mutex{};
+	std::condition_variable idle{};
+	// Declared last so it is destroyed first - every queued step has run before the engines go away
+	work_stealing_pool pool;
+
+	explicit engine_host(host_event_sink sink_new, void* sink_context_new = nullptr, uint64_t worker_count = default_worker_count())
+		: engines{ construct_engines(std::make_index_sequence<engine_count>{}) }, sink{ sink_new }, sink_context{ sink_context_new }, pool{ worker_count } {
+	}
+
+	// One worker per CPU this process may use, and no more than there are engines to step
+	static uint64_t default_worker_count() {
+		return std::min(read_host_resources().cpu_count(), engine_count);
+	}
+
+	template<uint64_t... indices> static std::tuple<std::unique_ptr<engine_types>...> construct_engines(std::index_sequence<indices...>) {
+		return { std::make_unique<engine_type<indices>>(sizings[indices])... };
+	}
+
+	template<uint64_t index> engine_type<index>& get() noexcept {
+		return *std::get<index>(engines);
+	}
+
+	// Safe from any thread - the request is checked here and queued for engine index, which is scheduled if it was idle
+	// Prompts are borrowed exactly as engine::submit() borrows them
+	template<uint64_t index> request_status submit(request_params request) {
+		if (const request_status status{ engine_type<index>::check_request(request) }; status != request_status::accepted) {
+			return status;
+		}
+		in_flight_count.fetch_add(1, std::memory_order_relaxed);
+		engine_lane& lane{ lanes[index] };
+		bool schedule{};
+		{
+			std::lock_guard lock{ lane.mutex };
+			lane.inbox.emplace_back(request);
+			schedule = !std::exchange(lane.scheduled, true);
+		}
+		if (schedule) {
+			pool.push(pool_task{ &run_step<index>, this, 0 });
+		}
+		return request_status::accepted;
+	}
+
+	// Blocks until every accepted request has finished
+	void wait_idle() {
+		std::unique_lock lock{ idle_mutex };
+		idle.wait(lock, [&] {
+			return in_flight_count.load(std::memory_order_acquire) == 0;
+		});
+	}
+
+	// One step of engine index, then requeued behind the worker's other engines while it still has work
+	template<uint64_t index> static void run_step(void* context, uint64_t) {
+		engine_host& host{ *static_cast<engine_host*>(context) };
+		engine_type<index>& instance{ host.template get<index>() };
+		engine_lane& lane{ host.lanes[index] };
+		{
+			std::lock_guard lock{ lane.mutex };
+			std::swap(lane.inbox, lane.arrivals);
+		}
+		for (const request_params& request: lane.arrivals) {
+			instance.submit(request);
+		}
+		lane.arrivals.clear();
+		const std::span<const token_event> events{ instance.step() };
+		uint64_t finished_count{};
+		for (const token_event& event: events) {
+			finished_count += event.finished;
+		}
+		host.sink(host.sink_context, index, events);
+		instance.complete_streaming();
+		bool reschedule{};
+		{
+			std::lock_guard lock{ lane.mutex };
+			reschedule	   = !instance.idle() || !lane.inbox.empty();
+			lane.scheduled = reschedule;
+		}
+		if (reschedule) {
+			host.pool.push(pool_task{ &run_step<index>, &host, 0 });
+		}
+		if (finished_count > 0 && host.in_flight_count.fetch_sub(finished_count, std::memory_order_acq_rel) == finished_count) {
+			std::lock_guard lock{ host.idle_mutex };
+			host.idle.notify_all();
+		}
+	}
+};
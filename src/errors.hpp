@@ -0,0 +1,34 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdio>
+
+// Runtime error sink routed by model_config_type::exceptions
+// Compile-time mistakes are static_asserts; this only covers conditions that depend on runtime input
+// exceptions == true throws std::runtime_error, exceptions == false reports to stderr and aborts
+template<bool exceptions> [[noreturn]] inline void raise_runtime_error(const char* message) {
+	if constexpr (exceptions) {
+		throw std::runtime_error{ message };
+	} else {
+		std::fprintf(stderr, "OACC runtime error: %s\n", message);
+		std::abort();
+	}
+}
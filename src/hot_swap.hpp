@@ -0,0 +1,269 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "engine.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+
+// Serves whichever of engine_types was loaded last, replacing it without a restart
+// load<index>() builds an engine in the background - arenas, weights and tables, then warmup() so nothing is left cold - while
+// the serving thread keeps stepping the current one. The next step() after it is ready swaps it in: requests submitted from
+// then on go to the new engine, while requests the old engine already accepted finish on it. Once it is idle, the old engine
+// is handed back to the background thread to be destroyed, so neither building nor unmapping an engine runs on the serving thread
+// Both engines are resident while the old one drains - size the new one (see runtime_sizing) to fit next to it
+// A build that throws (exceptions == true in its config, e.g. a sizing that does not fit) stages nothing and only bumps
+// failed_load_count - the current engine keeps serving. With exceptions == false a failed build aborts the process, as
+// raise_runtime_error does everywhere else
+// submit() and step() belong to one serving thread; load() may be called from any thread
+template<typename... engine_types> struct hot_swap_engine {
+	static constexpr uint64_t engine_type_count{ sizeof...(engine_types) };
+	static constexpr uint64_t no_load{ ~uint64_t{} };
+
+	template<uint64_t index> using engine_type = std::tuple_element_t<index, std::tuple<engine_types...>>;
+
+	// Empty, or one engine of any of engine_types
+	using engine_pointer = std::variant<std::monostate, std::unique_ptr<engine_types>...>;
+
+	// Work for the background thread - build engine_types[load_index] with sizing, or destroy release
+	struct background_job {
+		uint64_t load_index{ no_load };
+		runtime_sizing sizing{};
+		engine_pointer release{};
+	};
+
+	engine_pointer active{};
+	std::vector<engine_pointer> draining{};
+	std::vector<token_event> events{};
+	uint64_t swap_count{};
+
+	std::mutex mutex{};
+	std::condition_variable wake{};
+	std::deque<background_job> jobs{};
+	engine_pointer staged{};
+	std::atomic<bool> staged_ready{};
+	std::atomic<uint64_t> released_count{};
+	std::atomic<uint64_t> failed_load_count{};
+	bool stopping{};
+	// Declared last so it starts once every other member exists
+	std::thread background{ [this] {
+		run_background();
+	} };
+
+	hot_swap_engine() noexcept = default;
+
+	hot_swap_engine(const hot_swap_engine&)			   = delete;
+	hot_swap_engine& operator=(const hot_swap_engine&) = delete;
+
+	// Finishes every queued build and release, then destroys whatever is still loaded on the calling thread
+	~hot_swap_engine() noexcept {
+		{
+			std::lock_guard lock{ mutex };
+			stopping = true;
+		}
+		wake.notify_all();
+		background.join();
+	}
+
+	// Queues a background build of engine_types[index] - a build that finishes while an earlier one is still staged replaces it
+	template<uint64_t index> void load(const runtime_sizing& sizing = engine_type<index>::declared_sizing) {
+		{
+			std::lock_guard lock{ mutex };
+			jobs.emplace_back(background_job{ index, sizing, {} });
+		}
+		wake.notify_one();
+	}
+
+	OACC_INLINE bool loaded() const noexcept {
+		return active.index() != 0;
+	}
+
+	// Engines still finishing requests accepted before a swap
+	OACC_INLINE uint64_t draining_count() const noexcept {
+		return draining.size();
+	}
+
+	OACC_INLINE bool idle() const noexcept {
+		const auto active_idle = [](const auto& instance) {
+			return engine_idle(instance);
+		};
+		return draining.empty() && std::visit(active_idle, active);
+	}
+
+	static bool engine_idle(const std::monostate&) noexcept {
+		return true;
+	}
+
+	template<typename engine_type_new> static bool engine_idle(const std::unique_ptr<engine_type_new>& instance) noexcept {
+		return instance->idle();
+	}
+
+	// Submits to the current engine - model_unavailable until the first load has been swapped in
+	request_status submit(const request_params& request) {
+		return std::visit(
+			[&](auto& instance) {
+				return submit_to(instance, request);
+			},
+			active);
+	}
+
+	static request_status submit_to(std::monostate&, const request_params&) noexcept {
+		return request_status::model_unavailable;
+	}
+
+	template<typename engine_type_new> static request_status submit_to(std::unique_ptr<engine_type_new>& instance, const request_params& request) {
+		return instance->submit(request);
+	}
+
+	// Swaps in a staged engine if one is ready, then steps the current engine and every draining one
+	// Returns the tokens of all of them, valid until the next call
+	std::span<const token_event> step() {
+		if (staged_ready.load(std::memory_order_acquire)) {
+			swap_in();
+		}
+		events.clear();
+		step_engine(active);
+		for (uint64_t index = 0; index < draining.size();) {
+			if (step_engine(draining[index])) {
+				++index;
+				continue;
+			}
+			release(std::move(draining[index]));
+			draining.erase(draining.begin() + static_cast<std::ptrdiff_t>(index));
+		}
+		return { events.data(), events.size() };
+	}
+
+	void swap_in() {
+		engine_pointer incoming{};
+		{
+			std::lock_guard lock{ mutex };
+			incoming = std::move(staged);
+			staged	 = engine_pointer{};
+			staged_ready.store(false, std::memory_order_relaxed);
+		}
+		if (loaded()) {
+			draining.emplace_back(std::move(active));
+		}
+		active = std::move(incoming);
+		++swap_count;
+	}
+
+	// Appends one step of instance to events and returns whether it still has work
+	bool step_engine(engine_pointer& instance) {
+		return std::visit(
+			[&](auto& pointer) {
+				return step_instance(pointer);
+			},
+			instance);
+	}
+
+	static bool step_instance(std::monostate&) noexcept {
+		return false;
+	}
+
+	template<typename engine_type_new> bool step_instance(std::unique_ptr<engine_type_new>& instance) {
+		if (instance->idle()) {
+			return false;
+		}
+		const std::span<const token_event> step_events{ instance->step() };
+		events.insert(events.end(), step_events.begin(), step_events.end());
+		return !instance->idle();
+	}
+
+	void release(engine_pointer&& instance) {
+		{
+			std::lock_guard lock{ mutex };
+			jobs.emplace_back(background_job{ no_load, {}, std::move(instance) });
+		}
+		wake.notify_one();
+	}
+
+	// Empty when the build failed
+	template<uint64_t... indices> static engine_pointer build(uint64_t index, const runtime_sizing& sizing, std::index_sequence<indices...>) {
+		engine_pointer return_value{};
+		((index == indices ? static_cast<void>(emplace_built<indices>(return_value, sizing)) : static_cast<void>(0)), ...);
+		return return_value;
+	}
+
+	template<uint64_t index> static void emplace_built(engine_pointer& target, const runtime_sizing& sizing) {
+		if (auto instance{ build_engine<index>(sizing) }) {
+			target.template emplace<index + 1>(std::move(instance));
+		}
+	}
+
+	// nullptr when construction or warmup threw - nothing escapes the background thread
+	template<uint64_t index> static std::unique_ptr<engine_type<index>> build_engine(const runtime_sizing& sizing) {
+		if constexpr (engine_type<index>::config_type::exceptions) {
+			try {
+				return construct_engine<index>(sizing);
+			} catch (...) {
+				return nullptr;
+			}
+		} else {
+			return construct_engine<index>(sizing);
+		}
+	}
+
+	template<uint64_t index> static std::unique_ptr<engine_type<index>> construct_engine(const runtime_sizing& sizing) {
+		auto return_value{ std::make_unique<engine_type<index>>(sizing) };
+		if constexpr (!engine_type<index>::config_type::warmup) {
+			return_value->warmup();
+		}
+		return return_value;
+	}
+
+	void run_background() {
+		while (true) {
+			background_job job{};
+			{
+				std::unique_lock lock{ mutex };
+				wake.wait(lock, [&] {
+					return stopping || !jobs.empty();
+				});
+				if (jobs.empty()) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			if (job.load_index == no_load) {
+				job.release = engine_pointer{};
+				released_count.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			engine_pointer built{ build(job.load_index, job.sizing, std::make_index_sequence<engine_type_count>{}) };
+			if (built.index() == 0) {
+				failed_load_count.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			// A staged engine that was never swapped in is destroyed here, outside the lock
+			engine_pointer replaced{};
+			{
+				std::lock_guard lock{ mutex };
+				replaced = std::move(staged);
+				staged	 = std::move(built);
+				staged_ready.store(true, std::memory_order_release);
+			}
+		}
+	}
+};
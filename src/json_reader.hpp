@@ -0,0 +1,206 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Small DOM reader for the documents json_writer produces - reports and baselines, never the serving path
+// Object members keep their document order; lookups are linear, which is fine at report sizes
+struct json_value {
+	enum class kind : uint8_t {
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object,
+	};
+
+	kind type{ kind::null };
+	bool boolean{};
+	double number{};
+	std::string string{};
+	std::vector<json_value> elements{};
+	std::vector<std::pair<std::string, json_value>> members{};
+
+	// nullptr when this is not an object or has no such member
+	const json_value* find(std::string_view name) const noexcept {
+		for (const auto& [member_name, member_value]: members) {
+			if (member_name == name) {
+				return &member_value;
+			}
+		}
+		return nullptr;
+	}
+
+	// null reads as NaN, matching json_writer writing non-finite numbers as null
+	double as_number() const noexcept {
+		return type == kind::number ? number : std::numeric_limits<double>::quiet_NaN();
+	}
+};
+
+struct json_parser {
+	std::string_view text{};
+	uint64_t offset{};
+
+	void skip_whitespace() noexcept {
+		while (offset < text.size() && (text[offset] == ' ' || text[offset] == '\t' || text[offset] == '\n' || text[offset] == '\r')) {
+			++offset;
+		}
+	}
+
+	bool consume(char expected) noexcept {
+		skip_whitespace();
+		if (offset < text.size() && text[offset] == expected) {
+			++offset;
+			return true;
+		}
+		return false;
+	}
+
+	bool consume_literal(std::string_view literal) noexcept {
+		if (text.substr(offset, literal.size()) == literal) {
+			offset += literal.size();
+			return true;
+		}
+		return false;
+	}
+
+	bool parse_string(std::string& out) {
+		if (!consume('"')) {
+			return false;
+		}
+		while (offset < text.size()) {
+			const char character{ text[offset++] };
+			if (character == '"') {
+				return true;
+			}
+			if (character != '\\') {
+				out += character;
+				continue;
+			}
+			if (offset >= text.size()) {
+				return false;
+			}
+			const char escaped{ text[offset++] };
+			switch (escaped) {
+				case 'n':
+					out += '\n';
+					break;
+				case 't':
+					out += '\t';
+					break;
+				case 'r':
+					out += '\r';
+					break;
+				case 'b':
+					out += '\b';
+					break;
+				case 'f':
+					out += '\f';
+					break;
+				case 'u': {
+					// Only the control character escapes json_writer emits are decoded; anything wider is kept as '?'
+					uint32_t code_point{};
+					if (offset + 4 > text.size() || std::from_chars(text.data() + offset, text.data() + offset + 4, code_point, 16).ec != std::errc{}) {
+						return false;
+					}
+					offset += 4;
+					out += code_point < 0x80 ? static_cast<char>(code_point) : '?';
+					break;
+				}
+				default:
+					out += escaped;
+			}
+		}
+		return false;
+	}
+
+	bool parse_value(json_value& out, uint64_t depth) {
+		static constexpr uint64_t max_depth{ 64 };
+		skip_whitespace();
+		if (offset >= text.size() || depth > max_depth) {
+			return false;
+		}
+		const char first{ text[offset] };
+		if (first == '{') {
+			++offset;
+			out.type = json_value::kind::object;
+			if (consume('}')) {
+				return true;
+			}
+			do {
+				auto& [name, value] = out.members.emplace_back();
+				if (!parse_string(name) || !consume(':') || !parse_value(value, depth + 1)) {
+					return false;
+				}
+			} while (consume(','));
+			return consume('}');
+		}
+		if (first == '[') {
+			++offset;
+			out.type = json_value::kind::array;
+			if (consume(']')) {
+				return true;
+			}
+			do {
+				if (!parse_value(out.elements.emplace_back(), depth + 1)) {
+					return false;
+				}
+			} while (consume(','));
+			return consume(']');
+		}
+		if (first == '"') {
+			out.type = json_value::kind::string;
+			return parse_string(out.string);
+		}
+		if (consume_literal("true") || consume_literal("false")) {
+			out.type	= json_value::kind::boolean;
+			out.boolean = first == 't';
+			return true;
+		}
+		if (consume_literal("null")) {
+			out.type = json_value::kind::null;
+			return true;
+		}
+		const auto [end, error] = std::from_chars(text.data() + offset, text.data() + text.size(), out.number);
+		if (error != std::errc{}) {
+			return false;
+		}
+		out.type = json_value::kind::number;
+		offset	 = static_cast<uint64_t>(end - text.data());
+		return true;
+	}
+};
+
+// Returns false on malformed input or trailing content; error_offset then points at the failure
+inline bool parse_json(std::string_view text, json_value& out, uint64_t* error_offset = nullptr) {
+	json_parser parser{ text, 0 };
+	const bool parsed{ parser.parse_value(out, 0) };
+	parser.skip_whitespace();
+	if (error_offset) {
+		*error_offset = parser.offset;
+	}
+	return parsed && parser.offset == text.size();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <cstdio>
+#include <cmath>
+
+// Minimal streaming JSON writer for reports - appends to one std::string, no DOM
+// Commas are inserted automatically; keys and values must alternate inside objects
+struct json_writer {
+	std::string buffer{};
+	bool needs_comma{};
+
+	void begin_object() {
+		separate();
+		buffer += '{';
+		needs_comma = false;
+	}
+
+	void end_object() {
+		buffer += '}';
+		needs_comma = true;
+	}
+
+	void begin_array() {
+		separate();
+		buffer += '[';
+		needs_comma = false;
+	}
+
+	void end_array() {
+		buffer += ']';
+		needs_comma = true;
+	}
+
+	void key(std::string_view name) {
+		separate();
+		write_string(name);
+		buffer += ':';
+		needs_comma = false;
+	}
+
+	void value(std::string_view text) {
+		separate();
+		write_string(text);
+		needs_comma = true;
+	}
+
+	void value(const char* text) {
+		value(std::string_view{ text });
+	}
+
+	void value(bool flag) {
+		separate();
+		buffer += flag ? "true" : "false";
+		needs_comma = true;
+	}
+
+	void value(uint64_t number) {
+		separate();
+		buffer += std::to_string(number);
+		needs_comma = true;
+	}
+
+	// Non-finite values have no JSON representation and are written as null
+	void value(double number) {
+		separate();
+		if (std::isfinite(number)) {
+			char text[32];
+			std::snprintf(text, sizeof(text), "%.9g", number);
+			buffer += text;
+		} else {
+			buffer += "null";
+		}
+		needs_comma = true;
+	}
+
+	template<typename value_type> void member(std::string_view name, value_type member_value) {
+		key(name);
+		value(member_value);
+	}
+
+	void separate() {
+		if (needs_comma) {
+			buffer += ',';
+		}
+	}
+
+	void write_string(std::string_view text) {
+		buffer += '"';
+		for (const char character: text) {
+			switch (character) {
+				case '"':
+					buffer += "\\\"";
+					break;
+				case '\\':
+					buffer += "\\\\";
+					break;
+				case '\n':
+					buffer += "\\n";
+					break;
+				case '\t':
+					buffer += "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(character) < 0x20) {
+						char escaped[8];
+						std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(character));
+						buffer += escaped;
+					} else {
+						buffer += character;
+					}
+			}
+		}
+		buffer += '"';
+	}
+};
@@ -0,0 +1,753 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+
+// CPU reference kernels for the stand-in model
+// Dimensions that come from model_shape_type are template parameters so every inner loop has a constant trip count
+// Token counts and sequence lengths are runtime values - they change every step
+
+// Independent accumulators break the floating point dependency chain so the compiler can vectorize without -ffast-math
+inline constexpr uint64_t accumulator_lane_count{ 8 };
+
+template<uint64_t count> OACC_INLINE float dot_product(const float* lhs, const float* rhs) noexcept {
+	float accumulators[accumulator_lane_count]{};
+	uint64_t index{};
+	for (; index + accumulator_lane_count <= count; index += accumulator_lane_count) {
+		for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+			accumulators[lane] += lhs[index + lane] * rhs[index + lane];
+		}
+	}
+	float return_value{};
+	for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+		return_value += accumulators[lane];
+	}
+	for (; index < count; ++index) {
+		return_value += lhs[index] * rhs[index];
+	}
+	return return_value;
+}
+
+// Runtime-length variant for attention, where the length is the current sequence position
+OACC_INLINE float dot_product(const float* lhs, const float* rhs, uint64_t count) noexcept {
+	float accumulators[accumulator_lane_count]{};
+	uint64_t index{};
+	for (; index + accumulator_lane_count <= count; index += accumulator_lane_count) {
+		for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+			accumulators[lane] += lhs[index + lane] * rhs[index + lane];
+		}
+	}
+	float return_value{};
+	for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+		return_value += accumulators[lane];
+	}
+	for (; index < count; ++index) {
+		return_value += lhs[index] * rhs[index];
+	}
+	return return_value;
+}
+
+// Row format of plain f32 matrices and the default of gemv - the formats in weight_format.hpp provide the same members
+// row_stride is in storage_type elements and linear in cols; prepare_input converts one token's cols floats to input_type once per call, dot
+// multiplies one stored row with a prepared input, dequantize expands one row to f32 and quantize stores one f32 row
+struct f32_rows {
+	using storage_type = float;
+
+	template<uint64_t cols> using input_type = const float*;
+
+	// Columns one storage_type element holds - a row can only be split at multiples of it
+	static constexpr uint64_t columns_per_element{ 1 };
+
+	template<uint64_t cols> static constexpr uint64_t row_stride{ cols };
+
+	template<uint64_t cols> OACC_INLINE static void prepare_input(const float*& out, const float* in) noexcept {
+		out = in;
+	}
+
+	template<uint64_t cols> OACC_INLINE static float dot(const float* row, const float* in) noexcept {
+		return dot_product<cols>(row, in);
+	}
+
+	template<uint64_t cols> OACC_INLINE static void dequantize(float* out, const float* row) noexcept {
+		std::copy_n(row, cols, out);
+	}
+
+	template<uint64_t cols> static void quantize(float* out, const float* in) noexcept {
+		std::copy_n(in, cols, out);
+	}
+};
+
+// Token count from which gemv expands each row to f32 once and reuses it, instead of dequantizing it again per token
+inline constexpr uint64_t gemv_dequantize_row_token_count{ 4 };
+
+// out[token][row] = matrix[row] . in[token] for every token
+// Rows are the outer loop so each weight row is streamed from memory once per call and reused from L1 across tokens
+// Quantized rows are dequantized inside the dot product, or once into an L1-resident f32 row when enough tokens share it
+template<uint64_t rows, uint64_t cols, typename format_type = f32_rows>
+OACC_INLINE void gemv(float* out, const typename format_type::storage_type* matrix, const float* in, uint64_t token_count) noexcept {
+	constexpr uint64_t row_stride{ format_type::template row_stride<cols> };
+	if constexpr (std::is_same_v<format_type, f32_rows>) {
+		for (uint64_t row = 0; row < rows; ++row) {
+			for (uint64_t token = 0; token < token_count; ++token) {
+				out[token * rows + row] = dot_product<cols>(matrix + row * row_stride, in + token * cols);
+			}
+		}
+	} else if (token_count >= gemv_dequantize_row_token_count) {
+		alignas(64) float row_values[cols];
+		for (uint64_t row = 0; row < rows; ++row) {
+			format_type::template dequantize<cols>(row_values, matrix + row * row_stride);
+			for (uint64_t token = 0; token < token_count; ++token) {
+				out[token * rows + row] = dot_product<cols>(row_values, in + token * cols);
+			}
+		}
+	} else {
+		typename format_type::template input_type<cols> inputs[gemv_dequantize_row_token_count - 1];
+		for (uint64_t token = 0; token < token_count; ++token) {
+			format_type::template prepare_input<cols>(inputs[token], in + token * cols);
+		}
+		for (uint64_t row = 0; row < rows; ++row) {
+			const typename format_type::storage_type* matrix_row{ matrix + row * row_stride };
+			for (uint64_t token = 0; token < token_count; ++token) {
+				out[token * rows + row] = format_type::template dot<cols>(matrix_row, inputs[token]);
+			}
+		}
+	}
+}
+
+// Register tile of the prefill GEMM - gemm_tile_token_count x gemm_tile_row_count outputs are accumulated across one depth
+// block without leaving registers: 12 four-wide accumulators, two for the row panel and one broadcast fit the 16 SSE/NEON registers
+inline constexpr uint64_t gemm_tile_token_count{ 6 };
+inline constexpr uint64_t gemm_tile_row_count{ 8 };
+
+// Per-core cache capacities the GEMM blocking is planned for - the smallest of current x86-64 and arm64 server cores, so the
+// blocks fit on all of them instead of exactly on one
+inline constexpr uint64_t gemm_l1_bytes{ 32ull * 1024 };
+inline constexpr uint64_t gemm_l2_bytes{ 1024ull * 1024 };
+inline constexpr uint64_t gemm_l3_bytes{ 4ull * 1024 * 1024 };
+
+// Token count from which matmul packs operands and runs gemm instead of streaming rows through gemv
+inline constexpr uint64_t gemm_min_token_count{ 48 };
+
+// Block sizes of one gemm, all in elements of the packed f32 operands
+// depth: columns per pass - one token panel and one row panel of it take half of L1
+// token_count: tokens packed per pass - the token block takes half of L2, and is never larger than the tokens a call can have
+// row_count: weight rows packed per pass - the row block takes half of L3, and is never larger than the matrix
+struct gemm_blocking {
+	uint64_t depth{};
+	uint64_t token_count{};
+	uint64_t row_count{};
+
+	constexpr uint64_t pack_float_count() const noexcept {
+		return (token_count + row_count) * depth;
+	}
+};
+
+// depth splits cols into equal blocks at multiples of granularity, the columns per element of the row format, so every block
+// of a quantized row dequantizes on its own
+constexpr gemm_blocking compute_gemm_blocking(uint64_t rows, uint64_t cols, uint64_t token_capacity, uint64_t granularity) noexcept {
+	const auto round_up = [](uint64_t value, uint64_t multiple) {
+		return (value + multiple - 1) / multiple * multiple;
+	};
+	const uint64_t max_depth{ std::max(granularity, gemm_l1_bytes / 2 / ((gemm_tile_token_count + gemm_tile_row_count) * sizeof(float)) / granularity * granularity) };
+	const uint64_t depth_block_count{ (cols + max_depth - 1) / max_depth };
+	gemm_blocking return_value{};
+	return_value.depth		 = round_up((cols + depth_block_count - 1) / depth_block_count, granularity);
+	return_value.token_count = round_up(std::clamp<uint64_t>(gemm_l2_bytes / 2 / (return_value.depth * sizeof(float)), 1, token_capacity), gemm_tile_token_count);
+	return_value.row_count	 = round_up(std::clamp<uint64_t>(gemm_l3_bytes / 2 / (return_value.depth * sizeof(float)), 1, rows), gemm_tile_row_count);
+	return return_value;
+}
+
+// Copies tokens [token_begin, token_begin + token_count) x columns [depth_begin, depth_begin + depth) of in into token panels:
+// [panel][column][gemm_tile_token_count], the tokens past token_count zeroed so edge tiles need no special case
+OACC_INLINE void gemm_pack_tokens(float* __restrict out, const float* __restrict in, uint64_t cols, uint64_t token_begin, uint64_t token_count, uint64_t depth_begin,
+	uint64_t depth) noexcept {
+	for (uint64_t panel = 0; panel < token_count; panel += gemm_tile_token_count) {
+		for (uint64_t lane = 0; lane < gemm_tile_token_count; ++lane) {
+			const bool valid{ panel + lane < token_count };
+			const float* in_row{ in + (token_begin + panel + lane) * cols + depth_begin };
+			for (uint64_t column = 0; column < depth; ++column) {
+				out[column * gemm_tile_token_count + lane] = valid ? in_row[column] : 0.0f;
+			}
+		}
+		out += depth * gemm_tile_token_count;
+	}
+}
+
+// Dequantizes rows [row_begin, row_begin + row_count) x the depth block at depth_begin of matrix into row panels:
+// [panel][column][gemm_tile_row_count], the rows past row_count zeroed. The last block of a row can be shorter than depth
+template<uint64_t cols, uint64_t depth, typename format_type>
+OACC_INLINE void gemm_pack_rows(float* __restrict out, const typename format_type::storage_type* matrix, uint64_t row_begin, uint64_t row_count, uint64_t depth_begin) noexcept {
+	constexpr uint64_t row_stride{ format_type::template row_stride<cols> };
+	constexpr uint64_t tail_depth{ cols - (cols - 1) / depth * depth };
+	const bool tail{ depth_begin + depth > cols };
+	const uint64_t block_depth{ tail ? tail_depth : depth };
+	const uint64_t element_offset{ depth_begin / depth * format_type::template row_stride<depth> };
+	alignas(64) float row_values[depth]{};
+	for (uint64_t panel = 0; panel < row_count; panel += gemm_tile_row_count) {
+		for (uint64_t lane = 0; lane < gemm_tile_row_count; ++lane) {
+			const typename format_type::storage_type* row{ matrix + (row_begin + panel + lane) * row_stride + element_offset };
+			if (panel + lane >= row_count) {
+				std::fill_n(row_values, block_depth, 0.0f);
+			} else if (tail) {
+				format_type::template dequantize<tail_depth>(row_values, row);
+			} else {
+				format_type::template dequantize<depth>(row_values, row);
+			}
+			for (uint64_t column = 0; column < block_depth; ++column) {
+				out[column * gemm_tile_row_count + lane] = row_values[column];
+			}
+		}
+		out += block_depth * gemm_tile_row_count;
+	}
+}
+
+// One register tile over depth packed columns - the row panel is copied to locals first so the compiler keeps it in registers
+// and vectorizes the row lanes; only the valid corner of the tile is stored, added onto out after the first depth block
+OACC_INLINE void gemm_tile(float* out, uint64_t out_stride, const float* __restrict tokens, const float* __restrict rows, uint64_t depth, uint64_t token_count,
+	uint64_t row_count, bool accumulate) noexcept {
+	float accumulators[gemm_tile_token_count * gemm_tile_row_count]{};
+	for (uint64_t column = 0; column < depth; ++column) {
+		float row_values[gemm_tile_row_count];
+		for (uint64_t lane = 0; lane < gemm_tile_row_count; ++lane) {
+			row_values[lane] = rows[column * gemm_tile_row_count + lane];
+		}
+		for (uint64_t token = 0; token < gemm_tile_token_count; ++token) {
+			const float token_value{ tokens[column * gemm_tile_token_count + token] };
+			for (uint64_t lane = 0; lane < gemm_tile_row_count; ++lane) {
+				accumulators[token * gemm_tile_row_count + lane] += token_value * row_values[lane];
+			}
+		}
+	}
+	for (uint64_t token = 0; token < token_count; ++token) {
+		float* out_row{ out + token * out_stride };
+		for (uint64_t lane = 0; lane < row_count; ++lane) {
+			out_row[lane] = accumulate ? out_row[lane] + accumulators[token * gemm_tile_row_count + lane] : accumulators[token * gemm_tile_row_count + lane];
+		}
+	}
+}
+
+// Same result as gemv, for token counts where the step is compute-bound
+// Operands are packed into panels sized by compute_gemm_blocking so each register tile streams both of them contiguously:
+// a row block is dequantized once per depth block, and every token block packed against it is reused from L2 by all its row panels
+// pack holds blocking.pack_float_count() floats - the token block first, then the row block
+template<uint64_t rows, uint64_t cols, uint64_t token_capacity, typename format_type = f32_rows>
+void gemm(float* out, const typename format_type::storage_type* matrix, const float* in, uint64_t token_count, float* pack) noexcept {
+	static constexpr gemm_blocking blocking{ compute_gemm_blocking(rows, cols, token_capacity, format_type::columns_per_element) };
+	float* packed_tokens{ pack };
+	float* packed_rows{ pack + blocking.token_count * blocking.depth };
+	for (uint64_t row_begin = 0; row_begin < rows; row_begin += blocking.row_count) {
+		const uint64_t row_block{ std::min(blocking.row_count, rows - row_begin) };
+		for (uint64_t depth_begin = 0; depth_begin < cols; depth_begin += blocking.depth) {
+			const uint64_t depth{ std::min(blocking.depth, cols - depth_begin) };
+			gemm_pack_rows<cols, blocking.depth, format_type>(packed_rows, matrix, row_begin, row_block, depth_begin);
+			for (uint64_t token_begin = 0; token_begin < token_count; token_begin += blocking.token_count) {
+				const uint64_t token_block{ std::min(blocking.token_count, token_count - token_begin) };
+				gemm_pack_tokens(packed_tokens, in, cols, token_begin, token_block, depth_begin, depth);
+				for (uint64_t row_panel = 0; row_panel < row_block; row_panel += gemm_tile_row_count) {
+					for (uint64_t token_panel = 0; token_panel < token_block; token_panel += gemm_tile_token_count) {
+						gemm_tile(out + (token_begin + token_panel) * rows + row_begin + row_panel, rows, packed_tokens + token_panel * depth,
+							packed_rows + row_panel * depth, depth, std::min(gemm_tile_token_count, token_block - token_panel),
+							std::min(gemm_tile_row_count, row_block - row_panel), depth_begin > 0);
+					}
+				}
+			}
+		}
+	}
+}
+
+// out[token][row] = matrix[row] . in[token] - gemm from gemm_min_token_count tokens on, gemv below
+// token_capacity is the most tokens any call can pass and sizes pack, see gemm
+template<uint64_t rows, uint64_t cols, uint64_t token_capacity, typename format_type = f32_rows>
+OACC_INLINE void matmul(float* out, const typename format_type::storage_type* matrix, const float* in, uint64_t token_count, float* pack) noexcept {
+	if (token_count >= gemm_min_token_count) {
+		gemm<rows, cols, token_capacity, format_type>(out, matrix, in, token_count, pack);
+	} else {
+		gemv<rows, cols, format_type>(out, matrix, in, token_count);
+	}
+}
+
+template<uint64_t dim> OACC_INLINE void rms_norm(float* out, const float* in, const float* weight, uint64_t token_count) noexcept {
+	constexpr float epsilon{ 1.0e-5f };
+	for (uint64_t token = 0; token < token_count; ++token) {
+		const float* in_row{ in + token * dim };
+		float* out_row{ out + token * dim };
+		const float scale{ 1.0f / std::sqrt(dot_product<dim>(in_row, in_row) / static_cast<float>(dim) + epsilon) };
+		for (uint64_t index = 0; index < dim; ++index) {
+			out_row[index] = in_row[index] * scale * weight[index];
+		}
+	}
+}
+
+OACC_INLINE void add_in_place(float* out, const float* in, uint64_t count) noexcept {
+	for (uint64_t index = 0; index < count; ++index) {
+		out[index] += in[index];
+	}
+}
+
+// gate = silu(gate) * up
+OACC_INLINE void silu_mul(float* gate, const float* up, uint64_t count) noexcept {
+	for (uint64_t index = 0; index < count; ++index) {
+		const float value{ gate[index] };
+		gate[index]		 = value / (1.0f + std::exp(-value)) * up[index];
+	}
+}
+
+OACC_INLINE void softmax(float* values, uint64_t count) noexcept {
+	float max_value{ -std::numeric_limits<float>::infinity() };
+	for (uint64_t index = 0; index < count; ++index) {
+		max_value = std::max(max_value, values[index]);
+	}
+	float sum{};
+	for (uint64_t index = 0; index < count; ++index) {
+		values[index] = std::exp(values[index] - max_value);
+		sum += values[index];
+	}
+	const float inverse_sum{ 1.0f / sum };
+	for (uint64_t index = 0; index < count; ++index) {
+		values[index] *= inverse_sum;
+	}
+}
+
+// Rotary embedding table for one position - head_dim / 2 cosines followed by head_dim / 2 sines
+template<uint64_t head_dim> OACC_INLINE void generate_rope_row(float* table_row, uint64_t position) noexcept {
+	constexpr uint64_t half_dim{ head_dim / 2 };
+	for (uint64_t index = 0; index < half_dim; ++index) {
+		const double frequency{ std::pow(10000.0, -2.0 * static_cast<double>(index) / static_cast<double>(head_dim)) };
+		const double angle{ static_cast<double>(position) * frequency };
+		table_row[index]			= static_cast<float>(std::cos(angle));
+		table_row[half_dim + index] = static_cast<float>(std::sin(angle));
+	}
+}
+
+// Rotates consecutive pairs of every head in place
+template<uint64_t head_dim> OACC_INLINE void apply_rope(float* vector, const float* table_row, uint64_t head_count) noexcept {
+	constexpr uint64_t half_dim{ head_dim / 2 };
+	for (uint64_t head = 0; head < head_count; ++head) {
+		float* head_vector{ vector + head * head_dim };
+		for (uint64_t index = 0; index < half_dim; ++index) {
+			const float cosine{ table_row[index] };
+			const float sine{ table_row[half_dim + index] };
+			const float even{ head_vector[2 * index] };
+			const float odd{ head_vector[2 * index + 1] };
+			head_vector[2 * index]	   = even * cosine - odd * sine;
+			head_vector[2 * index + 1] = even * sine + odd * cosine;
+		}
+	}
+}
+
+// Causal attention for one query head over length cached positions
+// keys and values point at position 0 of this head's slice, kv_stride floats apart per position
+template<uint64_t head_dim> OACC_INLINE void attention_head(float* out, const float* query, const float* keys, const float* values, uint64_t kv_stride, uint64_t length,
+	float* scores) noexcept {
+	const float scale{ 1.0f / std::sqrt(static_cast<float>(head_dim)) };
+	for (uint64_t position = 0; position < length; ++position) {
+		scores[position] = dot_product<head_dim>(query, keys + position * kv_stride) * scale;
+	}
+	softmax(scores, length);
+	for (uint64_t index = 0; index < head_dim; ++index) {
+		out[index] = 0.0f;
+	}
+	for (uint64_t position = 0; position < length; ++position) {
+		const float weight{ scores[position] };
+		const float* value_row{ values + position * kv_stride };
+		for (uint64_t index = 0; index < head_dim; ++index) {
+			out[index] += weight * value_row[index];
+		}
+	}
+}
+
+// Causal attention of one sequence's consecutive rows for the group_size query heads sharing one KV head - row r of the segment
+// is at position first_position + r and attends to the first_position + r + 1 cached positions up to it
+// Rows never look past their own sequence's slot, so sequences packed into one pass need no mask; the query heads of a group run
+// back to back over the same keys and values while they are in cache
+// queries and out point at the group's first head in row 0, row_stride floats apart per row; keys and values as in attention_head
+template<uint64_t head_dim, uint64_t group_size> OACC_INLINE void attention_segment(float* out, const float* queries, uint64_t row_stride, const float* keys,
+	const float* values, uint64_t kv_stride, uint64_t first_position, uint64_t row_count, float* scores) noexcept {
+	for (uint64_t row = 0; row < row_count; ++row) {
+		for (uint64_t head = 0; head < group_size; ++head) {
+			attention_head<head_dim>(out + row * row_stride + head * head_dim, queries + row * row_stride + head * head_dim, keys, values, kv_stride,
+				first_position + row + 1, scores);
+		}
+	}
+}
+
+// Embedding lookup - out[token] = table[tokens[token]]
+// Scalar reference for gather_rows_dedup
+template<uint64_t dim> OACC_INLINE void gather_rows(float* out, const float* table, const uint32_t* tokens, uint64_t token_count) noexcept {
+	for (uint64_t token = 0; token < token_count; ++token) {
+		const float* row{ table + static_cast<uint64_t>(tokens[token]) * dim };
+		for (uint64_t index = 0; index < dim; ++index) {
+			out[token * dim + index] = row[index];
+		}
+	}
+}
+
+// Tokens between a row's prefetch and its copy - a few rows of cache lines in flight, more only queue behind the line fill buffers
+inline constexpr uint64_t gather_prefetch_distance{ 4 };
+
+// Floats per cache line - rows are prefetched and copied a line at a time
+inline constexpr uint64_t cache_line_float_count{ 64 / sizeof(float) };
+
+template<uint64_t dim> OACC_INLINE void prefetch_row(const float* row) noexcept {
+	for (uint64_t index = 0; index < dim; index += cache_line_float_count) {
+		OACC_PREFETCH(row + index);
+	}
+}
+
+// Whole cache lines through non-aliasing pointers, so the copy compiles to full-width vector loads and stores with no overlap check
+template<uint64_t dim> OACC_INLINE void copy_row(float* __restrict out, const float* __restrict in) noexcept {
+	uint64_t index{};
+	for (; index + cache_line_float_count <= dim; index += cache_line_float_count) {
+		for (uint64_t lane = 0; lane < cache_line_float_count; ++lane) {
+			out[index + lane] = in[index + lane];
+		}
+	}
+	for (; index < dim; ++index) {
+		out[index] = in[index];
+	}
+}
+
+// Entries of the gather_rows_dedup table for token_count tokens - a power of two, never more than half full
+constexpr uint64_t gather_table_capacity(uint64_t token_count) noexcept {
+	return std::bit_ceil(std::max<uint64_t>(2 * token_count, 16));
+}
+
+// Embedding lookup with duplicate elimination - out[token] = table[tokens[token]]
+// Each token is resolved gather_prefetch_distance tokens before it is copied: a first occurrence has its table row prefetched,
+// a repeat is later copied from the output row of its first occurrence, already written and still in cache, so it costs no
+// table traffic and no prefetch. table_entries is scratch for gather_table_capacity(token_count) open-addressing entries of
+// (token + 1) << 32 | first row. Returns the number of distinct tokens
+template<uint64_t dim> OACC_INLINE uint64_t gather_rows_dedup(float* out, const float* table, const uint32_t* tokens, uint64_t token_count,
+	uint64_t* table_entries) noexcept {
+	const uint64_t capacity{ gather_table_capacity(token_count) };
+	const uint64_t shift{ 64 - static_cast<uint64_t>(std::countr_zero(capacity)) };
+	std::fill_n(table_entries, capacity, 0);
+	// Source rows of the tokens resolved but not yet copied
+	const float* sources[gather_prefetch_distance]{};
+	uint64_t unique_count{};
+	const auto resolve = [&](uint64_t token) {
+		const uint64_t key{ static_cast<uint64_t>(tokens[token]) + 1 };
+		uint64_t bucket{ (key * 0x9e3779b97f4a7c15ull) >> shift };
+		while (table_entries[bucket] != 0 && (table_entries[bucket] >> 32) != key) {
+			bucket = (bucket + 1) & (capacity - 1);
+		}
+		const float* source{};
+		if (table_entries[bucket] == 0) {
+			table_entries[bucket] = key << 32 | token;
+			source				  = table + (key - 1) * dim;
+			prefetch_row<dim>(source);
+			++unique_count;
+		} else {
+			source = out + (table_entries[bucket] & 0xffffffffull) * dim;
+		}
+		sources[token % gather_prefetch_distance] = source;
+	};
+	for (uint64_t token = 0; token < std::min(gather_prefetch_distance, token_count); ++token) {
+		resolve(token);
+	}
+	for (uint64_t token = 0; token < token_count; ++token) {
+		const float* source{ sources[token % gather_prefetch_distance] };
+		if (token + gather_prefetch_distance < token_count) {
+			resolve(token + gather_prefetch_distance);
+		}
+		copy_row<dim>(out + token * dim, source);
+	}
+	return unique_count;
+}
+
+OACC_INLINE uint32_t argmax(const float* values, uint64_t count) noexcept {
+	uint64_t best_index{};
+	float best_value{ values[0] };
+	for (uint64_t index = 1; index < count; ++index) {
+		if (values[index] > best_value) {
+			best_value = values[index];
+			best_index = index;
+		}
+	}
+	return static_cast<uint32_t>(best_index);
+}
+
+// Largest top_k the sampler keeps on the stack - candidates are tracked with an insertion sort
+inline constexpr uint64_t max_sample_top_k{ 64 };
+
+struct sampling_params {
+	float temperature{};
+	uint32_t top_k{ 1 };
+};
+
+// Candidates a row has to keep to sample with params - one for greedy decoding
+OACC_INLINE uint64_t sample_candidate_count(const sampling_params& params) noexcept {
+	return params.temperature <= 0.0f || params.top_k <= 1 ? 1 : std::min<uint64_t>(params.top_k, max_sample_top_k);
+}
+
+// One sampling candidate as exchanged between ranks - no_candidate_index pads rows that have fewer candidates than requested
+struct logit_candidate {
+	float value;
+	uint32_t index;
+};
+
+inline constexpr uint32_t no_candidate_index{ std::numeric_limits<uint32_t>::max() };
+
+// Running top-k of one row of logits, highest first - push() merges logits in index order and keeps the earlier index on ties,
+// so pushing a row tile by tile selects exactly what pushing it whole would
+struct logit_candidates {
+	float values[max_sample_top_k];
+	uint32_t indices[max_sample_top_k];
+	uint32_t count;
+	uint32_t capacity;
+
+	OACC_INLINE void reset(uint64_t capacity_new) noexcept {
+		count	 = 0;
+		capacity = static_cast<uint32_t>(capacity_new);
+	}
+
+	OACC_INLINE void insert(float value, uint32_t index) noexcept {
+		if (count == capacity && value <= values[capacity - 1]) {
+			return;
+		}
+		uint64_t position{ count < capacity ? count++ : capacity - 1 };
+		while (position > 0 && values[position - 1] < value) {
+			values[position]  = values[position - 1];
+			indices[position] = indices[position - 1];
+			--position;
+		}
+		values[position]  = value;
+		indices[position] = index;
+	}
+
+	OACC_INLINE void push(const float* logits, uint64_t logit_count, uint64_t first_index) noexcept {
+		for (uint64_t index = 0; index < logit_count; ++index) {
+			insert(logits[index], static_cast<uint32_t>(first_index + index));
+		}
+	}
+};
+
+// Greedy when temperature is zero or top_k is one, otherwise temperature-scaled sampling over the candidates
+// Consumes candidates - their values are overwritten by the sampling distribution
+OACC_INLINE uint32_t sample_candidates(logit_candidates& candidates, const sampling_params& params, random_generator& generator) noexcept {
+	if (sample_candidate_count(params) == 1) {
+		return candidates.indices[0];
+	}
+	const float inverse_temperature{ 1.0f / params.temperature };
+	for (uint64_t index = 0; index < candidates.count; ++index) {
+		candidates.values[index] *= inverse_temperature;
+	}
+	softmax(candidates.values, candidates.count);
+	float threshold{ generator.next_float() };
+	for (uint64_t index = 0; index < candidates.count; ++index) {
+		threshold -= candidates.values[index];
+		if (threshold <= 0.0f) {
+			return candidates.indices[index];
+		}
+	}
+	return candidates.indices[candidates.count - 1];
+}
+
+// Samples from a materialized row of logits - the same selection and draw as the fused output head
+OACC_INLINE uint32_t sample_top_k(const float* logits, uint64_t count, const sampling_params& params, random_generator& generator) noexcept {
+	if (params.temperature <= 0.0f || params.top_k <= 1) {
+		return argmax(logits, count);
+	}
+	logit_candidates candidates;
+	candidates.reset(std::min<uint64_t>(sample_candidate_count(params), count));
+	candidates.push(logits, count, 0);
+	return sample_candidates(candidates, params, generator);
+}
+
+// Output rows the fused head computes per tile - the tile's logits for a full decode batch stay in L1 while they are merged
+inline constexpr uint64_t output_tile_row_count{ 128 };
+
+// Output projection fused with candidate selection - each tile of output_tile_row_count rows is computed for every token into
+// tile_logits and merged into that token's candidates before the next tile overwrites it, so the rows x token_count logits are
+// never written. Row r is candidate first_index + r; candidates[token] must have been reset and tile_logits holds
+// output_tile_row_count x token_count floats
+template<uint64_t rows, uint64_t cols, typename format_type = f32_rows> OACC_INLINE void gemv_top_k(logit_candidates* candidates,
+	const typename format_type::storage_type* matrix, const float* in, uint64_t token_count, float* tile_logits, uint64_t first_index) noexcept {
+	constexpr uint64_t row_stride{ format_type::template row_stride<cols> };
+	constexpr uint64_t full_tile_count{ rows / output_tile_row_count };
+	constexpr uint64_t tail_row_count{ rows % output_tile_row_count };
+	const auto merge = [&](uint64_t first_row, uint64_t tile_row_count) {
+		for (uint64_t token = 0; token < token_count; ++token) {
+			candidates[token].push(tile_logits + token * tile_row_count, tile_row_count, first_index + first_row);
+		}
+	};
+	for (uint64_t tile = 0; tile < full_tile_count; ++tile) {
+		gemv<output_tile_row_count, cols, format_type>(tile_logits, matrix + tile * output_tile_row_count * row_stride, in, token_count);
+		merge(tile * output_tile_row_count, output_tile_row_count);
+	}
+	if constexpr (tail_row_count > 0) {
+		gemv<tail_row_count, cols, format_type>(tile_logits, matrix + full_tile_count * output_tile_row_count * row_stride, in, token_count);
+		merge(full_tile_count * output_tile_row_count, tail_row_count);
+	}
+}
+
+// Running log-softmax of one target over a row of logits - push() merges logits tile by tile with an online log-sum-exp, so the
+// row is never held whole. target_logit stays -infinity until the tile holding target has been pushed
+struct logprob_accumulator {
+	float max_value;
+	float sum;
+	float target_logit;
+
+	OACC_INLINE void reset() noexcept {
+		max_value	 = -std::numeric_limits<float>::infinity();
+		sum			 = 0.0f;
+		target_logit = -std::numeric_limits<float>::infinity();
+	}
+
+	OACC_INLINE void push(const float* logits, uint64_t logit_count, uint64_t first_index, uint64_t target) noexcept {
+		float tile_max{ -std::numeric_limits<float>::infinity() };
+		for (uint64_t index = 0; index < logit_count; ++index) {
+			tile_max = std::max(tile_max, logits[index]);
+		}
+		const float max_new{ std::max(max_value, tile_max) };
+		float tile_sum{};
+		for (uint64_t index = 0; index < logit_count; ++index) {
+			tile_sum += std::exp(logits[index] - max_new);
+		}
+		sum		  = sum * std::exp(max_value - max_new) + tile_sum;
+		max_value = max_new;
+		if (target - first_index < logit_count) {
+			target_logit = logits[target - first_index];
+		}
+	}
+
+	// Folds in the accumulator of another range of the same row, e.g. another rank's vocab shard
+	OACC_INLINE void merge(const logprob_accumulator& other) noexcept {
+		const float max_new{ std::max(max_value, other.max_value) };
+		sum			 = sum * std::exp(max_value - max_new) + other.sum * std::exp(other.max_value - max_new);
+		max_value	 = max_new;
+		target_logit = std::max(target_logit, other.target_logit);
+	}
+
+	OACC_INLINE float logprob() const noexcept {
+		return target_logit - max_value - std::log(sum);
+	}
+};
+
+// Output projection fused with the target log-softmax - the prefill counterpart of gemv_top_k. Each tile of output_tile_row_count
+// rows is computed for every token with matmul, so a full prefill chunk takes the gemm path, and merged into that token's
+// accumulator before the next tile overwrites it. Row r is token first_index + r; accumulators[token] must have been reset,
+// tile_logits holds output_tile_row_count x token_capacity floats and pack is matmul's scratch
+template<uint64_t rows, uint64_t cols, uint64_t token_capacity, typename format_type = f32_rows>
+OACC_INLINE void matmul_logprobs(logprob_accumulator* accumulators, const uint32_t* targets, const typename format_type::storage_type* matrix, const float* in,
+	uint64_t token_count, float* tile_logits, float* pack, uint64_t first_index) noexcept {
+	constexpr uint64_t row_stride{ format_type::template row_stride<cols> };
+	constexpr uint64_t full_tile_count{ rows / output_tile_row_count };
+	constexpr uint64_t tail_row_count{ rows % output_tile_row_count };
+	const auto merge = [&](uint64_t first_row, uint64_t tile_row_count) {
+		for (uint64_t token = 0; token < token_count; ++token) {
+			accumulators[token].push(tile_logits + token * tile_row_count, tile_row_count, first_index + first_row, targets[token]);
+		}
+	};
+	for (uint64_t tile = 0; tile < full_tile_count; ++tile) {
+		matmul<output_tile_row_count, cols, token_capacity, format_type>(tile_logits, matrix + tile * output_tile_row_count * row_stride, in, token_count, pack);
+		merge(tile * output_tile_row_count, output_tile_row_count);
+	}
+	if constexpr (tail_row_count > 0) {
+		matmul<tail_row_count, cols, token_capacity, format_type>(tile_logits, matrix + full_tile_count * output_tile_row_count * row_stride, in, token_count, pack);
+		merge(full_tile_count * output_tile_row_count, tail_row_count);
+	}
+}
+
+// Mixture-of-experts gate of one row: the top_k largest router logits, highest first, and their softmax as mixing weights
+// Each pick is a lane-parallel max over every expert followed by masking the winner, so both loops vectorize and the cost does
+// not depend on how the logits are ordered; ties go to the lower expert index
+template<uint64_t expert_count, uint64_t top_k> OACC_INLINE void gating_top_k(const float* logits, uint32_t* experts, float* weights) noexcept {
+	constexpr uint64_t padded_count{ (expert_count + accumulator_lane_count - 1) / accumulator_lane_count * accumulator_lane_count };
+	constexpr float masked{ -std::numeric_limits<float>::infinity() };
+	float values[padded_count];
+	for (uint64_t index = 0; index < padded_count; ++index) {
+		values[index] = index < expert_count ? logits[index] : masked;
+	}
+	for (uint64_t pick = 0; pick < top_k; ++pick) {
+		float lane_max[accumulator_lane_count];
+		std::fill_n(lane_max, accumulator_lane_count, masked);
+		for (uint64_t index = 0; index < padded_count; index += accumulator_lane_count) {
+			for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+				lane_max[lane] = std::max(lane_max[lane], values[index + lane]);
+			}
+		}
+		float best_value{ masked };
+		for (const float value: lane_max) {
+			best_value = std::max(best_value, value);
+		}
+		uint32_t best_index{};
+		for (uint64_t index = padded_count; index-- > 0;) {
+			best_index = values[index] == best_value ? static_cast<uint32_t>(index) : best_index;
+		}
+		experts[pick]	   = best_index;
+		weights[pick]	   = best_value;
+		values[best_index] = masked;
+	}
+	softmax(weights, top_k);
+}
+
+// Stable counting sort of route_count routes by expert - grouped[offsets[e] .. offsets[e + 1]) are the routes, in route order,
+// to local expert e, which is expert first_expert + e. Routes to experts outside the local range are dropped
+// offsets holds local_expert_count + 1 entries and grouped up to route_count
+template<uint64_t local_expert_count>
+OACC_INLINE void group_routes_by_expert(const uint32_t* route_experts, uint64_t route_count, uint64_t first_expert, uint32_t* offsets, uint32_t* grouped) noexcept {
+	std::fill_n(offsets, local_expert_count + 1, 0u);
+	for (uint64_t route = 0; route < route_count; ++route) {
+		const uint64_t local_expert{ route_experts[route] - first_expert };
+		if (local_expert < local_expert_count) {
+			++offsets[local_expert + 1];
+		}
+	}
+	uint32_t cursors[local_expert_count];
+	for (uint64_t local_expert = 0; local_expert < local_expert_count; ++local_expert) {
+		offsets[local_expert + 1] += offsets[local_expert];
+		cursors[local_expert] = offsets[local_expert];
+	}
+	for (uint64_t route = 0; route < route_count; ++route) {
+		const uint64_t local_expert{ route_experts[route] - first_expert };
+		if (local_expert < local_expert_count) {
+			grouped[cursors[local_expert]++] = static_cast<uint32_t>(route);
+		}
+	}
+}
+
+// Adds one low-rank adapter's delta up * (down * in) to the listed rows of out - down is rank x cols, up is stored transposed
+// as rank x rows so the second product is rank scaled row updates per token. Each down row is read once for all listed rows
+// scratch holds rank floats per listed row
+template<uint64_t rows, uint64_t cols, uint64_t rank> OACC_INLINE void lora_segment(float* out, const float* in, const float* down, const float* up,
+	const uint32_t* row_indices, uint64_t row_count, float* scratch) noexcept {
+	for (uint64_t component = 0; component < rank; ++component) {
+		const float* down_row{ down + component * cols };
+		for (uint64_t index = 0; index < row_count; ++index) {
+			scratch[index * rank + component] = dot_product<cols>(down_row, in + static_cast<uint64_t>(row_indices[index]) * cols);
+		}
+	}
+	for (uint64_t index = 0; index < row_count; ++index) {
+		float* __restrict out_row{ out + static_cast<uint64_t>(row_indices[index]) * rows };
+		for (uint64_t component = 0; component < rank; ++component) {
+			const float weight{ scratch[index * rank + component] };
+			const float* __restrict up_row{ up + component * rows };
+			for (uint64_t column = 0; column < rows; ++column) {
+				out_row[column] += weight * up_row[column];
+			}
+		}
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <array>
+#include <bit>
+
+// Log-linear histogram of microsecond values - each power of two range is split into 16 linear sub-buckets
+// Fixed 464 counters cover 0 us .. 2^32 us with at most ~6% relative error and no allocation on record()
+struct latency_histogram {
+	static constexpr uint64_t sub_bucket_bits{ 4 };
+	static constexpr uint64_t sub_bucket_count{ 1ull << sub_bucket_bits };
+	static constexpr uint64_t max_value_bits{ 32 };
+	static constexpr uint64_t bucket_count{ sub_bucket_count + (max_value_bits - sub_bucket_bits) * sub_bucket_count };
+
+	std::array<uint64_t, bucket_count> counts{};
+	uint64_t total_count{};
+	uint64_t max_recorded{};
+
+	static constexpr uint64_t bucket_index(uint64_t value) noexcept {
+		value = std::min<uint64_t>(value, (1ull << max_value_bits) - 1);
+		if (value < sub_bucket_count) {
+			return value;
+		}
+		const uint64_t most_significant_bit{ static_cast<uint64_t>(std::bit_width(value)) - 1 };
+		const uint64_t shift{ most_significant_bit - sub_bucket_bits };
+		return sub_bucket_count + shift * sub_bucket_count + ((value >> shift) & (sub_bucket_count - 1));
+	}
+
+	// Largest value that maps to index - percentiles report this so they never understate latency
+	static constexpr uint64_t bucket_upper_bound(uint64_t index) noexcept {
+		if (index < sub_bucket_count) {
+			return index;
+		}
+		const uint64_t shift{ (index - sub_bucket_count) / sub_bucket_count };
+		const uint64_t sub_bucket{ (index - sub_bucket_count) % sub_bucket_count };
+		return ((sub_bucket_count + sub_bucket + 1) << shift) - 1;
+	}
+
+	OACC_INLINE void record(uint64_t value) noexcept {
+		++counts[bucket_index(value)];
+		++total_count;
+		max_recorded = std::max(max_recorded, value);
+	}
+
+	uint64_t percentile(double fraction) const noexcept {
+		if (total_count == 0) {
+			return 0;
+		}
+		const uint64_t target{ std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(total_count) + 0.5)) };
+		uint64_t seen{};
+		for (uint64_t index = 0; index < bucket_count; ++index) {
+			seen += counts[index];
+			if (seen >= target) {
+				return std::min(bucket_upper_bound(index), max_recorded);
+			}
+		}
+		return max_recorded;
+	}
+
+	void merge(const latency_histogram& other) noexcept {
+		for (uint64_t index = 0; index < bucket_count; ++index) {
+			counts[index] += other.counts[index];
+		}
+		total_count += other.total_count;
+		max_recorded = std::max(max_recorded, other.max_recorded);
+	}
+
+	void reset() noexcept {
+		counts.fill(0);
+		total_count	 = 0;
+		max_recorded = 0;
+	}
+};
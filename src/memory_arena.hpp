@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#if defined(_WIN32)
+	// windows.h would otherwise define min and max as macros, breaking every std::min, std::max and numeric_limits<>::max() after it
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#if !defined(WIN32_LEAN_AND_MEAN)
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+constexpr uint64_t align_up(uint64_t value, uint64_t alignment) noexcept {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Cache line alignment for every arena allocation - keeps SIMD loads aligned and avoids false sharing between slots
+inline constexpr uint64_t arena_alignment{ 64 };
+
+// Smallest page size of the supported platforms - prefault touches at this stride, larger pages are simply touched repeatedly
+inline constexpr uint64_t prefault_page_bytes{ 4096 };
+
+// Whether an arena's pages stay shared with processes forked after it was reserved - fork_shared arenas are the channel between
+// a launcher and its zygote workers, every other arena is private and copy-on-write across fork()
+// Windows has no fork(), so there both are private
+enum class arena_sharing {
+	process_private,
+	fork_shared,
+};
+
+// Bump allocator over one virtual memory reservation
+// Capacity is fixed at construction (sized by memory_plan at compile time), physical pages are only taken on first touch
+// On Windows the whole reservation is committed at construction - charged against the system commit limit up front, since
+// touching a reserved but uncommitted page faults - though its physical pages still arrive on first touch there too
+// There is no per-allocation free - an arena is reset or destroyed as a whole
+struct memory_arena {
+	uint8_t* data{};
+	uint64_t capacity{};
+	uint64_t offset{};
+
+	memory_arena() noexcept = default;
+
+	explicit memory_arena(uint64_t capacity_new, arena_sharing sharing = arena_sharing::process_private) : capacity{ align_up(capacity_new, arena_alignment) } {
+		if (capacity == 0) {
+			return;
+		}
+#if defined(_WIN32)
+		static_cast<void>(sharing);
+		data = static_cast<uint8_t*>(VirtualAlloc(nullptr, capacity, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+		const int visibility{ sharing == arena_sharing::fork_shared ? MAP_SHARED : MAP_PRIVATE };
+		void* mapping{ mmap(nullptr, capacity, PROT_READ | PROT_WRITE, visibility | MAP_ANONYMOUS, -1, 0) };
+		data = mapping == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mapping);
+#endif
+		if (!data) {
+			capacity = 0;
+		}
+	}
+
+	memory_arena(memory_arena&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	memory_arena& operator=(memory_arena&& other) noexcept {
+		if (this != &other) {
+			release();
+			data	 = std::exchange(other.data, nullptr);
+			capacity = std::exchange(other.capacity, 0);
+			offset	 = std::exchange(other.offset, 0);
+		}
+		return *this;
+	}
+
+	memory_arena(const memory_arena&)			 = delete;
+	memory_arena& operator=(const memory_arena&) = delete;
+
+	~memory_arena() noexcept {
+		release();
+	}
+
+	// Returns nullptr when the arena is exhausted - callers size arenas from memory_plan so this indicates a planner bug
+	template<typename value_type> OACC_INLINE value_type* allocate(uint64_t count) noexcept {
+		const uint64_t bytes{ align_up(count * sizeof(value_type), arena_alignment) };
+		if (offset + bytes > capacity) {
+			return nullptr;
+		}
+		value_type* return_value{ reinterpret_cast<value_type*>(data + offset) };
+		offset += bytes;
+		return return_value;
+	}
+
+	OACC_INLINE void reset() noexcept {
+		offset = 0;
+	}
+
+	OACC_INLINE bool valid() const noexcept {
+		return data != nullptr;
+	}
+
+	OACC_INLINE uint8_t* begin() const noexcept {
+		return data;
+	}
+
+	OACC_INLINE uint64_t size() const noexcept {
+		return offset;
+	}
+
+	OACC_INLINE uint64_t reserved() const noexcept {
+		return capacity;
+	}
+
+	// Makes the whole reservation read-only - a later write faults instead of silently un-sharing a page after fork()
+	bool protect_read_only() const noexcept {
+		if (!data) {
+			return false;
+		}
+#if defined(_WIN32)
+		DWORD previous{};
+		return VirtualProtect(data, capacity, PAGE_READONLY, &previous) != 0;
+#else
+		return mprotect(data, capacity, PROT_READ) == 0;
+#endif
+	}
+
+	// Commits the pages of [begin_offset, end_offset) now instead of on first touch - contents are left unchanged
+	void prefault(uint64_t begin_offset, uint64_t end_offset) const noexcept {
+		end_offset = std::min(end_offset, capacity);
+		if (!data || begin_offset >= end_offset) {
+			return;
+		}
+#if defined(MADV_POPULATE_WRITE)
+		// One call instead of a fault per page - page-align the start, madvise requires it
+		const uint64_t aligned_begin{ begin_offset / prefault_page_bytes * prefault_page_bytes };
+		if (madvise(data + aligned_begin, end_offset - aligned_begin, MADV_POPULATE_WRITE) == 0) {
+			return;
+		}
+#endif
+		// Kernels without MADV_POPULATE_WRITE - a write per page, of the value already there
+		volatile uint8_t* bytes{ data };
+		for (uint64_t offset = begin_offset; offset < end_offset; offset += prefault_page_bytes) {
+			bytes[offset] = bytes[offset];
+		}
+		bytes[end_offset - 1] = bytes[end_offset - 1];
+	}
+
+	void release() noexcept {
+		if (data) {
+#if defined(_WIN32)
+			VirtualFree(data, 0, MEM_RELEASE);
+#else
+			munmap(data, capacity);
+#endif
+		}
+		data	 = nullptr;
+		capacity = 0;
+		offset	 = 0;
+	}
+};
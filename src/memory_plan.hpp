@@ -0,0 +1,306 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "model_shape.hpp"
+#include "memory_arena.hpp"
+#include "kernels.hpp"
+#include <algorithm>
+#include <utility>
+
+// KV capacity is accounted in fixed-size token blocks so sizing can be expressed as a block count
+inline constexpr uint64_t kv_block_token_count{ 16 };
+
+// Upper bound on tokens pushed through one prefill forward pass - bounds the activation arena independently of max_prompt_length
+inline constexpr uint64_t max_prefill_chunk_length{ 256 };
+
+// Plain runtime mirror of model_shape_type - the layout math below is constexpr over these so the
+// compile-time planner and any runtime caller compute byte-identical layouts
+struct shape_dimensions {
+	uint64_t layer_count{};
+	uint64_t head_dim{};
+	uint64_t embedding_dim{};
+	uint64_t kv_dim{};
+	uint64_t ffn_dim{};
+	uint64_t vocab_size{};
+	weight_dtype_type weight_dtype{};
+};
+
+// Plain runtime mirror of the serving limits, expert routing, adapter cache and vocab sharding in model_config_type - one expert
+// is the dense feed forward, zero adapter slots serve the base model only, one vocab shard holds every output row, and scoring
+// serves prompt logprobs only (see model_config_type::scoring)
+struct serving_limits {
+	uint64_t max_batch_size{};
+	uint64_t max_context_length{};
+	uint64_t max_prompt_length{};
+	uint64_t expert_count{ 1 };
+	uint64_t expert_top_k{ 1 };
+	uint64_t local_expert_count{ 1 };
+	uint64_t adapter_capacity{};
+	uint64_t adapter_rank{};
+	uint64_t vocab_shard_count{ 1 };
+	bool scoring{};
+};
+
+struct memory_layout {
+	uint64_t weight_bytes{};
+	uint64_t kv_cache_bytes{};
+	uint64_t activation_bytes{};
+	uint64_t adapter_bytes{};
+	uint64_t kv_block_count{};
+	uint64_t kv_block_bytes{};
+	uint64_t activation_row_count{};
+
+	constexpr uint64_t total_bytes() const noexcept {
+		return weight_bytes + kv_cache_bytes + activation_bytes + adapter_bytes;
+	}
+};
+
+template<typename value_type> constexpr uint64_t arena_bytes(uint64_t count) noexcept {
+	return align_up(count * sizeof(value_type), arena_alignment);
+}
+
+constexpr uint64_t compute_prefill_chunk_length(const serving_limits& limits) noexcept {
+	return std::min(limits.max_prompt_length, max_prefill_chunk_length);
+}
+
+// Output rows of one vocab shard - every rank reserves this many, the last shard may use fewer
+constexpr uint64_t compute_local_vocab_size(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	return ceil_div(shape.vocab_size, limits.vocab_shard_count);
+}
+
+// A rows x cols projection or output matrix in the shape's weight_dtype
+constexpr uint64_t compute_matrix_bytes(const shape_dimensions& shape, uint64_t rows, uint64_t cols) noexcept {
+	return align_up(rows * weight_row_bytes(shape.weight_dtype, cols), arena_alignment);
+}
+
+// One transformer layer in allocation order - the norms and the router stay f32, the matrices are stored as weight_dtype
+// A dense layer has no router and one expert; a mixture-of-experts layer holds only the experts local to its rank
+constexpr uint64_t compute_layer_weight_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	uint64_t return_value{};
+	return_value += arena_bytes<float>(shape.embedding_dim);
+	return_value += compute_matrix_bytes(shape, shape.embedding_dim, shape.embedding_dim);
+	return_value += compute_matrix_bytes(shape, shape.kv_dim, shape.embedding_dim);
+	return_value += compute_matrix_bytes(shape, shape.kv_dim, shape.embedding_dim);
+	return_value += compute_matrix_bytes(shape, shape.embedding_dim, shape.embedding_dim);
+	return_value += arena_bytes<float>(shape.embedding_dim);
+	if (limits.expert_count > 1) {
+		return_value += arena_bytes<float>(limits.expert_count * shape.embedding_dim);
+	}
+	for (uint64_t expert = 0; expert < limits.local_expert_count; ++expert) {
+		return_value += compute_matrix_bytes(shape, shape.ffn_dim, shape.embedding_dim);
+		return_value += compute_matrix_bytes(shape, shape.ffn_dim, shape.embedding_dim);
+		return_value += compute_matrix_bytes(shape, shape.embedding_dim, shape.ffn_dim);
+	}
+	return return_value;
+}
+
+// Weights plus the read-only tables generated next to them (rope), in allocation order
+constexpr uint64_t compute_weight_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	uint64_t return_value{ shape.layer_count * compute_layer_weight_bytes(shape, limits) };
+	return_value += arena_bytes<float>(shape.vocab_size * shape.embedding_dim);
+	return_value += arena_bytes<float>(shape.embedding_dim);
+	return_value += compute_matrix_bytes(shape, compute_local_vocab_size(shape, limits), shape.embedding_dim);
+	return_value += arena_bytes<float>(limits.max_context_length * shape.head_dim);
+	return return_value;
+}
+
+// Sequences that hold KV at once - a scoring request is prefilled and released within one admission, so scoring keeps a single
+// sequence's KV however many requests a step scores
+constexpr uint64_t compute_kv_slot_count(const serving_limits& limits) noexcept {
+	return limits.scoring ? 1 : limits.max_batch_size;
+}
+
+// K and V for every KV slot, layer and position - one contiguous [slot][layer][position][kv_dim] tensor each
+constexpr uint64_t compute_kv_block_bytes(const shape_dimensions& shape) noexcept {
+	return 2 * shape.layer_count * kv_block_token_count * shape.kv_dim * sizeof(float);
+}
+
+constexpr uint64_t compute_kv_block_count(const serving_limits& limits) noexcept {
+	return compute_kv_slot_count(limits) * ceil_div(limits.max_context_length, kv_block_token_count);
+}
+
+constexpr uint64_t compute_kv_cache_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	return 2 * arena_bytes<float>(compute_kv_slot_count(limits) * shape.layer_count * limits.max_context_length * shape.kv_dim);
+}
+
+// KV blocks a sequence with the longest prompt holds once it has produced its first token - the least any slot must be able to hold
+// A scored sequence produces no token, so it needs its prompt only
+constexpr uint64_t compute_min_sequence_block_count(const serving_limits& limits) noexcept {
+	return ceil_div(std::min(limits.max_prompt_length + (limits.scoring ? 0 : 1), limits.max_context_length), kv_block_token_count);
+}
+
+constexpr uint64_t compute_activation_row_count(const serving_limits& limits) noexcept {
+	return std::max(compute_prefill_chunk_length(limits), limits.max_batch_size);
+}
+
+// Packing scratch of the largest gemm one forward pass runs - every matrix is planned with the blocking gemm derives for it
+constexpr uint64_t compute_gemm_pack_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	const uint64_t granularity{ weight_dtype_block_size(shape.weight_dtype) };
+	uint64_t return_value{};
+	for (const auto& [matrix_rows, matrix_cols]: { std::pair{ shape.embedding_dim, shape.embedding_dim }, std::pair{ shape.kv_dim, shape.embedding_dim },
+			 std::pair{ shape.ffn_dim, shape.embedding_dim }, std::pair{ shape.embedding_dim, shape.ffn_dim }, std::pair{ compute_local_vocab_size(shape, limits), shape.embedding_dim } }) {
+		return_value = std::max(return_value, arena_bytes<float>(compute_gemm_blocking(matrix_rows, matrix_cols, rows, granularity).pack_float_count()));
+	}
+	return return_value;
+}
+
+// Routing scratch of a mixture-of-experts layer, none for a dense one: router logits, the top_k (expert, weight) routes of every
+// row, per-expert offsets and the routes grouped by expert, then one expert's gathered input and output and the weighted sum
+constexpr uint64_t compute_expert_activation_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	if (limits.expert_count <= 1) {
+		return 0;
+	}
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	const uint64_t route_count{ rows * limits.expert_top_k };
+	uint64_t return_value{};
+	return_value += arena_bytes<float>(rows * limits.expert_count);
+	return_value += arena_bytes<uint32_t>(route_count);
+	return_value += arena_bytes<float>(route_count);
+	return_value += arena_bytes<uint32_t>(limits.expert_count + 1);
+	return_value += arena_bytes<uint32_t>(route_count);
+	return_value += 3 * arena_bytes<float>(rows * shape.embedding_dim);
+	return return_value;
+}
+
+// One resident low-rank adapter in allocation order - per layer the query and value deltas, each a down projection (rank x
+// embedding_dim) and an up projection stored transposed (rank x output rows), all f32
+constexpr uint64_t compute_adapter_slot_bytes(const shape_dimensions& shape, uint64_t rank) noexcept {
+	uint64_t return_value{};
+	return_value += arena_bytes<float>(rank * shape.embedding_dim);
+	return_value += arena_bytes<float>(rank * shape.embedding_dim);
+	return_value += arena_bytes<float>(rank * shape.embedding_dim);
+	return_value += arena_bytes<float>(rank * shape.kv_dim);
+	return shape.layer_count * return_value;
+}
+
+// The adapter cache's arena - adapter_capacity resident adapters, none without adapters
+constexpr uint64_t compute_adapter_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	return limits.adapter_capacity * compute_adapter_slot_bytes(shape, limits.adapter_rank);
+}
+
+// Segmentation scratch of adapter serving, none without adapters: the adapter slot of every row, per-slot offsets and the rows
+// grouped by slot, then the rank intermediate of every row
+constexpr uint64_t compute_adapter_activation_bytes(const serving_limits& limits) noexcept {
+	if (limits.adapter_capacity == 0) {
+		return 0;
+	}
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	uint64_t return_value{};
+	return_value += arena_bytes<uint32_t>(rows);
+	return_value += arena_bytes<uint32_t>(limits.adapter_capacity + 1);
+	return_value += arena_bytes<uint32_t>(rows);
+	return_value += arena_bytes<float>(rows * limits.adapter_rank);
+	return return_value;
+}
+
+// Vocab-parallel exchange scratch, none for an unsharded output layer: this rank's logits and every rank's gathered logits for
+// callers that need full rows, then this rank's packed candidates and every rank's gathered candidates for sampling
+constexpr uint64_t compute_vocab_shard_activation_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	if (limits.vocab_shard_count <= 1) {
+		return 0;
+	}
+	const uint64_t local_logit_count{ limits.max_batch_size * compute_local_vocab_size(shape, limits) };
+	const uint64_t candidate_count{ limits.max_batch_size * max_sample_top_k };
+	uint64_t return_value{};
+	return_value += arena_bytes<float>(local_logit_count);
+	return_value += arena_bytes<float>(limits.vocab_shard_count * local_logit_count);
+	return_value += arena_bytes<logit_candidate>(candidate_count);
+	return_value += arena_bytes<logit_candidate>(limits.vocab_shard_count * candidate_count);
+	return return_value;
+}
+
+// Packed prefill scratch: the tokens of one pass and its sequence offsets, then the last hidden row of every sequence of a batch
+constexpr uint64_t compute_packing_activation_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	uint64_t return_value{};
+	return_value += arena_bytes<uint32_t>(rows);
+	return_value += arena_bytes<uint32_t>(rows + 1);
+	return_value += arena_bytes<float>(limits.max_batch_size * shape.embedding_dim);
+	return return_value;
+}
+
+// Scoring scratch, none when generating: one output tile of logits and one logprob accumulator per row, every rank's gathered
+// accumulators under vocab sharding, then the logprobs of a whole prompt
+constexpr uint64_t compute_scoring_activation_bytes(const serving_limits& limits) noexcept {
+	if (!limits.scoring) {
+		return 0;
+	}
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	uint64_t return_value{};
+	return_value += arena_bytes<float>(output_tile_row_count * rows);
+	return_value += arena_bytes<logprob_accumulator>(rows);
+	if (limits.vocab_shard_count > 1) {
+		return_value += arena_bytes<logprob_accumulator>(limits.vocab_shard_count * rows);
+	}
+	return_value += arena_bytes<float>(limits.max_prompt_length);
+	return return_value;
+}
+
+// Per-row scratch for one forward pass, sized for the larger of a prefill chunk and a full decode batch
+constexpr uint64_t compute_activation_bytes(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	const uint64_t rows{ compute_activation_row_count(limits) };
+	uint64_t return_value{};
+	return_value += 4 * arena_bytes<float>(rows * shape.embedding_dim);
+	return_value += 2 * arena_bytes<float>(rows * shape.kv_dim);
+	return_value += 2 * arena_bytes<float>(rows * shape.ffn_dim);
+	return_value += arena_bytes<float>(limits.max_context_length);
+	return_value += arena_bytes<float>(limits.max_batch_size * shape.vocab_size);
+	return_value += arena_bytes<logit_candidates>(limits.max_batch_size);
+	return_value += arena_bytes<float>(output_tile_row_count * limits.max_batch_size);
+	return_value += 2 * arena_bytes<uint32_t>(rows);
+	return_value += arena_bytes<uint64_t>(gather_table_capacity(rows));
+	return_value += compute_gemm_pack_bytes(shape, limits);
+	return_value += compute_expert_activation_bytes(shape, limits);
+	return_value += compute_adapter_activation_bytes(limits);
+	return_value += compute_vocab_shard_activation_bytes(shape, limits);
+	return_value += compute_packing_activation_bytes(shape, limits);
+	return_value += compute_scoring_activation_bytes(limits);
+	return return_value;
+}
+
+// The engine's tokenized prompts - one max_prompt_length buffer per slot
+constexpr uint64_t compute_prompt_arena_bytes(const serving_limits& limits) noexcept {
+	return arena_bytes<uint32_t>(limits.max_batch_size * limits.max_prompt_length);
+}
+
+constexpr memory_layout compute_memory_layout(const shape_dimensions& shape, const serving_limits& limits) noexcept {
+	memory_layout return_value{};
+	return_value.weight_bytes		  = compute_weight_bytes(shape, limits);
+	return_value.kv_cache_bytes		  = compute_kv_cache_bytes(shape, limits);
+	return_value.activation_bytes	  = compute_activation_bytes(shape, limits);
+	return_value.adapter_bytes		  = compute_adapter_bytes(shape, limits);
+	return_value.kv_block_count		  = compute_kv_block_count(limits);
+	return_value.kv_block_bytes		  = compute_kv_block_bytes(shape);
+	return_value.activation_row_count = compute_activation_row_count(limits);
+	return return_value;
+}
+
+// Compile-time planner - every arena of a model instance is sized here, before anything is allocated
+template<typename config_type, typename shape_type> struct memory_plan {
+	static constexpr shape_dimensions shape{ shape_type::layer_count, shape_type::head_dim, shape_type::embedding_dim, shape_type::kv_dim, shape_type::ffn_dim,
+		shape_type::vocab_size, shape_type::weight_dtype };
+	static constexpr serving_limits limits{ config_type::max_batch_size, config_type::max_context_length, config_type::max_prompt_length, config_type::expert_count,
+		config_type::expert_top_k, config_type::local_expert_count, config_type::adapter_capacity, config_type::adapter_rank,
+		config_type::vocab_shard_count, config_type::scoring };
+	static constexpr memory_layout layout{ compute_memory_layout(shape, limits) };
+	static constexpr uint64_t prefill_chunk_length{ compute_prefill_chunk_length(limits) };
+	static constexpr uint64_t activation_row_count{ layout.activation_row_count };
+	static constexpr uint64_t local_vocab_size{ compute_local_vocab_size(shape, limits) };
+	static constexpr uint64_t kv_slot_count{ compute_kv_slot_count(limits) };
+};
@@ -0,0 +1,449 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <algorithm>
+#include <type_traits>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+// Undefined template - triggers compiler error with enum_error and values embedded in the type name
+// This creates readable compile-time error messages that show exactly what went wrong
+template<auto enum_error, auto... values> struct error_printer_impl_val;
+
+// Static assertion wrapper that generates compile-time errors with contextual information
+// Uses immediately-invoked constexpr lambda to trigger error_printer_impl_val when condition fails
+template<bool value, auto enum_error, auto... values> struct static_assert_printer_val {
+	static constexpr bool impl{ [] {
+		if constexpr (!value) {
+			error_printer_impl_val<enum_error, values...>::nonexistent_value;
+			return false;
+		} else {
+			return true;
+		}
+	}() };
+};
+
+// Undefined template - triggers compiler error with enum_error and values embedded in the type name
+// This creates readable compile-time error messages that show exactly what went wrong
+template<auto enum_error, typename... values> struct error_printer_impl;
+
+// Static assertion wrapper that generates compile-time errors with contextual information
+// Uses immediately-invoked constexpr lambda to trigger error_printer_impl_val when condition fails
+template<bool value, auto enum_error, typename... types> struct static_assert_printer {
+	static constexpr bool impl{ [] {
+		if constexpr (!value) {
+			error_printer_impl<enum_error, types...>::nonexistent_value;
+			return false;
+		} else {
+			return true;
+		}
+	}() };
+};
+
+// Strongly-typed configuration wrappers - each enum class becomes a unique type for overload resolution
+// Using enum class as semantic wrappers enables type-based dispatch while preventing parameter confusion
+// The disabled/enabled pattern provides compile-time optionality without runtime branches
+
+enum class exceptions_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class benchmark_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class dev_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class prefix_cache_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class warmup_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class numa_prefault_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class expert_parallel_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class vocab_parallel_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+enum class trace_capture_type : bool {
+	disabled = std::numeric_limits<bool>::min(),
+	enabled	 = std::numeric_limits<bool>::max(),
+};
+
+// Value-carrying configuration types - enum class acts as strong typedef for type-based routing
+// Using numeric_limits sentinels for disabled/enabled establishes "unset" vs "explicitly set" semantics
+
+enum class max_context_length_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class gpu_rank_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class gpu_count_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class max_generation_length_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class max_prompt_length_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class max_batch_size_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class expert_count_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class expert_top_k_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class adapter_capacity_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class adapter_rank_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+// Configuration container with default values
+// Each field corresponds to exactly one wrapper type above
+struct model_config {
+	exceptions_type exceptions{};
+	max_context_length_type max_context_length{ static_cast<max_context_length_type>(1024) };
+	max_prompt_length_type max_prompt_length{ static_cast<max_prompt_length_type>(std::numeric_limits<uint64_t>::max()) };
+	max_generation_length_type max_generation_length{ static_cast<max_generation_length_type>(std::numeric_limits<uint64_t>::max()) };
+	max_batch_size_type max_batch_size{ static_cast<max_batch_size_type>(1) };
+	gpu_count_type gpu_count{ static_cast<gpu_count_type>(1ull) };
+	gpu_rank_type gpu_rank{};
+	benchmark_type benchmark{};
+	dev_type dev{};
+	prefix_cache_type prefix_cache{};
+	warmup_type warmup{};
+	numa_prefault_type numa_prefault{};
+	expert_count_type expert_count{ static_cast<expert_count_type>(1) };
+	expert_top_k_type expert_top_k{ static_cast<expert_top_k_type>(std::numeric_limits<uint64_t>::max()) };
+	expert_parallel_type expert_parallel{};
+	adapter_capacity_type adapter_capacity{};
+	adapter_rank_type adapter_rank{ static_cast<adapter_rank_type>(16) };
+	vocab_parallel_type vocab_parallel{};
+	trace_capture_type trace_capture{};
+
+	// Type-specific update methods - each overload handles exactly one wrapper type
+	// Overload resolution routes each parameter to the correct update function at compile time
+	// consteval forces compile-time evaluation, ensuring zero runtime overhead
+	// Each update modifies only its corresponding field (disjoint state) enabling order independence
+
+	template<std::same_as<exceptions_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.exceptions = value;
+		return return_value;
+	}
+
+	template<std::same_as<max_context_length_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.max_context_length = value;
+		return return_value;
+	}
+
+	template<std::same_as<gpu_rank_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.gpu_rank = value;
+		return return_value;
+	}
+
+	template<std::same_as<gpu_count_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.gpu_count = value;
+		return return_value;
+	}
+
+	template<std::same_as<max_prompt_length_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.max_prompt_length = value;
+		return return_value;
+	}
+
+	template<std::same_as<max_generation_length_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.max_generation_length = value;
+		return return_value;
+	}
+
+	template<std::same_as<max_batch_size_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.max_batch_size = value;
+		return return_value;
+	}
+
+	template<std::same_as<benchmark_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.benchmark = value;
+		return return_value;
+	}
+
+	template<std::same_as<dev_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.dev = value;
+		return return_value;
+	}
+
+	template<std::same_as<prefix_cache_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.prefix_cache = value;
+		return return_value;
+	}
+
+	template<std::same_as<warmup_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.warmup = value;
+		return return_value;
+	}
+
+	template<std::same_as<numa_prefault_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.numa_prefault = value;
+		return return_value;
+	}
+
+	template<std::same_as<expert_count_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.expert_count = value;
+		return return_value;
+	}
+
+	template<std::same_as<expert_top_k_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.expert_top_k = value;
+		return return_value;
+	}
+
+	template<std::same_as<expert_parallel_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.expert_parallel = value;
+		return return_value;
+	}
+
+	template<std::same_as<adapter_capacity_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.adapter_capacity = value;
+		return return_value;
+	}
+
+	template<std::same_as<adapter_rank_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.adapter_rank = value;
+		return return_value;
+	}
+
+	template<std::same_as<vocab_parallel_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.vocab_parallel = value;
+		return return_value;
+	}
+
+	template<std::same_as<trace_capture_type> value_type> consteval auto update(const value_type value) const {
+		model_config return_value{ *this };
+		return_value.trace_capture = value;
+		return return_value;
+	}
+};
+
+constexpr uint64_t ceil_div(uint64_t a, uint64_t b) noexcept {
+	return (a + b - 1) / b;
+}
+
+// Compile-time value transformation - if a parameter is set to max (sentinel for "unset"),
+// compute a reasonable default based on another parameter
+// This demonstrates dependent defaults while maintaining compile-time evaluation
+template<uint64_t value_01, uint64_t value_02> consteval uint64_t get_updated_value() {
+	if constexpr (value_01 == std::numeric_limits<uint64_t>::max()) {
+		return ceil_div(value_02, 2);
+	} else {
+		return value_01;
+	}
+}
+
+// FNV-1a over the little-endian bytes of each resolved value
+// Identifies a configuration across processes and runs, e.g. to key benchmark results
+template<typename... value_types> constexpr uint64_t fingerprint_values(value_types... values) noexcept {
+	uint64_t hash{ 0xcbf29ce484222325ull };
+	const auto combine = [&](uint64_t value) {
+		for (uint64_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+			hash ^= (value >> (byte * 8)) & 0xffull;
+			hash *= 0x100000001b3ull;
+		}
+	};
+	(combine(static_cast<uint64_t>(values)), ...);
+	return hash;
+}
+
+// Error categories for static_assert messages
+enum class model_config_errors {
+	context_length_too_large,
+	context_length_too_short,
+	prompt_length_or_generation_length_too_large,
+	gpu_rank_not_below_gpu_count,
+	expert_top_k_out_of_range,
+	expert_count_not_divisible_by_gpu_count,
+	adapter_capacity_below_max_batch_size,
+	adapter_rank_zero,
+	duplicate_type_input,
+};
+
+// Compile-time configuration validator and type generator
+// Takes a compile-time model_config and produces constexpr constants with validation
+// All static_asserts fire at compile time if constraints are violated
+template<const model_config& config> struct model_config_type {
+	static constexpr bool exceptions				= static_cast<bool>(config.exceptions);
+	static constexpr uint64_t max_context_length	= static_cast<uint64_t>(config.max_context_length);
+	static constexpr uint64_t max_generation_length = get_updated_value<static_cast<uint64_t>(config.max_generation_length), max_context_length>();
+	static constexpr uint64_t max_batch_size		= static_cast<uint64_t>(config.max_batch_size);
+	static constexpr uint64_t gpu_count				= static_cast<uint64_t>(config.gpu_count);
+	static constexpr uint64_t gpu_rank				= static_cast<uint64_t>(config.gpu_rank);
+	static constexpr bool benchmark					= static_cast<bool>(config.benchmark);
+	static constexpr bool dev						= static_cast<bool>(config.dev);
+	static constexpr bool prefix_cache				= static_cast<bool>(config.prefix_cache);
+	static constexpr bool warmup					= static_cast<bool>(config.warmup);
+	static constexpr bool numa_prefault				= static_cast<bool>(config.numa_prefault);
+	static constexpr uint64_t expert_count			= static_cast<uint64_t>(config.expert_count);
+	static constexpr bool expert_parallel			= static_cast<bool>(config.expert_parallel);
+	static constexpr uint64_t adapter_capacity		= static_cast<uint64_t>(config.adapter_capacity);
+	static constexpr uint64_t adapter_rank			= static_cast<uint64_t>(config.adapter_rank);
+	static constexpr bool vocab_parallel			= static_cast<bool>(config.vocab_parallel);
+	static constexpr bool trace_capture				= static_cast<bool>(config.trace_capture);
+
+	// Scoring mode - with a generation budget of zero (max_generation_length_type::disabled) every request is prefilled for the
+	// logprobs of its own prompt tokens and nothing is sampled, so an unset prompt limit takes the whole context instead of half
+	static constexpr bool scoring				= max_generation_length == 0;
+	static constexpr uint64_t max_prompt_length = scoring && static_cast<uint64_t>(config.max_prompt_length) == std::numeric_limits<uint64_t>::max()
+		? max_context_length
+		: get_updated_value<static_cast<uint64_t>(config.max_prompt_length), max_context_length>();
+
+	// Two experts per token unless set, never more than there are
+	static constexpr uint64_t expert_top_k = static_cast<uint64_t>(config.expert_top_k) == std::numeric_limits<uint64_t>::max() ? std::min<uint64_t>(expert_count, 2)
+																																: static_cast<uint64_t>(config.expert_top_k);
+
+	// Under expert_parallel_type::enabled every rank holds expert_count / gpu_count consecutive experts, otherwise all of them
+	static constexpr uint64_t expert_shard_count = expert_parallel ? gpu_count : 1;
+	static constexpr uint64_t local_expert_count = expert_count / expert_shard_count;
+	static constexpr uint64_t first_local_expert = expert_parallel ? gpu_rank * local_expert_count : 0;
+
+	// Under vocab_parallel_type::enabled every rank holds a contiguous 1 / gpu_count of the output rows, see stand_in_model
+	static constexpr uint64_t vocab_shard_count = vocab_parallel ? gpu_count : 1;
+
+	static constexpr uint64_t fingerprint = fingerprint_values(exceptions, max_context_length, max_prompt_length, max_generation_length, max_batch_size, gpu_count, gpu_rank,
+		benchmark, dev, prefix_cache, warmup, numa_prefault, expert_count, expert_top_k, expert_parallel,
+		adapter_capacity, adapter_rank, vocab_parallel, trace_capture);
+
+	// Same as fingerprint but without gpu_rank - every rank of one tensor-parallel group shares it
+	static constexpr uint64_t rank_group_fingerprint = fingerprint_values(exceptions, max_context_length, max_prompt_length, max_generation_length, max_batch_size,
+		gpu_count, benchmark, dev, prefix_cache, warmup, numa_prefault, expert_count, expert_top_k, expert_parallel,
+		adapter_capacity, adapter_rank, vocab_parallel, trace_capture);
+
+	// Compile-time validation - these static_asserts fire during template instantiation
+	// If constraints fail, compilation aborts with clear error messages showing exact values
+	static_assert(static_assert_printer_val<(max_context_length > 1), model_config_errors::context_length_too_short, max_context_length>::impl);
+	static_assert(static_assert_printer_val<(max_generation_length + max_prompt_length) <= max_context_length, model_config_errors::prompt_length_or_generation_length_too_large,
+		max_context_length, max_generation_length, max_prompt_length>::impl);
+	static_assert(static_assert_printer_val<(gpu_rank < gpu_count), model_config_errors::gpu_rank_not_below_gpu_count, gpu_rank, gpu_count>::impl);
+	static_assert(static_assert_printer_val<(expert_top_k > 0 && expert_top_k <= expert_count), model_config_errors::expert_top_k_out_of_range, expert_top_k, expert_count>::impl);
+	static_assert(static_assert_printer_val<(expert_count % expert_shard_count == 0), model_config_errors::expert_count_not_divisible_by_gpu_count, expert_count,
+		expert_shard_count>::impl);
+	// Every active sequence pins the adapter it runs with, so a full batch of distinct adapters has to fit
+	static_assert(static_assert_printer_val<(adapter_capacity == 0 || adapter_capacity >= max_batch_size), model_config_errors::adapter_capacity_below_max_batch_size,
+		adapter_capacity, max_batch_size>::impl);
+	static_assert(static_assert_printer_val<(adapter_rank > 0), model_config_errors::adapter_rank_zero, adapter_rank>::impl);
+
+	static constexpr const model_config& get_config() {
+		return config;
+	}
+};
+
+// CRITICAL INNOVATION: Compile-time uniqueness checking via fold-expression-based occurrence counting
+// For a given search_type, count how many times it appears in check_types parameter pack
+// Fold expression expands to: is_same<T, T1> + is_same<T, T2> + ... + is_same<T, Tn>
+// Result: integer count of how many times search_type appears in the pack
+template<typename search_type, typename... check_types> constexpr uint64_t type_occurrence_count =
+	(static_cast<uint64_t>(std::is_same_v<std::remove_cvref_t<search_type>, std::remove_cvref_t<check_types>>) + ...);
+
+// Concept that enforces each type in arg_types appears exactly once
+// Expands to: (count<T1, all> == 1) && (count<T2, all> == 1) && ... && (count<Tn, all> == 1)
+// If any type appears more than once, concept fails and compilation aborts with clear diagnostic
+// This is the KEY ADVANCEMENT: compile-time duplicate parameter detection
+template<typename... arg_types>
+concept unique_configuration_types = ((type_occurrence_count<arg_types, arg_types...> == 1) && ...);
+
+// Variadic configuration generator with uniqueness constraint
+// Parameters can be provided in ANY order - overload resolution routes each to correct update()
+// The unique_configuration_types concept ensures no parameter type appears twice
+// Fold expression applies updates sequentially: config.update(arg1).update(arg2).update(arg3)...
+// consteval forces compile-time evaluation - entire configuration system has zero runtime cost
+template<unique_configuration_types... arg_types> inline static consteval auto generate_model_config(arg_types... args) {
+	static_assert(static_assert_printer<unique_configuration_types<arg_types...>, model_config_errors::duplicate_type_input, arg_types...>::impl);
+	model_config config_new{};
+	((config_new = config_new.update(args)), ...);
+	return config_new;
+};
+
+// Overload that takes existing config as base and applies additional updates
+// Enables configuration composition and hierarchical defaults
+// Uniqueness checking applies only to new parameters, not base config fields
+template<unique_configuration_types... arg_types> inline static consteval auto generate_model_config(model_config config_new, arg_types... args) {
+	static_assert(static_assert_printer<unique_configuration_types<arg_types...>, model_config_errors::duplicate_type_input, arg_types...>::impl);
+	((config_new = config_new.update(args)), ...);
+	return config_new;
+};
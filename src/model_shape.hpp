@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "model_config.hpp"
+
+// Architecture wrappers - the same strong typedef pattern as the serving limits in model_config.hpp
+// These describe the transformer itself (how big the weights are), not how it is served
+
+enum class layer_count_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class head_count_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class kv_head_count_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class head_dim_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class ffn_dim_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class vocab_size_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+enum class weight_seed_type : uint64_t {
+	disabled = std::numeric_limits<uint64_t>::min(),
+	enabled	 = std::numeric_limits<uint64_t>::max(),
+};
+
+// Storage format of the projection and output matrices - norms, rope and the embedding table are always f32
+// q8 and q4 are symmetric block formats: one f32 scale per weight_block_size weights, then 8-bit or packed 4-bit values
+enum class weight_dtype_type : uint8_t {
+	f32,
+	bf16,
+	q8,
+	q4,
+};
+
+// Weights per quantization block - a block never straddles two rows, so every matrix width must be a multiple of it
+inline constexpr uint64_t weight_block_size{ 32 };
+
+constexpr uint64_t weight_dtype_block_size(weight_dtype_type dtype) noexcept {
+	return dtype == weight_dtype_type::q8 || dtype == weight_dtype_type::q4 ? weight_block_size : 1;
+}
+
+// Bytes of one row of cols weights - the layout the kernels in weight_format.hpp read
+constexpr uint64_t weight_row_bytes(weight_dtype_type dtype, uint64_t cols) noexcept {
+	switch (dtype) {
+		case weight_dtype_type::bf16:
+			return cols * sizeof(uint16_t);
+		case weight_dtype_type::q8:
+			return cols / weight_block_size * (sizeof(float) + weight_block_size);
+		case weight_dtype_type::q4:
+			return cols / weight_block_size * (sizeof(float) + weight_block_size / 2);
+		default:
+			return cols * sizeof(float);
+	}
+}
+
+// Shape container with defaults for a tiny stand-in model
+// kv_head_count and ffn_dim use the max sentinel so they can be derived from head_count and embedding width
+struct model_shape {
+	layer_count_type layer_count{ static_cast<layer_count_type>(2) };
+	head_count_type head_count{ static_cast<head_count_type>(4) };
+	kv_head_count_type kv_head_count{ static_cast<kv_head_count_type>(std::numeric_limits<uint64_t>::max()) };
+	head_dim_type head_dim{ static_cast<head_dim_type>(16) };
+	ffn_dim_type ffn_dim{ static_cast<ffn_dim_type>(std::numeric_limits<uint64_t>::max()) };
+	vocab_size_type vocab_size{ static_cast<vocab_size_type>(256) };
+	weight_seed_type weight_seed{ static_cast<weight_seed_type>(0x6f616363ull) };
+	weight_dtype_type weight_dtype{};
+
+	template<std::same_as<layer_count_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.layer_count = value;
+		return return_value;
+	}
+
+	template<std::same_as<head_count_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.head_count = value;
+		return return_value;
+	}
+
+	template<std::same_as<kv_head_count_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.kv_head_count = value;
+		return return_value;
+	}
+
+	template<std::same_as<head_dim_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.head_dim = value;
+		return return_value;
+	}
+
+	template<std::same_as<ffn_dim_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.ffn_dim = value;
+		return return_value;
+	}
+
+	template<std::same_as<vocab_size_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.vocab_size = value;
+		return return_value;
+	}
+
+	template<std::same_as<weight_seed_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.weight_seed = value;
+		return return_value;
+	}
+
+	template<std::same_as<weight_dtype_type> value_type> consteval auto update(const value_type value) const {
+		model_shape return_value{ *this };
+		return_value.weight_dtype = value;
+		return return_value;
+	}
+};
+
+// Dependent default - if value_01 is the unset sentinel, fall back to value_02 verbatim
+// Counterpart of get_updated_value for fields whose natural default is another field rather than a fraction of it
+template<uint64_t value_01, uint64_t value_02> consteval uint64_t get_defaulted_value() {
+	if constexpr (value_01 == std::numeric_limits<uint64_t>::max()) {
+		return value_02;
+	} else {
+		return value_01;
+	}
+}
+
+// Error categories for static_assert messages
+enum class model_shape_errors {
+	dimension_is_zero,
+	head_count_not_divisible_by_kv_head_count,
+	head_dim_not_multiple_of_two,
+	dimension_not_multiple_of_weight_block,
+	duplicate_type_input,
+};
+
+// Compile-time shape validator and type generator - the model_shape counterpart of model_config_type
+// Every dimension the kernels need is a static constexpr so loops can be fully specialized
+template<const model_shape& shape> struct model_shape_type {
+	static constexpr uint64_t layer_count	  = static_cast<uint64_t>(shape.layer_count);
+	static constexpr uint64_t head_count	  = static_cast<uint64_t>(shape.head_count);
+	static constexpr uint64_t kv_head_count	  = get_defaulted_value<static_cast<uint64_t>(shape.kv_head_count), head_count>();
+	static constexpr uint64_t head_dim		  = static_cast<uint64_t>(shape.head_dim);
+	static constexpr uint64_t embedding_dim	  = head_count * head_dim;
+	static constexpr uint64_t kv_dim		  = kv_head_count * head_dim;
+	static constexpr uint64_t ffn_dim		  = get_defaulted_value<static_cast<uint64_t>(shape.ffn_dim), embedding_dim * 4>();
+	static constexpr uint64_t vocab_size	  = static_cast<uint64_t>(shape.vocab_size);
+	static constexpr uint64_t weight_seed	  = static_cast<uint64_t>(shape.weight_seed);
+	static constexpr uint64_t kv_group_size	  = kv_head_count == 0 ? 1 : head_count / kv_head_count;
+	static constexpr uint64_t fingerprint	  = fingerprint_values(layer_count, head_count, kv_head_count, head_dim, ffn_dim, vocab_size, weight_seed, shape.weight_dtype);
+
+	static constexpr weight_dtype_type weight_dtype{ shape.weight_dtype };
+
+	// Parameter counts drive the memory planner and the roofline math in the benchmarks
+	static constexpr uint64_t layer_parameter_count = 2 * embedding_dim + 2 * embedding_dim * embedding_dim + 2 * kv_dim * embedding_dim + 3 * ffn_dim * embedding_dim;
+	static constexpr uint64_t parameter_count		= 2 * vocab_size * embedding_dim + embedding_dim + layer_count * layer_parameter_count;
+
+	static_assert(static_assert_printer_val<(layer_count > 0 && head_count > 0 && kv_head_count > 0 && head_dim > 0 && ffn_dim > 0 && vocab_size > 0),
+		model_shape_errors::dimension_is_zero, layer_count, head_count, kv_head_count, head_dim, ffn_dim, vocab_size>::impl);
+	static_assert(static_assert_printer_val<(kv_head_count != 0 && head_count % kv_head_count == 0), model_shape_errors::head_count_not_divisible_by_kv_head_count, head_count, kv_head_count>::impl);
+	static_assert(static_assert_printer_val<(head_dim % 2 == 0), model_shape_errors::head_dim_not_multiple_of_two, head_dim>::impl);
+	// Matrices are embedding_dim or ffn_dim wide
+	static_assert(static_assert_printer_val<(embedding_dim % weight_dtype_block_size(weight_dtype) == 0 && ffn_dim % weight_dtype_block_size(weight_dtype) == 0),
+		model_shape_errors::dimension_not_multiple_of_weight_block, weight_dtype, embedding_dim, ffn_dim>::impl);
+
+	static constexpr const model_shape& get_shape() {
+		return shape;
+	}
+};
+
+// Variadic shape generator - identical routing and uniqueness rules as generate_model_config
+template<unique_configuration_types... arg_types> inline static consteval auto generate_model_shape(arg_types... args) {
+	static_assert(static_assert_printer<unique_configuration_types<arg_types...>, model_shape_errors::duplicate_type_input, arg_types...>::impl);
+	model_shape shape_new{};
+	((shape_new = shape_new.update(args)), ...);
+	return shape_new;
+};
+
+// Overload that takes an existing shape as base and applies additional updates
+template<unique_configuration_types... arg_types> inline static consteval auto generate_model_shape(model_shape shape_new, arg_types... args) {
+	static_assert(static_assert_printer<unique_configuration_types<arg_types...>, model_shape_errors::duplicate_type_input, arg_types...>::impl);
+	((shape_new = shape_new.update(args)), ...);
+	return shape_new;
+};
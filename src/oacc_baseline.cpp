@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark_baseline.hpp"
+#include <string_view>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+
+// Exit status of compare is 2 when any metric regressed, so the command can gate a pre-submit script, and 3 when nothing did but a
+// metric with too few samples to decide moved by --min-change in the worse direction
+static void print_usage() {
+	std::cerr << "usage: oacc_baseline [--store DIR] save NAME REPORT\n"
+				 "       oacc_baseline [--store DIR] list\n"
+				 "       oacc_baseline [--store DIR] compare NAME REPORT [--alpha X] [--min-change X] [--seed N] [--output FILE]\n";
+}
+
+static const char* status_message(baseline_status status) {
+	switch (status) {
+		case baseline_status::invalid_name:
+			return "invalid baseline name (use letters, digits, '.', '_' and '-')";
+		case baseline_status::open_failed:
+			return "cannot open";
+		case baseline_status::parse_failed:
+			return "not an oacc_bench report";
+		case baseline_status::write_failed:
+			return "cannot write";
+		default:
+			return "ok";
+	}
+}
+
+static void print_comparison(const comparison_report& report) {
+	std::printf("%-48s %-20s %12s %12s %8s %19s %8s  %s\n", "benchmark", "metric", "baseline", "candidate", "change", "95% interval", "p", "verdict");
+	for (const metric_comparison& comparison: report.comparisons) {
+		const std::string_view verdict{ comparison_verdict_names[static_cast<uint64_t>(comparison.verdict)] };
+		if (comparison.metric.empty()) {
+			std::printf("%-48s %-20s %12s %12s %8s %19s %8s  %.*s\n", comparison.benchmark.c_str(), "-", "-", "-", "-", "-", "-", static_cast<int>(verdict.size()),
+				verdict.data());
+			continue;
+		}
+		if (comparison.verdict == comparison_verdict::insufficient_samples) {
+			std::printf("%-48s %-20s %12.4g %12.4g %+7.2f%% %19s %8s  %.*s\n", comparison.benchmark.c_str(), comparison.metric.c_str(), comparison.baseline_median,
+				comparison.candidate_median, 100.0 * comparison.relative_change, "-", "-", static_cast<int>(verdict.size()), verdict.data());
+			continue;
+		}
+		std::printf("%-48s %-20s %12.4g %12.4g %+7.2f%% [%+7.2f%%, %+7.2f%%] %8.4f  %.*s\n", comparison.benchmark.c_str(), comparison.metric.c_str(), comparison.baseline_median,
+			comparison.candidate_median, 100.0 * comparison.relative_change, 100.0 * comparison.interval.low, 100.0 * comparison.interval.high, comparison.p_value,
+			static_cast<int>(verdict.size()), verdict.data());
+	}
+	std::printf("\n%llu regressed, %llu improved, %llu with too few samples to decide\n", static_cast<unsigned long long>(report.count(comparison_verdict::regressed)),
+		static_cast<unsigned long long>(report.count(comparison_verdict::improved)), static_cast<unsigned long long>(report.count(comparison_verdict::insufficient_samples)));
+	for (const metric_comparison& comparison: report.comparisons) {
+		if (comparison.possible_regression) {
+			std::fprintf(stderr, "warning: %s %s moved %+.2f%% in the worse direction but has too few samples to decide (%llu baseline, %llu candidate) - rerun with more repetitions\n",
+				comparison.benchmark.c_str(), comparison.metric.c_str(), 100.0 * comparison.relative_change, static_cast<unsigned long long>(comparison.baseline_count),
+				static_cast<unsigned long long>(comparison.candidate_count));
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	baseline_store store{};
+	comparison_options options{};
+	std::string output_path{};
+	std::vector<std::string_view> positional{};
+	for (int index = 1; index < argc; ++index) {
+		const std::string_view argument{ argv[index] };
+		if (!argument.starts_with("--")) {
+			positional.emplace_back(argument);
+			continue;
+		}
+		if (index + 1 >= argc) {
+			print_usage();
+			return 1;
+		}
+		const std::string_view value{ argv[++index] };
+		if (argument == "--store") {
+			store.directory = value;
+		} else if (argument == "--alpha") {
+			options.alpha = std::strtod(value.data(), nullptr);
+		} else if (argument == "--min-change") {
+			options.min_relative_change = std::strtod(value.data(), nullptr);
+		} else if (argument == "--seed") {
+			options.seed = std::strtoull(value.data(), nullptr, 10);
+		} else if (argument == "--output") {
+			output_path = value;
+		} else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (positional.size() == 1 && positional[0] == "list") {
+		for (const std::string& name: store.list()) {
+			std::cout << name << "\n";
+		}
+		return 0;
+	}
+	if (positional.size() != 3 || (positional[0] != "save" && positional[0] != "compare")) {
+		print_usage();
+		return 1;
+	}
+
+	const std::string_view name{ positional[1] };
+	const std::string report_path{ positional[2] };
+	benchmark_report candidate{};
+	if (const baseline_status status{ load_benchmark_report(report_path, candidate) }; status != baseline_status::ok) {
+		std::cerr << report_path << ": " << status_message(status) << "\n";
+		return 1;
+	}
+
+	if (positional[0] == "save") {
+		if (const baseline_status status{ store.save(name, candidate) }; status != baseline_status::ok) {
+			std::cerr << store.path_for(name).string() << ": " << status_message(status) << "\n";
+			return 1;
+		}
+		return 0;
+	}
+
+	benchmark_report baseline{};
+	if (const baseline_status status{ store.load(name, baseline) }; status != baseline_status::ok) {
+		std::cerr << "baseline " << name << ": " << status_message(status) << "\n";
+		return 1;
+	}
+	const comparison_report comparison{ compare_reports(baseline, candidate, options) };
+	print_comparison(comparison);
+	if (!output_path.empty()) {
+		std::ofstream{ output_path } << comparison.to_json();
+	}
+	if (comparison.count(comparison_verdict::regressed) > 0) {
+		return 2;
+	}
+	return comparison.possible_regression_count() > 0 ? 3 : 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// oacc_bench.cpp
+
+#include "bench_kernels.hpp"
+#include "bench_packing.hpp"
+#include "bench_ranks.hpp"
+#include "bench_router.hpp"
+#include "bench_score.hpp"
+#include "bench_host.hpp"
+#include "bench_ingress.hpp"
+#include "bench_swap.hpp"
+#include "bench_startup.hpp"
+#include "bench_sweep.hpp"
+#include "bench_zygote.hpp"
+#include <string_view>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+// Every suite emits the same benchmark_report JSON so results can be stored and compared uniformly
+static void print_usage() {
+	std::cerr << "usage: oacc_bench [--suite sweep|kernels|startup|zygote|ranks|host|swap|score|packing|router|ingress] [--repetitions N] [--warmup N] [--requests N] [--seed N] [--output FILE]\n";
+}
+
+int main(int argc, char** argv) {
+	bench_options options{};
+	for (int index = 1; index < argc; ++index) {
+		const std::string_view argument{ argv[index] };
+		const bool has_value{ index + 1 < argc };
+		if (argument == "--suite" && has_value) {
+			options.suite = argv[++index];
+		} else if (argument == "--repetitions" && has_value) {
+			options.repetitions = std::strtoull(argv[++index], nullptr, 10);
+		} else if (argument == "--warmup" && has_value) {
+			options.warmup_repetitions = std::strtoull(argv[++index], nullptr, 10);
+		} else if (argument == "--requests" && has_value) {
+			options.request_count = std::strtoull(argv[++index], nullptr, 10);
+		} else if (argument == "--seed" && has_value) {
+			options.seed = std::strtoull(argv[++index], nullptr, 10);
+		} else if (argument == "--output" && has_value) {
+			options.output_path = argv[++index];
+		} else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	benchmark_report report{};
+	if (options.suite == "sweep") {
+		report = run_sweep_suite(options);
+	} else if (options.suite == "kernels") {
+		report = run_kernel_suite(options);
+	} else if (options.suite == "startup") {
+		report = run_startup_suite(options);
+	} else if (options.suite == "zygote") {
+		report = run_zygote_suite(options);
+	} else if (options.suite == "ranks") {
+		report = run_rank_suite(options);
+	} else if (options.suite == "host") {
+		report = run_host_suite(options);
+	} else if (options.suite == "swap") {
+		report = run_swap_suite(options);
+	} else if (options.suite == "score") {
+		report = run_score_suite(options);
+	} else if (options.suite == "packing") {
+		report = run_packing_suite(options);
+	} else if (options.suite == "router") {
+		report = run_router_suite(options);
+	} else if (options.suite == "ingress") {
+		report = run_ingress_suite(options);
+	} else {
+		std::cerr << "unknown suite: " << options.suite << "\n";
+		print_usage();
+		return 1;
+	}
+
+	const std::string json{ report.to_json() };
+	if (options.output_path.empty()) {
+		std::cout << json;
+	} else {
+		std::ofstream{ options.output_path } << json;
+	}
+	return 0;
+}
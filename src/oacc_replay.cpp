@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// oacc_replay.cpp
+
+#include "trace_replay.hpp"
+#include <string_view>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <memory>
+
+// Replay target - requests outside these limits are clamped or rejected according to --policy
+// Trace capture is on so --capture can round-trip what the engine recorded of the replay
+static constexpr auto replay_config = generate_model_config(max_batch_size_type{ 8 }, max_context_length_type{ 1024 }, benchmark_type::enabled, trace_capture_type::enabled);
+static constexpr auto replay_shape	= generate_model_shape(layer_count_type{ 4 }, head_count_type{ 8 }, kv_head_count_type{ 4 }, head_dim_type{ 32 }, vocab_size_type{ 4096 });
+
+using replay_engine_type = engine<stand_in_model<model_config_type<replay_config>, model_shape_type<replay_shape>>>;
+
+static void print_usage() {
+	std::cerr << "usage: oacc_replay --trace FILE [--mode open|closed] [--time-scale X] [--concurrency N] [--sample N] [--seed N] [--policy clamp|reject] [--memory-budget host|BYTES] [--capture FILE] [--output FILE]\n"
+				 "       oacc_replay --synthesize FILE [--requests N] [--rate REQUESTS_PER_SECOND] [--seed N]\n";
+}
+
+int main(int argc, char** argv) {
+	replay_options options{};
+	trace_synthesis_params synthesis{};
+	std::string trace_path{};
+	std::string synthesize_path{};
+	std::string output_path{};
+	std::string memory_budget{};
+	std::string capture_path{};
+	for (int index = 1; index < argc; ++index) {
+		const std::string_view argument{ argv[index] };
+		const bool has_value{ index + 1 < argc };
+		if (!has_value) {
+			print_usage();
+			return 1;
+		}
+		const std::string_view value{ argv[++index] };
+		if (argument == "--trace") {
+			trace_path = value;
+		} else if (argument == "--synthesize") {
+			synthesize_path = value;
+		} else if (argument == "--mode" && (value == "open" || value == "closed")) {
+			options.mode = value == "open" ? replay_mode::open_loop : replay_mode::closed_loop;
+		} else if (argument == "--policy" && (value == "clamp" || value == "reject")) {
+			options.policy = value == "clamp" ? limit_policy::clamp : limit_policy::reject;
+		} else if (argument == "--time-scale") {
+			options.time_scale = std::strtod(value.data(), nullptr);
+		} else if (argument == "--concurrency") {
+			options.concurrency = std::max<uint64_t>(std::strtoull(value.data(), nullptr, 10), 1);
+		} else if (argument == "--sample") {
+			options.sample_count = std::strtoull(value.data(), nullptr, 10);
+		} else if (argument == "--seed") {
+			options.seed   = std::strtoull(value.data(), nullptr, 10);
+			synthesis.seed = options.seed;
+		} else if (argument == "--requests") {
+			synthesis.request_count = std::strtoull(value.data(), nullptr, 10);
+		} else if (argument == "--rate") {
+			synthesis.requests_per_second = std::strtod(value.data(), nullptr);
+		} else if (argument == "--memory-budget") {
+			memory_budget = value;
+		} else if (argument == "--capture") {
+			capture_path = value;
+		} else if (argument == "--output") {
+			output_path = value;
+		} else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (!synthesize_path.empty()) {
+		if (!save_trace(synthesize_path, synthesize_trace(synthesis))) {
+			std::cerr << "failed to write " << synthesize_path << "\n";
+			return 1;
+		}
+		return 0;
+	}
+	if (trace_path.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	const trace_load_result trace{ load_trace(trace_path) };
+	if (trace.status != trace_status::ok) {
+		std::cerr << "failed to load " << trace_path << (trace.status == trace_status::malformed_line ? ": malformed line " + std::to_string(trace.line_number) : "") << "\n";
+		return 1;
+	}
+
+	// Without --memory-budget the engine runs at the declared limits; "host" sizes it for this host's cgroup and meminfo limits
+	runtime_sizing sizing{ replay_engine_type::declared_sizing };
+	if (!memory_budget.empty()) {
+		using plan_type = replay_engine_type::model_type::plan_type;
+		const uint64_t budget_bytes{ memory_budget == "host" ? read_host_resources().memory_budget_bytes() : std::strtoull(memory_budget.c_str(), nullptr, 10) };
+		sizing = compute_runtime_sizing(plan_type::shape, plan_type::limits, budget_bytes);
+		std::cerr << "sized for " << budget_bytes << " bytes: max_batch_size " << sizing.max_batch_size << ", kv_block_count " << sizing.kv_block_count << ", committing "
+				  << sizing.committed_bytes() << " bytes\n";
+		if (!sizing.fits) {
+			std::cerr << "the budget does not cover one slot of the replay config\n";
+			return 1;
+		}
+	}
+	const auto engine_instance{ std::make_unique<replay_engine_type>(sizing) };
+	benchmark_report report{ "replay", {} };
+	report.results.emplace_back(replay_trace(*engine_instance, trace.records, options));
+
+	// Round trip - the engine recorded one line per request it accepted; save them, load them back and replay the capture
+	if (!capture_path.empty()) {
+		const auto parameter = [&](std::string_view name) {
+			for (const auto& [key, value]: report.results.front().parameters) {
+				if (key == name) {
+					return value;
+				}
+			}
+			return uint64_t{};
+		};
+		if (!engine_instance->trace_capture.get().save(capture_path)) {
+			std::cerr << "failed to write " << capture_path << "\n";
+			return 1;
+		}
+		const trace_load_result capture{ load_trace(capture_path) };
+		const uint64_t accepted_count{ parameter("trace_requests") - parameter("rejected") };
+		if (capture.status != trace_status::ok || capture.records.size() != accepted_count) {
+			std::cerr << "capture " << capture_path << " did not round-trip: " << capture.records.size() << " of " << accepted_count << " accepted requests\n";
+			return 1;
+		}
+		engine_instance->trace_capture.reset();
+		replay_options capture_options{ options };
+		capture_options.sample_count = 0;
+		report.results.emplace_back(replay_trace(*engine_instance, capture.records, capture_options));
+		report.results.back().name += "/capture";
+	}
+
+	const std::string json{ report.to_json() };
+	if (output_path.empty()) {
+		std::cout << json;
+	} else {
+		std::ofstream{ output_path } << json;
+	}
+	return 0;
+}
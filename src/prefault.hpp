@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_arena.hpp"
+#include <initializer_list>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+// CPUs of one NUMA node, as listed by sysfs
+struct numa_node {
+	uint64_t id{};
+	std::vector<uint32_t> cpus{};
+};
+
+// Parses a sysfs cpu or node list such as "0-3,8,10-11"
+inline std::vector<uint32_t> parse_cpu_list(const std::string& list) {
+	std::vector<uint32_t> return_value{};
+	uint64_t position{};
+	while (position < list.size()) {
+		uint64_t end{ list.find(',', position) };
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		const std::string range{ list.substr(position, end - position) };
+		const uint64_t dash{ range.find('-') };
+		const uint32_t first{ static_cast<uint32_t>(std::stoul(range.substr(0, dash))) };
+		const uint32_t last{ dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1))) };
+		for (uint32_t cpu = first; cpu <= last; ++cpu) {
+			return_value.emplace_back(cpu);
+		}
+		position = end + 1;
+	}
+	return return_value;
+}
+
+// Online NUMA nodes with their CPUs - empty where sysfs is unavailable, which callers treat as a single node
+inline std::vector<numa_node> numa_nodes() {
+	std::vector<numa_node> return_value{};
+	std::ifstream online_file{ "/sys/devices/system/node/online" };
+	std::string online{};
+	if (!std::getline(online_file, online) || online.empty()) {
+		return return_value;
+	}
+	for (const uint32_t id: parse_cpu_list(online)) {
+		std::ifstream cpu_file{ "/sys/devices/system/node/node" + std::to_string(id) + "/cpulist" };
+		std::string cpus{};
+		if (std::getline(cpu_file, cpus) && !cpus.empty()) {
+			return_value.emplace_back(numa_node{ id, parse_cpu_list(cpus) });
+		}
+	}
+	return return_value;
+}
+
+// Restricts the calling thread to the CPUs of node - a no-op outside Linux
+inline void pin_to_numa_node(const numa_node& node) noexcept {
+#if defined(__linux__)
+	cpu_set_t set{};
+	CPU_ZERO(&set);
+	for (const uint32_t cpu: node.cpus) {
+		if (cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &set);
+		}
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	static_cast<void>(node);
+#endif
+}
+
+// Commits every page of every arena before the first request needs it
+// With numa_parallel and more than one node, each arena is split into one contiguous share per node and every share is
+// touched by a thread pinned to its node, so first-touch placement interleaves the arena across nodes. Otherwise the
+// calling thread touches everything
+inline void prefault_arenas(std::initializer_list<const memory_arena*> arenas, bool numa_parallel) {
+	const std::vector<numa_node> nodes{ numa_parallel ? numa_nodes() : std::vector<numa_node>{} };
+	if (nodes.size() <= 1) {
+		for (const memory_arena* arena: arenas) {
+			arena->prefault(0, arena->reserved());
+		}
+		return;
+	}
+	std::vector<std::thread> threads{};
+	threads.reserve(nodes.size());
+	for (uint64_t index = 0; index < nodes.size(); ++index) {
+		threads.emplace_back([&, index] {
+			pin_to_numa_node(nodes[index]);
+			for (const memory_arena* arena: arenas) {
+				const uint64_t share{ align_up((arena->reserved() + nodes.size() - 1) / nodes.size(), prefault_page_bytes) };
+				arena->prefault(index * share, (index + 1) * share);
+			}
+		});
+	}
+	for (std::thread& thread: threads) {
+		thread.join();
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_plan.hpp"
+#include "errors.hpp"
+
+// Prompt prefix reuse across the sequence slots of one model instance - active only with prefix_cache_type::enabled
+// Every slot remembers the chained hashes of the whole kv_block_token_count-token blocks of the prompt last prefilled into it;
+// the KV of those positions stays valid until another prompt is prefilled into the slot, active or not
+// Chains start from the adapter id the prompt was prefilled with, so KV computed under one adapter only matches that adapter
+template<typename config_type, typename shape_type> struct prefix_cache {
+	static constexpr bool active{ config_type::prefix_cache };
+	static constexpr uint64_t max_batch_size{ config_type::max_batch_size };
+	static constexpr uint64_t max_block_count{ std::max<uint64_t>(config_type::max_prompt_length / kv_block_token_count, 1) };
+
+	struct prefix_match {
+		uint64_t slot{};
+		uint64_t token_count{};
+	};
+
+	memory_arena arena{ arena_bytes<uint64_t>(max_batch_size * max_block_count) + arena_bytes<uint64_t>(max_batch_size) };
+	uint64_t* block_hashes{ arena.allocate<uint64_t>(max_batch_size * max_block_count) };
+	uint64_t* block_counts{ arena.allocate<uint64_t>(max_batch_size) };
+	uint64_t lookup_token_count{};
+	uint64_t reused_token_count{};
+
+	prefix_cache() {
+		if (!block_hashes || !block_counts) {
+			raise_runtime_error<config_type::exceptions>("prefix_cache: failed to reserve the block table");
+		}
+		std::fill_n(block_counts, max_batch_size, 0);
+	}
+
+	// Chained FNV-1a - a block's hash covers every token before it, so equal hashes mean equal prefixes
+	static uint64_t hash_block(uint64_t previous_hash, const uint32_t* tokens) noexcept {
+		uint64_t hash{ previous_hash ^ 0xcbf29ce484222325ull };
+		for (uint64_t index = 0; index < kv_block_token_count; ++index) {
+			hash ^= tokens[index];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// Longest prefix of tokens, in whole blocks, whose KV some slot already holds
+	prefix_match lookup(const uint32_t* tokens, uint64_t token_count, uint64_t adapter_id = 0) noexcept {
+		lookup_token_count += token_count;
+		prefix_match return_value{};
+		const uint64_t block_count{ std::min(token_count / kv_block_token_count, max_block_count) };
+		uint64_t hash{ adapter_id };
+		for (uint64_t block = 0; block < block_count; ++block) {
+			hash = hash_block(hash, tokens + block * kv_block_token_count);
+			bool found{};
+			for (uint64_t slot = 0; slot < max_batch_size; ++slot) {
+				if (block < block_counts[slot] && block_hashes[slot * max_block_count + block] == hash) {
+					return_value = prefix_match{ slot, (block + 1) * kv_block_token_count };
+					found		 = true;
+					break;
+				}
+			}
+			if (!found) {
+				break;
+			}
+		}
+		return return_value;
+	}
+
+	// Forgets every slot - for when slot KV is overwritten outside of prefill, e.g. by engine::warmup()
+	void clear() noexcept {
+		std::fill_n(block_counts, max_batch_size, 0);
+	}
+
+	// Called after a prompt has been prefilled into slot - replaces whatever the slot held before
+	void insert(uint64_t slot, const uint32_t* tokens, uint64_t token_count, uint64_t adapter_id = 0) noexcept {
+		const uint64_t block_count{ std::min(token_count / kv_block_token_count, max_block_count) };
+		uint64_t hash{ adapter_id };
+		for (uint64_t block = 0; block < block_count; ++block) {
+			hash										 = hash_block(hash, tokens + block * kv_block_token_count);
+			block_hashes[slot * max_block_count + block] = hash;
+		}
+		block_counts[slot] = block_count;
+	}
+};
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <cstdint>
+
+// splitmix64 - tiny, seedable and identical on every platform
+// Used for stand-in weights, synthetic workloads and sampling so every run is reproducible from its seed
+struct random_generator {
+	uint64_t state{};
+
+	constexpr explicit random_generator(uint64_t seed) noexcept : state{ seed } {
+	}
+
+	constexpr uint64_t next() noexcept {
+		uint64_t value{ (state += 0x9e3779b97f4a7c15ull) };
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+		return value ^ (value >> 31);
+	}
+
+	// Uniform in [0, 1) using the top 24 bits so every value is exactly representable
+	constexpr float next_float() noexcept {
+		return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	// Uniform in [0, bound) - bound must be non-zero
+	constexpr uint64_t next_below(uint64_t bound) noexcept {
+		return next() % bound;
+	}
+};
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "shared_queue.hpp"
+#include "zygote.hpp"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// How replica_router picks the replica for a request
+// round_robin takes them in turn; kv_aware sends a request to the replica that was last sent the same leading prompt blocks,
+// whose prefix cache likely still holds their KV, unless that replica is too far behind - otherwise to the least loaded one
+enum class routing_policy {
+	round_robin,
+	kv_aware,
+};
+
+// One request on its way to a replica - the prompt travels inline as tokens, so the replica owns its copy
+template<uint64_t max_prompt_length> struct routed_request {
+	uint64_t id{};
+	uint64_t prompt_length{};
+	uint64_t generation_length{};
+	sampling_params sampling{};
+	uint64_t seed{};
+	uint64_t adapter_id{};
+	request_overrides overrides{};
+	uint32_t tokens[max_prompt_length]{};
+};
+
+inline constexpr uint64_t replica_request_capacity{ 64 };
+inline constexpr uint64_t replica_event_capacity{ 1024 };
+
+// Everything the router and one replica share - two rings plus what the replica publishes after each step
+template<uint64_t max_prompt_length> struct replica_channel {
+	shared_ring<routed_request<max_prompt_length>, replica_request_capacity> requests{};
+	shared_ring<token_event, replica_event_capacity> events{};
+	std::atomic<uint64_t> lookup_token_count{};
+	std::atomic<uint64_t> reused_token_count{};
+	std::atomic<bool> stopping{};
+	std::atomic<bool> exited{};
+};
+
+// Data-parallel serving across replica_count engine processes on one host
+// start() forks the replicas from an engine_zygote, so they share weights copy-on-write and own everything else, including
+// their prefix caches. The router talks to each over a pair of shared_rings in one fork_shared arena: requests go out with their
+// prompts tokenized, token events come back. Each request is charged to its replica as outstanding tokens - prompt plus
+// generation, clamped as the replica's engine will clamp it - and paid back as its tokens arrive, which is the load both
+// policies other than affinity look at
+// Affinity is a direct-mapped table from the chained hash of a prompt's leading kv blocks (the prefix cache's own hash, so the
+// same adapter-seeded chain) to the replica last sent that prefix. Replica caches evict on their own, so a hit is likely, not certain
+// submit(), poll() and stop() belong to one thread; call start() before that process creates threads of its own
+template<typename engine_type, uint64_t replica_count> struct replica_router {
+	static_assert(replica_count > 0, "replica_router: at least one replica");
+
+	using config_type	 = typename engine_type::config_type;
+	using shape_type	 = typename engine_type::shape_type;
+	using tokenizer_type = typename engine_type::tokenizer_type;
+
+	static constexpr uint64_t max_prompt_length{ engine_type::max_prompt_length };
+	static constexpr uint64_t no_replica{ ~uint64_t{} };
+	// Leading blocks hashed per request - past these, prompts that share a beginning rarely diverge
+	static constexpr uint64_t affinity_block_count{ 8 };
+	static constexpr uint64_t affinity_table_size{ 4096 };
+	// How far the affine replica may run ahead of the least loaded one before affinity is ignored - a full batch of the prefixes it can save
+	static constexpr uint64_t affinity_slack_tokens{ config_type::max_batch_size * affinity_block_count * kv_block_token_count };
+	static constexpr std::chrono::microseconds idle_wait{ 50 };
+
+	using request_record = routed_request<max_prompt_length>;
+	using channel_type	 = replica_channel<max_prompt_length>;
+
+	struct affinity_entry {
+		uint64_t hash{};
+		uint64_t replica{ no_replica };
+	};
+
+	struct in_flight_request {
+		uint64_t replica{};
+		uint64_t prompt_length{};
+		uint64_t outstanding_tokens{};
+	};
+
+	routing_policy policy{ routing_policy::kv_aware };
+	memory_arena shared_arena{ arena_bytes<channel_type>(replica_count), arena_sharing::fork_shared };
+	channel_type* channels{};
+	std::array<int64_t, replica_count> pids{};
+	uint64_t started_count{};
+	runtime_sizing sizing{ engine_type::declared_sizing };
+	engine_zygote<engine_type> zygote{};
+	tokenizer_type tokenizer{};
+	std::unique_ptr<request_record> staging{ std::make_unique<request_record>() };
+	std::array<uint64_t, replica_count> outstanding_tokens{};
+	std::array<affinity_entry, affinity_table_size> affinity{};
+	std::array<uint64_t, affinity_block_count> route_hashes{};
+	uint64_t route_hash_count{};
+	uint64_t next_replica{};
+	std::unordered_map<uint64_t, in_flight_request> in_flight{};
+	std::vector<token_event> events{};
+
+	explicit replica_router(routing_policy policy_new = routing_policy::kv_aware) : policy{ policy_new } {
+		tokenizer.load(shape_type::weight_seed);
+	}
+
+	replica_router(const replica_router&)			 = delete;
+	replica_router& operator=(const replica_router&) = delete;
+
+	~replica_router() noexcept {
+		stop();
+	}
+
+	// Forks the zygote and every replica from it - sizing_new is each replica's, see engine_zygote::start()
+	// The zygote is stopped once the replicas are running; they serve until stop()
+	// If any replica fails to spawn, those already running are stopped and submit() keeps returning model_unavailable
+	zygote_status start(const runtime_sizing& sizing_new = engine_type::declared_sizing) {
+		sizing	 = sizing_new;
+		channels = shared_arena.allocate<channel_type>(replica_count);
+		if (!channels) {
+			return zygote_status::spawn_failed;
+		}
+		for (uint64_t replica = 0; replica < replica_count; ++replica) {
+			std::construct_at(channels + replica);
+		}
+		channel_type* const shared_channels{ channels };
+		zygote_status status{ zygote.start(
+			[shared_channels](engine_type& replica_engine, uint64_t replica) {
+				return serve_replica(replica_engine, shared_channels[replica]);
+			},
+			sizing_new) };
+		while (status == zygote_status::ready && started_count < replica_count) {
+			zygote_spawn_reply reply{};
+			status = zygote.spawn(started_count, reply);
+			if (status == zygote_status::ready) {
+				pids[started_count++] = reply.pid;
+			}
+		}
+		zygote.stop();
+		// All or nothing - a router missing a replica would queue requests no process ever serves
+		if (status != zygote_status::ready) {
+			stop();
+		}
+		return status;
+	}
+
+	// The checks engine::submit() makes, then routes the request and queues it on its replica
+	// model_unavailable until every replica has started; queue_full if the chosen replica's queue has no room - poll() and retry
+	request_status submit(request_params request) {
+		if (const request_status status{ engine_type::check_request(request) }; status != request_status::accepted) {
+			return status;
+		}
+		if (!channels || started_count < replica_count) {
+			return request_status::model_unavailable;
+		}
+		request_record& record{ *staging };
+		record.id				 = request.id;
+		record.generation_length = request.generation_length;
+		record.sampling			 = request.sampling;
+		record.seed				 = request.seed;
+		record.adapter_id		 = request.adapter_id;
+		record.overrides		 = request.overrides;
+		if (request.prompt_tokens) {
+			std::copy_n(request.prompt_tokens, request.prompt_length, record.tokens);
+			record.prompt_length = request.prompt_length;
+		} else {
+			record.prompt_length = tokenizer.encode(request.prompt_text, record.tokens, max_prompt_length);
+		}
+		const uint64_t replica{ route(record.tokens, record.prompt_length, record.adapter_id) };
+		if (!channels[replica].requests.try_push(record)) {
+			return request_status::queue_full;
+		}
+		for (uint64_t block = 0; block < route_hash_count; ++block) {
+			affinity[route_hashes[block] & (affinity_table_size - 1)] = affinity_entry{ route_hashes[block], replica };
+		}
+		request.prompt_length = record.prompt_length;
+		const uint64_t cost{ record.prompt_length + engine_type::resolve_generation_length(request, sizing) };
+		outstanding_tokens[replica] += cost;
+		in_flight[request.id] = in_flight_request{ replica, record.prompt_length, cost };
+		return request_status::accepted;
+	}
+
+	// Picks the replica for a prompt and leaves its leading block hashes in route_hashes, for submit() to record once it is queued
+	uint64_t route(const uint32_t* tokens, uint64_t token_count, uint64_t adapter_id) noexcept {
+		route_hash_count = 0;
+		if (policy == routing_policy::round_robin) {
+			return next_replica++ % replica_count;
+		}
+		uint64_t least_loaded{};
+		for (uint64_t replica = 1; replica < replica_count; ++replica) {
+			least_loaded = outstanding_tokens[replica] < outstanding_tokens[least_loaded] ? replica : least_loaded;
+		}
+		// Hashed like prefix_cache::lookup() - the last prompt token is always prefilled, so it never counts towards a prefix
+		route_hash_count = std::min((token_count - 1) / kv_block_token_count, affinity_block_count);
+		uint64_t affine_replica{ no_replica };
+		uint64_t hash{ adapter_id };
+		bool matching{ true };
+		for (uint64_t block = 0; block < route_hash_count; ++block) {
+			hash				= prefix_cache<config_type, shape_type>::hash_block(hash, tokens + block * kv_block_token_count);
+			route_hashes[block] = hash;
+			const affinity_entry& entry{ affinity[hash & (affinity_table_size - 1)] };
+			matching	   = matching && entry.replica != no_replica && entry.hash == hash;
+			affine_replica = matching ? entry.replica : affine_replica;
+		}
+		if (affine_replica != no_replica && outstanding_tokens[affine_replica] <= outstanding_tokens[least_loaded] + affinity_slack_tokens) {
+			return affine_replica;
+		}
+		return least_loaded;
+	}
+
+	// Collects the tokens every replica has produced since the last call, valid until the next call
+	std::span<const token_event> poll() {
+		events.clear();
+		token_event event{};
+		for (uint64_t replica = 0; replica < started_count; ++replica) {
+			while (channels[replica].events.try_pop(event)) {
+				settle(event);
+				events.emplace_back(event);
+			}
+		}
+		return { events.data(), events.size() };
+	}
+
+	// Pays back a request's outstanding tokens - its whole prompt with the first token, the rest when it finishes
+	void settle(const token_event& event) {
+		const auto found{ in_flight.find(event.request_id) };
+		if (found == in_flight.end()) {
+			return;
+		}
+		in_flight_request& request{ found->second };
+		const uint64_t paid{ event.finished ? request.outstanding_tokens : std::min(request.outstanding_tokens, event.first ? request.prompt_length + 1 : 1) };
+		request.outstanding_tokens -= paid;
+		outstanding_tokens[request.replica] -= paid;
+		if (event.finished) {
+			in_flight.erase(found);
+		}
+	}
+
+	OACC_INLINE bool idle() const noexcept {
+		return in_flight.empty();
+	}
+
+	// Prompt tokens the replicas' prefix caches were asked for and found, as of each replica's last step
+	uint64_t lookup_token_count() const noexcept {
+		uint64_t return_value{};
+		for (uint64_t replica = 0; replica < started_count; ++replica) {
+			return_value += channels[replica].lookup_token_count.load(std::memory_order_relaxed);
+		}
+		return return_value;
+	}
+
+	uint64_t reused_token_count() const noexcept {
+		uint64_t return_value{};
+		for (uint64_t replica = 0; replica < started_count; ++replica) {
+			return_value += channels[replica].reused_token_count.load(std::memory_order_relaxed);
+		}
+		return return_value;
+	}
+
+	// Lets every replica finish what it was sent and waits for it to exit - tokens still arriving are dropped
+	void stop() noexcept {
+		for (uint64_t replica = 0; replica < started_count; ++replica) {
+			channels[replica].stopping.store(true, std::memory_order_release);
+		}
+		for (uint64_t replica = 0; replica < started_count; ++replica) {
+			token_event event{};
+			while (!channels[replica].exited.load(std::memory_order_acquire) && replica_alive(pids[replica])) {
+				while (channels[replica].events.try_pop(event)) {
+				}
+				std::this_thread::sleep_for(idle_wait);
+			}
+		}
+		started_count = 0;
+		in_flight.clear();
+		outstanding_tokens.fill(0);
+	}
+
+	// A replica that died without marking its channel is never waited for
+	static bool replica_alive(int64_t pid) noexcept {
+#if defined(_WIN32)
+		static_cast<void>(pid);
+		return false;
+#else
+		return pid > 0 && kill(static_cast<pid_t>(pid), 0) == 0;
+#endif
+	}
+
+	// Body of every replica process - queues what the router sent, steps, and publishes the step's tokens and cache counters
+	// The engine borrows each prompt until it has been prefilled, so the replica keeps its copy until the request's first token
+	static int serve_replica(engine_type& replica_engine, channel_type& channel) {
+		const auto record{ std::make_unique<request_record>() };
+		std::unordered_map<uint64_t, std::vector<uint32_t>> prompts{};
+		while (true) {
+			while (channel.requests.try_pop(*record)) {
+				std::vector<uint32_t>& prompt{ prompts[record->id] };
+				prompt.assign(record->tokens, record->tokens + record->prompt_length);
+				replica_engine.submit(request_params{ record->id, prompt.data(), prompt.size(), record->generation_length, record->sampling, record->seed, {},
+					record->adapter_id, record->overrides });
+			}
+			if (replica_engine.idle()) {
+				if (channel.stopping.load(std::memory_order_acquire) && channel.requests.empty()) {
+					break;
+				}
+				std::this_thread::sleep_for(idle_wait);
+				continue;
+			}
+			const std::span<const token_event> step_events{ replica_engine.step() };
+			// Published before the step's tokens, so a router that has seen a request finish sees the counters that include it
+			if constexpr (decltype(replica_engine.prefixes)::enabled) {
+				channel.lookup_token_count.store(replica_engine.prefixes.get().lookup_token_count, std::memory_order_relaxed);
+				channel.reused_token_count.store(replica_engine.prefixes.get().reused_token_count, std::memory_order_relaxed);
+			}
+			for (const token_event& event: step_events) {
+				if (event.first) {
+					prompts.erase(event.request_id);
+				}
+				while (!channel.events.try_push(event)) {
+					std::this_thread::yield();
+				}
+			}
+			replica_engine.complete_streaming();
+		}
+		channel.exited.store(true, std::memory_order_release);
+		return 0;
+	}
+};
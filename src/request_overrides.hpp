@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "model_config.hpp"
+
+// Per-request limits - the runtime counterpart of model_config for the three limits a single request may tighten
+// Built from the same wrapper types and in any order, but at runtime: overrides arrive with the request, so a type given twice
+// cannot be rejected by the compiler. Every set() records its type in set_mask, and a type that was already there in
+// duplicate_mask, which engine::check_request() turns into request_status::duplicate_override
+// Overrides only ever tighten - resolve_request_limits() clamps each one to the engine's model_config_type limit
+
+template<typename value_type>
+concept request_override_type =
+	std::same_as<value_type, max_context_length_type> || std::same_as<value_type, max_prompt_length_type> || std::same_as<value_type, max_generation_length_type>;
+
+// One bit per overridable wrapper type, for set_mask and duplicate_mask
+template<request_override_type value_type> inline constexpr uint64_t request_override_bit{ std::same_as<value_type, max_context_length_type> ? 1ull
+		: std::same_as<value_type, max_prompt_length_type>																					  ? 2ull
+																																			  : 4ull };
+
+struct request_overrides {
+	uint64_t set_mask{};
+	uint64_t duplicate_mask{};
+	max_context_length_type max_context_length{};
+	max_prompt_length_type max_prompt_length{};
+	max_generation_length_type max_generation_length{};
+
+	// Type-specific setters, as model_config::update() - the last value given for a type is kept, and the repeat recorded
+
+	template<std::same_as<max_context_length_type> value_type> OACC_INLINE request_overrides& set(const value_type value) noexcept {
+		mark<value_type>();
+		max_context_length = value;
+		return *this;
+	}
+
+	template<std::same_as<max_prompt_length_type> value_type> OACC_INLINE request_overrides& set(const value_type value) noexcept {
+		mark<value_type>();
+		max_prompt_length = value;
+		return *this;
+	}
+
+	template<std::same_as<max_generation_length_type> value_type> OACC_INLINE request_overrides& set(const value_type value) noexcept {
+		mark<value_type>();
+		max_generation_length = value;
+		return *this;
+	}
+
+	template<request_override_type value_type> OACC_INLINE void mark() noexcept {
+		duplicate_mask |= set_mask & request_override_bit<value_type>;
+		set_mask |= request_override_bit<value_type>;
+	}
+
+	OACC_INLINE bool has_duplicates() const noexcept {
+		return duplicate_mask != 0;
+	}
+};
+
+// Overrides known when the code is written - duplicates fail to compile, as with generate_model_config
+template<request_override_type... arg_types>
+	requires unique_configuration_types<arg_types...>
+OACC_INLINE request_overrides generate_request_overrides(arg_types... args) noexcept {
+	request_overrides return_value{};
+	(return_value.set(args), ...);
+	return return_value;
+}
+
+// The limits one request runs under, kept inline in its sequence slot
+struct request_limits {
+	uint64_t max_context_length{};
+	uint64_t max_prompt_length{};
+	uint64_t max_generation_length{};
+};
+
+// An override that was not set reads as all ones, so the min leaves the configuration's limit in place; one that was set is
+// clamped to [1, limit] - or to 0 where the limit itself is 0. No branch depends on which overrides a request carries
+template<request_override_type value_type> OACC_INLINE uint64_t clamp_override(const request_overrides& overrides, value_type value, uint64_t limit) noexcept {
+	const uint64_t unset{ (overrides.set_mask & request_override_bit<value_type>) / request_override_bit<value_type> - 1 };
+	return std::max(std::min(static_cast<uint64_t>(value) | unset, limit), std::min<uint64_t>(limit, 1));
+}
+
+// Resolves overrides against config_type's limits - the prompt limit also leaves at least one generated token within the
+// resolved context, which the configuration guarantees for its own limits (none when scoring)
+template<typename config_type> OACC_INLINE request_limits resolve_request_limits(const request_overrides& overrides) noexcept {
+	request_limits return_value{};
+	return_value.max_context_length	   = clamp_override(overrides, overrides.max_context_length, config_type::max_context_length);
+	return_value.max_generation_length = clamp_override(overrides, overrides.max_generation_length, config_type::max_generation_length);
+	return_value.max_prompt_length	   = std::min(clamp_override(overrides, overrides.max_prompt_length, config_type::max_prompt_length),
+			return_value.max_context_length - static_cast<uint64_t>(!config_type::scoring));
+	return return_value;
+}
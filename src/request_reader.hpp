@@ -0,0 +1,523 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "engine.hpp"
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <span>
+
+// On-demand reader for request bodies at ingress - the serving-path counterpart of json_reader, which builds a DOM:
+//
+//   { "id": 17, "prompt": "...", "max_tokens": 64, "temperature": 0.7, "top_k": 40, "seed": 5, "adapter_id": 0,
+//     "limits": { "max_context_length": 512, "max_prompt_length": 384, "max_generation_length": 64 } }
+//
+// Only "prompt" is required, any member may be null, and members it does not know are skipped. Numbers follow the JSON grammar
+// (no nan, inf, '+' or leading zeros) and temperature must not be negative. The members are read straight into request_params
+// in one pass, without allocating. prompt_text is a view into the body: a prompt with escapes is decoded in place, so the
+// body must stay alive and unshared until the request has been admitted
+// Strings are scanned in 64-byte blocks of eight words, each word tested for '"', '\\' and control characters at once (SWAR)
+// and the results gathered into one bit per byte, so long prompts cost a few operations per 8 bytes and every escape in
+// them a few more
+
+// Why parse_request() refused a body - bodies are runtime input, so failures are reported rather than raised
+enum class request_parse_status {
+	ok,
+	malformed,
+	missing_prompt,
+	invalid_member,
+};
+
+// The members parse_request() reads, in the order of request_member_names
+enum class request_member {
+	unknown,
+	id,
+	prompt,
+	max_tokens,
+	temperature,
+	top_k,
+	seed,
+	adapter_id,
+	limits,
+};
+
+inline constexpr std::string_view request_member_names[]{ "", "id", "prompt", "max_tokens", "temperature", "top_k", "seed", "adapter_id", "limits" };
+
+inline constexpr uint64_t swar_ones{ 0x0101010101010101ull };
+inline constexpr uint64_t swar_high_bits{ 0x8080808080808080ull };
+inline constexpr uint64_t swar_low_bits{ ~swar_high_bits };
+
+// 0x80 in every byte of word equal to byte, zero elsewhere - exact, no carry crosses a byte
+OACC_INLINE constexpr uint64_t swar_equal(uint64_t word, uint8_t byte) noexcept {
+	const uint64_t difference{ word ^ (swar_ones * byte) };
+	return ~(((difference & swar_low_bits) + swar_low_bits) | difference) & swar_high_bits;
+}
+
+// 0x80 in every byte of word below bound (at most 0x80), zero elsewhere - exact the same way
+OACC_INLINE constexpr uint64_t swar_below(uint64_t word, uint8_t bound) noexcept {
+	return ~(((word & swar_low_bits) + swar_ones * (0x80u - bound)) | word) & swar_high_bits;
+}
+
+// The bytes that end a run of plain string content
+OACC_INLINE constexpr uint64_t swar_string_specials(uint64_t word) noexcept {
+	return swar_equal(word, '"') | swar_equal(word, '\\') | swar_below(word, 0x20);
+}
+
+// Gathers the eight 0x80 marks of a swar mask into its low byte, byte 0 to bit 0 - the products never overlap, so nothing carries
+OACC_INLINE constexpr uint64_t swar_gather_marks(uint64_t mask) noexcept {
+	return ((mask >> 7) * 0x0102040810204080ull) >> 56;
+}
+
+struct request_reader {
+	static constexpr uint64_t no_block{ ~uint64_t{} };
+
+	char* data{};
+	uint64_t size{};
+	uint64_t offset{};
+	// The last block scanned - one bit per byte from block_base on, set for the string specials
+	uint64_t block_base{ no_block };
+	uint64_t block_mask{};
+
+	// Loaded in memory order, byte 0 lowest, whatever the platform's endianness
+	OACC_INLINE static uint64_t load_word(const char* address) noexcept {
+		uint64_t word{};
+		std::memcpy(&word, address, sizeof(word));
+		if constexpr (std::endian::native == std::endian::big) {
+			word = std::byteswap(word);
+		}
+		return word;
+	}
+
+	// Bitmask of the string specials among the 64 bytes at from - bytes past size count as specials, so scans stop there
+	OACC_INLINE uint64_t special_mask(uint64_t from) const noexcept {
+		uint64_t mask{};
+		if (from + 64 <= size) {
+			for (uint64_t word = 0; word < 8; ++word) {
+				mask |= swar_gather_marks(swar_string_specials(load_word(data + from + word * 8))) << (word * 8);
+			}
+			return mask;
+		}
+		for (uint64_t index = 0; index < 64; ++index) {
+			const unsigned char character{ from + index < size ? static_cast<unsigned char>(data[from + index]) : static_cast<unsigned char>('"') };
+			mask |= static_cast<uint64_t>(character == '"' || character == '\\' || character < 0x20) << index;
+		}
+		return mask;
+	}
+
+	// Index of the first '"', '\\' or control character at or after from, or size if there is none
+	// Consecutive calls inside one block only shift its mask, so a special costs a few instructions rather than a rescan
+	OACC_INLINE uint64_t find_string_special(uint64_t from) noexcept {
+		if (from >= block_base && from - block_base < 64) {
+			if (const uint64_t mask{ block_mask >> (from - block_base) }; mask) {
+				return std::min(from + static_cast<uint64_t>(std::countr_zero(mask)), size);
+			}
+			from = block_base + 64;
+		}
+		for (; from < size; from += 64) {
+			block_base = from;
+			block_mask = special_mask(from);
+			if (block_mask) {
+				return std::min(from + static_cast<uint64_t>(std::countr_zero(block_mask)), size);
+			}
+		}
+		return size;
+	}
+
+	void skip_whitespace() noexcept {
+		while (offset < size && (data[offset] == ' ' || data[offset] == '\t' || data[offset] == '\n' || data[offset] == '\r')) {
+			++offset;
+		}
+	}
+
+	bool consume(char expected) noexcept {
+		skip_whitespace();
+		if (offset < size && data[offset] == expected) {
+			++offset;
+			return true;
+		}
+		return false;
+	}
+
+	bool consume_literal(std::string_view literal) noexcept {
+		if (std::string_view{ data + offset, size - offset }.starts_with(literal)) {
+			offset += literal.size();
+			return true;
+		}
+		return false;
+	}
+
+	// Reads the string at offset into out - a view of the body, decoded in place if it holds escapes
+	// Decoding never writes past the read position, as no escape is shorter than what it decodes to
+	bool read_string(std::string_view& out) noexcept {
+		if (!consume('"')) {
+			return false;
+		}
+		const uint64_t start{ offset };
+		uint64_t write{ offset };
+		while (true) {
+			const uint64_t special{ find_string_special(offset) };
+			if (special == size) {
+				return false;
+			}
+			if (write != offset) {
+				std::memmove(data + write, data + offset, special - offset);
+			}
+			write += special - offset;
+			offset = special + 1;
+			if (data[special] == '"') {
+				out = std::string_view{ data + start, write - start };
+				return true;
+			}
+			if (data[special] != '\\' || !decode_escape(write)) {
+				return false;
+			}
+		}
+	}
+
+	// Skips a string without decoding it
+	bool skip_string() noexcept {
+		if (!consume('"')) {
+			return false;
+		}
+		while (true) {
+			const uint64_t special{ find_string_special(offset) };
+			// A '\\' ending the body has nothing to escape - failing here also keeps offset within the body
+			if (special == size || (data[special] != '"' && data[special] != '\\') || (data[special] == '\\' && special + 1 == size)) {
+				return false;
+			}
+			offset = special + (data[special] == '"' ? 1 : 2);
+			if (data[special] == '"') {
+				return true;
+			}
+		}
+	}
+
+	bool read_hex4(uint32_t& code_unit) noexcept {
+		if (offset + 4 > size || std::from_chars(data + offset, data + offset + 4, code_unit, 16).ptr != data + offset + 4) {
+			return false;
+		}
+		offset += 4;
+		return true;
+	}
+
+	// Decodes the escape after a '\\' at write, as UTF-8 for \u - a surrogate pair has to come as two consecutive escapes
+	bool decode_escape(uint64_t& write) noexcept {
+		if (offset >= size) {
+			return false;
+		}
+		const char escaped{ data[offset++] };
+		char simple{};
+		switch (escaped) {
+			case '"':
+			case '\\':
+			case '/':
+				simple = escaped;
+				break;
+			case 'b':
+				simple = '\b';
+				break;
+			case 'f':
+				simple = '\f';
+				break;
+			case 'n':
+				simple = '\n';
+				break;
+			case 'r':
+				simple = '\r';
+				break;
+			case 't':
+				simple = '\t';
+				break;
+			case 'u':
+				return decode_code_point(write);
+			default:
+				return false;
+		}
+		data[write++] = simple;
+		return true;
+	}
+
+	bool decode_code_point(uint64_t& write) noexcept {
+		uint32_t code_point{};
+		if (!read_hex4(code_point)) {
+			return false;
+		}
+		if (code_point >= 0xDC00 && code_point < 0xE000) {
+			return false;
+		}
+		if (code_point >= 0xD800 && code_point < 0xDC00) {
+			uint32_t low{};
+			if (!consume_literal("\\u") || !read_hex4(low) || low < 0xDC00 || low >= 0xE000) {
+				return false;
+			}
+			code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+		}
+		const auto put = [&](uint32_t byte) {
+			data[write++] = static_cast<char>(byte);
+		};
+		if (code_point < 0x80) {
+			put(code_point);
+		} else if (code_point < 0x800) {
+			put(0xC0 | code_point >> 6);
+			put(0x80 | (code_point & 0x3F));
+		} else if (code_point < 0x10000) {
+			put(0xE0 | code_point >> 12);
+			put(0x80 | (code_point >> 6 & 0x3F));
+			put(0x80 | (code_point & 0x3F));
+		} else {
+			put(0xF0 | code_point >> 18);
+			put(0x80 | (code_point >> 12 & 0x3F));
+			put(0x80 | (code_point >> 6 & 0x3F));
+			put(0x80 | (code_point & 0x3F));
+		}
+		return true;
+	}
+
+	// Length of the JSON number at offset, zero if there is none - from_chars alone would also take nan, inf and leading zeros
+	// integral is false when the number has a fraction or an exponent
+	uint64_t scan_number(bool& integral) const noexcept {
+		uint64_t end{ offset };
+		const auto digit = [&] {
+			return end < size && data[end] >= '0' && data[end] <= '9';
+		};
+		const auto skip_digits = [&] {
+			while (digit()) {
+				++end;
+			}
+		};
+		end += end < size && data[end] == '-';
+		if (!digit()) {
+			return 0;
+		}
+		if (data[end] == '0') {
+			++end;
+		} else {
+			skip_digits();
+		}
+		integral = true;
+		if (end < size && data[end] == '.') {
+			++end;
+			if (!digit()) {
+				return 0;
+			}
+			skip_digits();
+			integral = false;
+		}
+		if (end < size && (data[end] == 'e' || data[end] == 'E')) {
+			++end;
+			end += end < size && (data[end] == '+' || data[end] == '-');
+			if (!digit()) {
+				return 0;
+			}
+			skip_digits();
+			integral = false;
+		}
+		return end - offset;
+	}
+
+	// A non-negative integer - a fraction or exponent is not one, even when it is whole
+	template<typename value_type> bool read_integer(value_type& out) noexcept {
+		skip_whitespace();
+		bool integral{};
+		const uint64_t length{ scan_number(integral) };
+		if (length == 0 || !integral) {
+			return false;
+		}
+		const auto [end, error] = std::from_chars(data + offset, data + offset + length, out);
+		if (error != std::errc{} || end != data + offset + length) {
+			return false;
+		}
+		offset += length;
+		return true;
+	}
+
+	// A number out of float's range fails instead of reading as an infinity
+	bool read_float(float& out) noexcept {
+		skip_whitespace();
+		bool integral{};
+		const uint64_t length{ scan_number(integral) };
+		if (length == 0) {
+			return false;
+		}
+		const auto [end, error] = std::from_chars(data + offset, data + offset + length, out);
+		if (error != std::errc{} || end != data + offset + length) {
+			return false;
+		}
+		offset += length;
+		return true;
+	}
+
+	// null leaves a member at its default
+	bool read_null() noexcept {
+		skip_whitespace();
+		return consume_literal("null");
+	}
+
+	bool skip_value(uint64_t depth) noexcept {
+		static constexpr uint64_t max_depth{ 64 };
+		skip_whitespace();
+		if (offset >= size || depth > max_depth) {
+			return false;
+		}
+		const char first{ data[offset] };
+		if (first == '"') {
+			return skip_string();
+		}
+		if (first == '{' || first == '[') {
+			++offset;
+			const char closing{ first == '{' ? '}' : ']' };
+			if (consume(closing)) {
+				return true;
+			}
+			do {
+				if (first == '{' && (!skip_string() || !consume(':'))) {
+					return false;
+				}
+				if (!skip_value(depth + 1)) {
+					return false;
+				}
+			} while (consume(','));
+			return consume(closing);
+		}
+		if (consume_literal("true") || consume_literal("false") || consume_literal("null")) {
+			return true;
+		}
+		bool integral{};
+		const uint64_t length{ scan_number(integral) };
+		offset += length;
+		return length > 0;
+	}
+
+	// "limits": { "max_context_length": ..., "max_prompt_length": ..., "max_generation_length": ... } - each key a request_overrides
+	// wrapper type; a key given twice is not an error here, the overrides record it and the engine refuses the request
+	bool read_limits(request_overrides& overrides) noexcept {
+		if (!consume('{')) {
+			return false;
+		}
+		if (consume('}')) {
+			return true;
+		}
+		do {
+			std::string_view name{};
+			uint64_t value{};
+			if (!read_string(name) || !consume(':')) {
+				return false;
+			}
+			const bool known{ name == "max_context_length" || name == "max_prompt_length" || name == "max_generation_length" };
+			if (!known || read_null()) {
+				if (!known && !skip_value(2)) {
+					return false;
+				}
+				continue;
+			}
+			if (!read_integer(value)) {
+				return false;
+			}
+			if (name == "max_context_length") {
+				overrides.set(max_context_length_type{ value });
+			} else if (name == "max_prompt_length") {
+				overrides.set(max_prompt_length_type{ value });
+			} else {
+				overrides.set(max_generation_length_type{ value });
+			}
+		} while (consume(','));
+		return consume('}');
+	}
+
+	static request_member find_member(std::string_view name) noexcept {
+		for (uint64_t index = 1; index < std::size(request_member_names); ++index) {
+			if (request_member_names[index] == name) {
+				return static_cast<request_member>(index);
+			}
+		}
+		return request_member::unknown;
+	}
+
+	// Reads the value of one known member into out - false means the value is there but not what the member takes
+	bool read_member(request_member member, request_params& out) noexcept {
+		if (read_null()) {
+			return true;
+		}
+		switch (member) {
+			case request_member::id:
+				return read_integer(out.id);
+			case request_member::prompt:
+				return read_string(out.prompt_text);
+			case request_member::max_tokens:
+				return read_integer(out.generation_length);
+			case request_member::temperature:
+				return read_float(out.sampling.temperature) && std::isfinite(out.sampling.temperature) && out.sampling.temperature >= 0.0f;
+			case request_member::top_k:
+				return read_integer(out.sampling.top_k);
+			case request_member::seed:
+				return read_integer(out.seed);
+			case request_member::adapter_id:
+				return read_integer(out.adapter_id);
+			case request_member::limits:
+				return read_limits(out.overrides);
+			default:
+				return skip_value(1);
+		}
+	}
+
+	request_parse_status read_request(request_params& out) noexcept {
+		bool has_prompt{};
+		if (!consume('{')) {
+			return request_parse_status::malformed;
+		}
+		if (!consume('}')) {
+			do {
+				std::string_view name{};
+				if (!read_string(name) || !consume(':')) {
+					return request_parse_status::malformed;
+				}
+				// A value that does not fit its member is invalid_member only if it is well-formed JSON otherwise
+				const request_member member{ find_member(name) };
+				const uint64_t value_offset{ offset };
+				if (!read_member(member, out)) {
+					const uint64_t error_offset{ offset };
+					offset = value_offset;
+					const bool well_formed{ member != request_member::unknown && skip_value(1) };
+					offset = error_offset;
+					return well_formed ? request_parse_status::invalid_member : request_parse_status::malformed;
+				}
+				has_prompt = has_prompt || (member == request_member::prompt && out.prompt_text.data());
+			} while (consume(','));
+			if (!consume('}')) {
+				return request_parse_status::malformed;
+			}
+		}
+		skip_whitespace();
+		if (offset != size) {
+			return request_parse_status::malformed;
+		}
+		return has_prompt ? request_parse_status::ok : request_parse_status::missing_prompt;
+	}
+};
+
+// Reads one request body into out, whose members the body does not set keep their values - error_offset then points at the failure
+// A prompt with escapes is decoded in place, which leaves body itself no longer valid JSON
+inline request_parse_status parse_request(std::span<char> body, request_params& out, uint64_t* error_offset = nullptr) noexcept {
+	request_reader reader{ body.data(), body.size(), 0 };
+	const request_parse_status status{ reader.read_request(out) };
+	if (error_offset) {
+		*error_offset = reader.offset;
+	}
+	return status;
+}
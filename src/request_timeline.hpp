@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "latency_histogram.hpp"
+#include <string_view>
+#include <chrono>
+#include <limits>
+
+// Lifecycle phases of one request, in order - each phase ends where the next begins
+enum class request_phase : uint8_t {
+	queue,
+	tokenize,
+	prefill,
+	decode,
+	stream,
+};
+
+inline constexpr uint64_t request_phase_count{ 5 };
+
+inline constexpr std::string_view request_phase_names[request_phase_count]{ "queue", "tokenize", "prefill", "decode", "stream" };
+
+OACC_INLINE uint64_t monotonic_nanoseconds() noexcept {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Compact per-request record - one absolute submission time plus the end of every phase as a 32 bit microsecond offset
+// 32 bytes per request regardless of length (28 of data, padded to the alignment of submit_ns), stored inline in the queue entry and the sequence slot
+struct request_timeline {
+	uint64_t submit_ns{};
+	std::array<uint32_t, request_phase_count> phase_end_us{};
+
+	OACC_INLINE void start(uint64_t now_ns) noexcept {
+		submit_ns = now_ns;
+		phase_end_us.fill(0);
+	}
+
+	OACC_INLINE void mark(request_phase phase, uint64_t now_ns) noexcept {
+		const uint64_t offset_us{ (now_ns - submit_ns) / 1000 };
+		phase_end_us[static_cast<uint64_t>(phase)] = static_cast<uint32_t>(std::min<uint64_t>(offset_us, std::numeric_limits<uint32_t>::max()));
+	}
+
+	OACC_INLINE uint64_t duration_us(request_phase phase) const noexcept {
+		const uint64_t index{ static_cast<uint64_t>(phase) };
+		return index == 0 ? phase_end_us[0] : phase_end_us[index] - std::min(phase_end_us[index], phase_end_us[index - 1]);
+	}
+
+	OACC_INLINE uint64_t total_us() const noexcept {
+		return phase_end_us[request_phase_count - 1];
+	}
+};
+
+static_assert(sizeof(request_timeline) == 32);
+
+// Placeholder with the same interface for benchmark_type::disabled - [[no_unique_address]] makes it free
+struct disabled_request_timeline {
+	OACC_INLINE void start(uint64_t) noexcept {
+	}
+
+	OACC_INLINE void mark(request_phase, uint64_t) noexcept {
+	}
+};
+
+// Per-phase histograms aggregated over every completed request
+struct request_phase_metrics {
+	std::array<latency_histogram, request_phase_count> phases{};
+	latency_histogram end_to_end{};
+
+	OACC_INLINE void record(const request_timeline& timeline) noexcept {
+		for (uint64_t index = 0; index < request_phase_count; ++index) {
+			phases[index].record(timeline.duration_us(static_cast<request_phase>(index)));
+		}
+		end_to_end.record(timeline.total_us());
+	}
+
+	void reset() noexcept {
+		for (latency_histogram& histogram: phases) {
+			histogram.reset();
+		}
+		end_to_end.reset();
+	}
+};
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "random.hpp"
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <cmath>
+
+// Request trace - one line per request, whitespace separated, '#' starts a comment line:
+//
+//   # oacc request trace v1
+//   # request_id arrival_us prompt_length generation_length cancel_us
+//   17 125000 412 256 -
+//   18 125730 37 64 310000
+//
+// Times are microseconds since the start of the capture; cancel_us is absolute and '-' means the request was never cancelled
+
+inline constexpr std::string_view trace_header{ "# oacc request trace v1\n# request_id arrival_us prompt_length generation_length cancel_us\n" };
+
+// Same max-as-unset sentinel convention as the configuration wrappers
+inline constexpr uint64_t no_cancellation{ std::numeric_limits<uint64_t>::max() };
+
+struct trace_record {
+	uint64_t request_id{};
+	uint64_t arrival_us{};
+	uint64_t prompt_length{};
+	uint64_t generation_length{};
+	uint64_t cancel_us{ no_cancellation };
+};
+
+enum class trace_status {
+	ok,
+	open_failed,
+	malformed_line,
+};
+
+struct trace_load_result {
+	trace_status status{};
+	uint64_t line_number{};
+	std::vector<trace_record> records{};
+};
+
+inline constexpr std::string_view trace_whitespace{ " \t\r" };
+
+// One whitespace-delimited field - a number, or '-' (no_cancellation) only where allow_unset, i.e. in the cancel_us column
+inline bool parse_trace_field(std::string_view& line, uint64_t& value, bool allow_unset = false) noexcept {
+	const uint64_t start{ line.find_first_not_of(trace_whitespace) };
+	if (start == std::string_view::npos) {
+		return false;
+	}
+	line.remove_prefix(start);
+	const uint64_t length{ std::min(line.find_first_of(trace_whitespace), line.size()) };
+	if (allow_unset && length == 1 && line.front() == '-') {
+		value = no_cancellation;
+		line.remove_prefix(1);
+		return true;
+	}
+	const auto [end, error] = std::from_chars(line.data(), line.data() + length, value);
+	if (error != std::errc{} || end != line.data() + length) {
+		return false;
+	}
+	line.remove_prefix(length);
+	return true;
+}
+
+// Records are returned sorted by arrival time regardless of file order
+inline trace_load_result load_trace(const std::string& path) {
+	trace_load_result return_value{};
+	std::ifstream stream{ path };
+	if (!stream) {
+		return_value.status = trace_status::open_failed;
+		return return_value;
+	}
+	std::string line_buffer{};
+	while (std::getline(stream, line_buffer)) {
+		++return_value.line_number;
+		std::string_view line{ line_buffer };
+		const uint64_t first{ line.find_first_not_of(" \t\r") };
+		if (first == std::string_view::npos || line[first] == '#') {
+			continue;
+		}
+		trace_record record{};
+		if (!parse_trace_field(line, record.request_id) || !parse_trace_field(line, record.arrival_us) || !parse_trace_field(line, record.prompt_length) ||
+			!parse_trace_field(line, record.generation_length) || !parse_trace_field(line, record.cancel_us, true) ||
+			line.find_first_not_of(trace_whitespace) != std::string_view::npos) {
+			return_value.status = trace_status::malformed_line;
+			return return_value;
+		}
+		return_value.records.emplace_back(record);
+	}
+	std::stable_sort(return_value.records.begin(), return_value.records.end(), [](const trace_record& lhs, const trace_record& rhs) {
+		return lhs.arrival_us < rhs.arrival_us;
+	});
+	return_value.line_number = 0;
+	return return_value;
+}
+
+inline bool save_trace(const std::string& path, const std::vector<trace_record>& records) {
+	std::ofstream stream{ path };
+	if (!stream) {
+		return false;
+	}
+	stream << trace_header;
+	for (const trace_record& record: records) {
+		stream << record.request_id << ' ' << record.arrival_us << ' ' << record.prompt_length << ' ' << record.generation_length << ' ';
+		if (record.cancel_us == no_cancellation) {
+			stream << '-';
+		} else {
+			stream << record.cancel_us;
+		}
+		stream << '\n';
+	}
+	return static_cast<bool>(stream);
+}
+
+// Capture side - the engine's trace_capture subsystem calls it on every accepted request and cancellation, safe from any thread
+// Only lengths and times are kept, never prompt content
+struct trace_recorder {
+	using clock_type = std::chrono::steady_clock;
+
+	clock_type::time_point start{ clock_type::now() };
+	std::vector<trace_record> records{};
+	std::unordered_map<uint64_t, uint64_t> record_indices{};
+	std::mutex mutex{};
+
+	uint64_t now_us() const noexcept {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - start).count());
+	}
+
+	void record_arrival(uint64_t request_id, uint64_t prompt_length, uint64_t generation_length) {
+		const uint64_t arrival_us{ now_us() };
+		std::lock_guard lock{ mutex };
+		record_indices[request_id] = records.size();
+		records.emplace_back(trace_record{ request_id, arrival_us, prompt_length, generation_length, no_cancellation });
+	}
+
+	void record_cancellation(uint64_t request_id) {
+		const uint64_t cancel_us{ now_us() };
+		std::lock_guard lock{ mutex };
+		const auto iterator{ record_indices.find(request_id) };
+		if (iterator != record_indices.end()) {
+			records[iterator->second].cancel_us = cancel_us;
+		}
+	}
+
+	bool save(const std::string& path) {
+		std::lock_guard lock{ mutex };
+		return save_trace(path, records);
+	}
+};
+
+// Seeded subsample without replacement - a partial Fisher-Yates over indices, then restored to arrival order
+inline std::vector<trace_record> sample_trace(const std::vector<trace_record>& records, uint64_t sample_count, uint64_t seed) {
+	if (sample_count == 0 || sample_count >= records.size()) {
+		return records;
+	}
+	std::vector<uint64_t> indices(records.size());
+	for (uint64_t index = 0; index < indices.size(); ++index) {
+		indices[index] = index;
+	}
+	random_generator generator{ seed };
+	for (uint64_t index = 0; index < sample_count; ++index) {
+		std::swap(indices[index], indices[index + generator.next_below(indices.size() - index)]);
+	}
+	indices.resize(sample_count);
+	std::sort(indices.begin(), indices.end());
+	std::vector<trace_record> return_value{};
+	return_value.reserve(sample_count);
+	for (const uint64_t index: indices) {
+		return_value.emplace_back(records[index]);
+	}
+	return return_value;
+}
+
+// Synthetic trace for when no production capture is at hand - Poisson arrivals and exponential (long-tail) lengths
+struct trace_synthesis_params {
+	uint64_t request_count{ 256 };
+	double requests_per_second{ 8.0 };
+	double mean_prompt_length{ 96.0 };
+	double mean_generation_length{ 48.0 };
+	double cancel_fraction{ 0.05 };
+	double mean_cancel_delay_us{ 250000.0 };
+	uint64_t seed{ 1234 };
+};
+
+inline std::vector<trace_record> synthesize_trace(const trace_synthesis_params& params) {
+	random_generator generator{ params.seed };
+	const auto exponential = [&](double mean) {
+		return -mean * std::log(1.0 - static_cast<double>(generator.next_float()));
+	};
+	std::vector<trace_record> return_value(params.request_count);
+	double arrival_us{};
+	for (uint64_t index = 0; index < params.request_count; ++index) {
+		trace_record& record{ return_value[index] };
+		record.request_id		 = index;
+		record.arrival_us		 = static_cast<uint64_t>(arrival_us);
+		record.prompt_length	 = 1 + static_cast<uint64_t>(exponential(params.mean_prompt_length));
+		record.generation_length = 1 + static_cast<uint64_t>(exponential(params.mean_generation_length));
+		if (generator.next_float() < params.cancel_fraction) {
+			record.cancel_us = record.arrival_us + static_cast<uint64_t>(exponential(params.mean_cancel_delay_us));
+		}
+		arrival_us += exponential(1.0e6 / params.requests_per_second);
+	}
+	return return_value;
+}
+
+// What to do with a traced request that does not fit the target's model_config_type limits
+enum class limit_policy {
+	clamp,
+	reject,
+};
+
+struct limit_outcome {
+	uint64_t prompt_length{};
+	uint64_t generation_length{};
+	bool clamped{};
+	bool rejected{};
+};
+
+// Fits one record to the target configuration - clamp truncates the prompt first, then the generation budget
+template<typename config_type> limit_outcome apply_limit_policy(const trace_record& record, limit_policy policy) noexcept {
+	limit_outcome return_value{ record.prompt_length, std::max<uint64_t>(record.generation_length, 1), false, false };
+	const bool fits{ return_value.prompt_length <= config_type::max_prompt_length && return_value.generation_length <= config_type::max_generation_length &&
+		return_value.prompt_length + return_value.generation_length <= config_type::max_context_length };
+	if (return_value.prompt_length == 0 || (!fits && policy == limit_policy::reject)) {
+		return_value.rejected = true;
+		return return_value;
+	}
+	if (!fits) {
+		return_value.prompt_length	   = std::min(return_value.prompt_length, config_type::max_prompt_length);
+		return_value.generation_length = std::min({ return_value.generation_length, config_type::max_generation_length,
+			config_type::max_context_length - return_value.prompt_length });
+		return_value.clamped		   = true;
+	}
+	return return_value;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_plan.hpp"
+#include <fstream>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#if defined(__linux__)
+	#include <sched.h>
+#endif
+
+// Budget for a host that reported no memory limit at all - sizing then returns the declared maxima
+inline constexpr uint64_t unbounded_memory_bytes{ std::numeric_limits<uint64_t>::max() };
+
+// Share of the readable free memory left to the rest of the process and the kernel - page tables, partially touched KV pages, allocator slack
+inline constexpr uint64_t runtime_memory_headroom_percent{ 10 };
+
+// Batch and KV limits for the engines of one host, chosen at startup within the compile-time maxima of their config
+// Weights are counted once, since engines forked from one zygote share them; activations, resident adapters and the prompt arena
+// are counted at their declared size for every engine, since warmup commits those arenas whole. What is left buys KV blocks,
+// and max_batch_size is as many slots as those blocks can give a sequence with the longest prompt. fits is false when the
+// budget does not even cover one such slot per engine
+struct runtime_sizing {
+	uint64_t max_batch_size{};
+	uint64_t kv_block_count{};
+	uint64_t kv_block_bytes{};
+	uint64_t shared_bytes{};
+	uint64_t engine_bytes{};
+	uint64_t engine_count{};
+	uint64_t budget_bytes{};
+	bool fits{};
+
+	constexpr uint64_t committed_bytes() const noexcept {
+		return shared_bytes + engine_count * (engine_bytes + kv_block_count * kv_block_bytes);
+	}
+};
+
+// Same layout math as the compile-time planner - with unbounded_memory_bytes this is exactly the declared limits
+// The budget bounds resident memory: arenas stay reserved at their declared size and only the pages an engine sized this way
+// touches become resident. On Windows memory_arena commits whole reservations, so there the commit charge is still the
+// declared size of every arena and the budget bounds residency only
+constexpr runtime_sizing compute_runtime_sizing(const shape_dimensions& shape, const serving_limits& limits, uint64_t budget_bytes, uint64_t engine_count = 1) noexcept {
+	const memory_layout layout{ compute_memory_layout(shape, limits) };
+	runtime_sizing return_value{};
+	return_value.kv_block_bytes = layout.kv_block_bytes;
+	return_value.shared_bytes	= layout.weight_bytes;
+	return_value.engine_bytes	= layout.activation_bytes + layout.adapter_bytes + compute_prompt_arena_bytes(limits);
+	return_value.engine_count	= std::max<uint64_t>(engine_count, 1);
+	return_value.budget_bytes	= budget_bytes;
+	if (budget_bytes <= return_value.shared_bytes) {
+		return return_value;
+	}
+	const uint64_t engine_budget{ (budget_bytes - return_value.shared_bytes) / return_value.engine_count };
+	if (engine_budget <= return_value.engine_bytes) {
+		return return_value;
+	}
+	const uint64_t block_count{ std::min(layout.kv_block_count, (engine_budget - return_value.engine_bytes) / layout.kv_block_bytes) };
+	// Scored requests release their blocks within the step that admits them, so any number of them share one sequence's blocks
+	const uint64_t sequence_count{ block_count / compute_min_sequence_block_count(limits) };
+	const uint64_t batch_size{ limits.scoring && sequence_count > 0 ? limits.max_batch_size : std::min(limits.max_batch_size, sequence_count) };
+	if (batch_size == 0) {
+		return return_value;
+	}
+	return_value.max_batch_size = batch_size;
+	return_value.kv_block_count = block_count;
+	return_value.fits			= true;
+	return return_value;
+}
+
+// Memory and CPU limits visible to this process - a field stays zero when its source is missing or unlimited
+// cgroup limits are the tightest along the path from the process's cgroup v2 group up to the root of the hierarchy
+struct host_resources {
+	uint64_t cgroup_memory_limit_bytes{};
+	uint64_t cgroup_memory_usage_bytes{};
+	uint64_t available_memory_bytes{};
+	uint64_t cgroup_cpu_count{};
+	uint64_t affinity_cpu_count{};
+
+	// Memory this process may still commit, less runtime_memory_headroom_percent - the smaller of what the cgroup leaves and MemAvailable
+	uint64_t memory_budget_bytes() const noexcept {
+		uint64_t return_value{ unbounded_memory_bytes };
+		if (cgroup_memory_limit_bytes > 0) {
+			return_value = cgroup_memory_limit_bytes - std::min(cgroup_memory_usage_bytes, cgroup_memory_limit_bytes);
+		}
+		if (available_memory_bytes > 0) {
+			return_value = std::min(return_value, available_memory_bytes);
+		}
+		if (return_value == unbounded_memory_bytes) {
+			return return_value;
+		}
+		return return_value - return_value / 100 * runtime_memory_headroom_percent;
+	}
+
+	// CPUs this process can keep busy - the cgroup quota rounded up, capped by the affinity mask, at least one
+	uint64_t cpu_count() const noexcept {
+		uint64_t return_value{ affinity_cpu_count > 0 ? affinity_cpu_count : std::max<uint64_t>(std::thread::hardware_concurrency(), 1) };
+		if (cgroup_cpu_count > 0) {
+			return_value = std::min(return_value, cgroup_cpu_count);
+		}
+		return return_value;
+	}
+};
+
+inline std::string read_first_line(const std::string& path) {
+	std::ifstream file{ path };
+	std::string return_value{};
+	std::getline(file, return_value);
+	return return_value;
+}
+
+// Directory of this process's cgroup v2 group and the root of its hierarchy - the unified mount of a hybrid host is used when
+// /sys/fs/cgroup is v1. Both are empty without cgroup v2
+inline std::pair<std::string, std::string> cgroup_v2_directories() {
+	std::string root{};
+	for (const char* candidate: { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" }) {
+		if (std::ifstream{ std::string{ candidate } + "/cgroup.controllers" }) {
+			root = candidate;
+			break;
+		}
+	}
+	std::ifstream file{ "/proc/self/cgroup" };
+	std::string line{};
+	while (!root.empty() && std::getline(file, line)) {
+		if (line.starts_with("0::")) {
+			const std::string path{ line.substr(3) };
+			return { path == "/" ? root : root + path, root };
+		}
+	}
+	return {};
+}
+
+// Reads cgroup v2 memory.max, memory.current and cpu.max, /proc/meminfo and the affinity mask - all but the last are Linux only
+inline host_resources read_host_resources() {
+	host_resources return_value{};
+	const auto [group, root] = cgroup_v2_directories();
+	if (!group.empty()) {
+		return_value.cgroup_memory_usage_bytes = std::strtoull(read_first_line(group + "/memory.current").c_str(), nullptr, 10);
+		for (std::string directory{ group };; directory = directory.substr(0, directory.rfind('/'))) {
+			const std::string memory_max{ read_first_line(directory + "/memory.max") };
+			if (!memory_max.empty() && memory_max != "max") {
+				const uint64_t limit{ std::strtoull(memory_max.c_str(), nullptr, 10) };
+				return_value.cgroup_memory_limit_bytes = return_value.cgroup_memory_limit_bytes == 0 ? limit : std::min(return_value.cgroup_memory_limit_bytes, limit);
+			}
+			// "<quota> <period>" in microseconds, or "max <period>" without a quota
+			const std::string cpu_max{ read_first_line(directory + "/cpu.max") };
+			if (!cpu_max.empty() && !cpu_max.starts_with("max")) {
+				char* period_start{};
+				const uint64_t quota{ std::strtoull(cpu_max.c_str(), &period_start, 10) };
+				const uint64_t period{ std::strtoull(period_start, nullptr, 10) };
+				if (period > 0) {
+					const uint64_t cpus{ std::max<uint64_t>(ceil_div(quota, period), 1) };
+					return_value.cgroup_cpu_count = return_value.cgroup_cpu_count == 0 ? cpus : std::min(return_value.cgroup_cpu_count, cpus);
+				}
+			}
+			if (directory.size() <= root.size()) {
+				break;
+			}
+		}
+	}
+	std::ifstream meminfo{ "/proc/meminfo" };
+	std::string line{};
+	while (std::getline(meminfo, line)) {
+		if (line.starts_with("MemAvailable:")) {
+			return_value.available_memory_bytes = std::strtoull(line.c_str() + 13, nullptr, 10) * 1024;
+			break;
+		}
+	}
+#if defined(__linux__)
+	cpu_set_t set{};
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		return_value.affinity_cpu_count = static_cast<uint64_t>(CPU_COUNT(&set));
+	}
+#endif
+	return return_value;
+}
+
+// Sizes engine_count engines of one config and shape for this host
+template<typename config_type, typename shape_type> runtime_sizing size_for_host(const host_resources& resources, uint64_t engine_count = 1) {
+	using plan_type = memory_plan<config_type, shape_type>;
+	return compute_runtime_sizing(plan_type::shape, plan_type::limits, resources.memory_budget_bytes(), engine_count);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+// Single-producer single-consumer ring of fixed-size records, laid out so it can live in a fork_shared memory_arena and be used
+// from two processes - no pointers inside, records are copied in and out whole, and the only synchronization is the two
+// counters. head is written by the consumer only, tail by the producer only, each on its own cache line
+// Both counters grow without bound and are reduced to a record index on use, so full and empty never look alike
+template<typename record_type, uint64_t capacity> struct shared_ring {
+	static_assert(std::has_single_bit(capacity), "shared_ring: capacity must be a power of two");
+	static_assert(std::is_trivially_copyable_v<record_type>, "shared_ring: records cross a process boundary and must be trivially copyable");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared_ring: counters shared between processes must be lock-free");
+
+	alignas(64) std::atomic<uint64_t> head{};
+	alignas(64) std::atomic<uint64_t> tail{};
+	alignas(64) record_type records[capacity];
+
+	// Producer side - returns false, leaving the ring unchanged, when it is full
+	OACC_INLINE bool try_push(const record_type& record) noexcept {
+		const uint64_t tail_value{ tail.load(std::memory_order_relaxed) };
+		if (tail_value - head.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+		records[tail_value & (capacity - 1)] = record;
+		tail.store(tail_value + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side - returns false when the ring is empty
+	OACC_INLINE bool try_pop(record_type& record) noexcept {
+		const uint64_t head_value{ head.load(std::memory_order_relaxed) };
+		if (head_value == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		record = records[head_value & (capacity - 1)];
+		head.store(head_value + 1, std::memory_order_release);
+		return true;
+	}
+
+	OACC_INLINE bool empty() const noexcept {
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+};
@@ -0,0 +1,784 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_plan.hpp"
+#include "kernels.hpp"
+#include "weight_format.hpp"
+#include "errors.hpp"
+#include "startup_profile.hpp"
+#include "collectives.hpp"
+#include "adapter_cache.hpp"
+#include "subsystem.hpp"
+#include <type_traits>
+#include <array>
+#include <vector>
+
+// Deterministic random-weight transformer (pre-norm, rotary attention with grouped KV heads, SwiGLU feed forward)
+// Dimensions come from model_shape_type, serving limits and arena sizes from model_config_type via memory_plan
+// Projection and output matrices are stored as the shape's weight_dtype, generated in f32 and quantized row by row
+// With expert_count > 1 the feed forward is a mixture of experts: a router picks expert_top_k experts per row, rows are grouped
+// per expert and each expert runs once over its group. Under expert_parallel_type::enabled a rank holds only its own experts
+// and the ranks of the group sum their partial outputs
+// With adapter_capacity > 0 every row may carry a low-rank adapter slot; rows are grouped by slot once per pass and each resident
+// adapter adds its query and value deltas to its rows, so sequences on different adapters share one decode step
+// Under vocab_parallel_type::enabled a rank holds only its shard of the output rows; sampling exchanges each rank's top
+// candidates per row, and only callers of prefill()/decode() gather full logits
+// A scoring configuration keeps KV for one sequence only and adds score(), which returns the logprobs of a prompt's own tokens
+// Produces meaningless tokens at realistic compute and memory cost so batching, KV and sampling can be load-tested without real weights
+template<typename config_type_new, typename shape_type_new> struct stand_in_model {
+	using config_type = config_type_new;
+	using shape_type  = shape_type_new;
+	using plan_type	  = memory_plan<config_type, shape_type>;
+	// Phase totals are always recorded; named steps with byte and page fault counts only under benchmark_type::enabled
+	using startup_type = std::conditional_t<config_type::benchmark, detailed_startup_profile, startup_profile>;
+	using weight_format_type  = weight_format<shape_type::weight_dtype>;
+	using weight_storage_type = typename weight_format_type::storage_type;
+
+	static constexpr uint64_t layer_count		   = shape_type::layer_count;
+	static constexpr uint64_t head_count		   = shape_type::head_count;
+	static constexpr uint64_t kv_head_count		   = shape_type::kv_head_count;
+	static constexpr uint64_t kv_group_size		   = shape_type::kv_group_size;
+	static constexpr uint64_t head_dim			   = shape_type::head_dim;
+	static constexpr uint64_t embedding_dim		   = shape_type::embedding_dim;
+	static constexpr uint64_t kv_dim			   = shape_type::kv_dim;
+	static constexpr uint64_t ffn_dim			   = shape_type::ffn_dim;
+	static constexpr uint64_t vocab_size		   = shape_type::vocab_size;
+	static constexpr uint64_t max_batch_size	   = config_type::max_batch_size;
+	static constexpr uint64_t max_context_length   = config_type::max_context_length;
+	static constexpr uint64_t prefill_chunk_length = plan_type::prefill_chunk_length;
+	static constexpr uint64_t activation_row_count = plan_type::activation_row_count;
+	static constexpr uint64_t kv_slot_count		   = plan_type::kv_slot_count;
+	static constexpr bool scoring				   = config_type::scoring;
+	static constexpr uint64_t expert_count		   = config_type::expert_count;
+	static constexpr uint64_t expert_top_k		   = config_type::expert_top_k;
+	static constexpr uint64_t local_expert_count   = config_type::local_expert_count;
+	static constexpr uint64_t first_local_expert   = config_type::first_local_expert;
+	static constexpr bool mixture_of_experts	   = expert_count > 1;
+	static constexpr uint64_t adapter_capacity	   = config_type::adapter_capacity;
+	static constexpr uint64_t adapter_rank		   = config_type::adapter_rank;
+	static constexpr bool adapters_enabled		   = adapter_capacity > 0;
+
+	using adapter_cache_type = adapter_cache<config_type, shape_type>;
+
+	// Row adapter slot for rows that run on the base weights only
+	static constexpr uint32_t no_adapter_slot{ adapter_cache_type::no_slot };
+
+	static constexpr uint64_t vocab_shard_count = config_type::vocab_shard_count;
+	static constexpr bool vocab_sharded		    = vocab_shard_count > 1;
+	// Shard ranges are fixed at compile time - rank r holds output rows [r * local_vocab_size, + local_token_count)
+	static constexpr uint64_t local_vocab_size	= plan_type::local_vocab_size;
+	static constexpr uint64_t first_local_token = vocab_sharded ? config_type::gpu_rank * local_vocab_size : 0;
+	static_assert(first_local_token < vocab_size, "stand_in_model: more vocab shards than output rows");
+	static constexpr uint64_t local_token_count = std::min(local_vocab_size, vocab_size - first_local_token);
+
+	// The rank group is only joined when experts or output rows are actually split across ranks
+	struct model_collectives : collectives<config_type, shape_type> {
+		static constexpr bool active{ config_type::expert_shard_count > 1 || vocab_sharded };
+	};
+
+	struct expert_weights {
+		weight_storage_type* gate{};
+		weight_storage_type* up{};
+		weight_storage_type* down{};
+	};
+
+	struct layer_weights {
+		float* attention_norm{};
+		weight_storage_type* query{};
+		weight_storage_type* key{};
+		weight_storage_type* value{};
+		weight_storage_type* attention_output{};
+		float* ffn_norm{};
+		float* router{};
+		std::array<expert_weights, local_expert_count> experts{};
+	};
+
+	// First member, so its clock starts before anything else of the instance is constructed
+	startup_type startup{};
+
+	memory_arena weight_arena{};
+	memory_arena kv_arena{};
+	memory_arena activation_arena{};
+
+	std::array<layer_weights, layer_count> layers{};
+	float* token_embedding{};
+	float* output_norm{};
+	weight_storage_type* output{};
+	float* rope_table{};
+
+	float* key_cache{};
+	float* value_cache{};
+
+	float* hidden{};
+	float* normed{};
+	float* query{};
+	float* key{};
+	float* value{};
+	float* attention{};
+	float* gate{};
+	float* up{};
+	float* scores{};
+	float* logits{};
+	logit_candidates* candidates{};
+	float* output_tile{};
+	uint32_t* row_slots{};
+	uint32_t* row_positions{};
+	uint64_t* gather_table{};
+	float* gemm_pack{};
+	float* router_logits{};
+	uint32_t* route_experts{};
+	float* route_weights{};
+	uint32_t* expert_offsets{};
+	uint32_t* grouped_routes{};
+	float* expert_input{};
+	float* expert_output{};
+	float* expert_sum{};
+	uint32_t* row_adapters{};
+	uint32_t* adapter_offsets{};
+	uint32_t* adapter_rows{};
+	float* adapter_scratch{};
+	float* shard_logits{};
+	float* gathered_logits{};
+	logit_candidate* local_candidates{};
+	logit_candidate* gathered_candidates{};
+	float* score_tile{};
+	logprob_accumulator* accumulators{};
+	logprob_accumulator* gathered_accumulators{};
+	float* prompt_logprobs{};
+	uint32_t* row_tokens{};
+	uint32_t* segment_offsets{};
+	float* sequence_hidden{};
+	[[no_unique_address]] lazy_subsystem<model_collectives> rank_group{};
+	[[no_unique_address]] lazy_subsystem<adapter_cache_type> adapters{};
+
+	stand_in_model() {
+		uint64_t phase_start_ns{ startup.record(startup_phase::config_validation, startup.start_ns) };
+		reserve_arenas();
+		phase_start_ns = startup.record(startup_phase::arena_reservation, phase_start_ns);
+		initialize_weights();
+		phase_start_ns = startup.record(startup_phase::weight_mapping, phase_start_ns);
+		generate_tables();
+		startup.record(startup_phase::table_generation, phase_start_ns);
+		startup.mark_ready();
+	}
+
+	stand_in_model(const stand_in_model&)			 = delete;
+	stand_in_model& operator=(const stand_in_model&) = delete;
+
+	void reserve_arena(memory_arena& arena, std::string_view name, uint64_t bytes) {
+		const auto detail_start{ begin_startup_detail() };
+		arena = memory_arena{ bytes };
+		if constexpr (config_type::benchmark) {
+			startup.detail(startup_phase::arena_reservation, name, detail_start, bytes);
+		}
+	}
+
+	// Arena sizes are compile-time constants - a failed reservation is the only runtime failure mode here
+	void reserve_arenas() {
+		reserve_arena(weight_arena, "weights", plan_type::layout.weight_bytes);
+		if (!weight_arena.valid()) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model: failed to reserve arenas");
+		}
+		// Allocation order must match compute_weight_bytes
+		for (auto& layer: layers) {
+			layer.attention_norm   = weight_arena.allocate<float>(embedding_dim);
+			layer.query			   = allocate_matrix<embedding_dim, embedding_dim>();
+			layer.key			   = allocate_matrix<kv_dim, embedding_dim>();
+			layer.value			   = allocate_matrix<kv_dim, embedding_dim>();
+			layer.attention_output = allocate_matrix<embedding_dim, embedding_dim>();
+			layer.ffn_norm		   = weight_arena.allocate<float>(embedding_dim);
+			if constexpr (mixture_of_experts) {
+				layer.router = weight_arena.allocate<float>(expert_count * embedding_dim);
+			}
+			for (expert_weights& expert: layer.experts) {
+				expert.gate = allocate_matrix<ffn_dim, embedding_dim>();
+				expert.up	= allocate_matrix<ffn_dim, embedding_dim>();
+				expert.down = allocate_matrix<embedding_dim, ffn_dim>();
+			}
+		}
+		token_embedding = weight_arena.allocate<float>(vocab_size * embedding_dim);
+		output_norm		= weight_arena.allocate<float>(embedding_dim);
+		output			= allocate_matrix<local_vocab_size, embedding_dim>();
+		rope_table		= weight_arena.allocate<float>(max_context_length * head_dim);
+		reserve_worker_arenas();
+	}
+
+	template<uint64_t rows, uint64_t cols> weight_storage_type* allocate_matrix() noexcept {
+		return weight_arena.allocate<weight_storage_type>(rows * weight_format_type::template row_stride<cols>);
+	}
+
+	// KV cache, activations and resident adapters - the only arenas written after construction, so a forked worker replaces
+	// them with its own while the weight arena stays shared with the process it was forked from
+	void reserve_worker_arenas() {
+		adapters.reset();
+		reserve_arena(kv_arena, "kv_cache", plan_type::layout.kv_cache_bytes);
+		reserve_arena(activation_arena, "activations", plan_type::layout.activation_bytes);
+		if (!kv_arena.valid() || !activation_arena.valid()) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model: failed to reserve arenas");
+		}
+		key_cache	= kv_arena.allocate<float>(kv_slot_count * layer_count * max_context_length * kv_dim);
+		value_cache = kv_arena.allocate<float>(kv_slot_count * layer_count * max_context_length * kv_dim);
+
+		hidden		  = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+		normed		  = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+		query		  = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+		attention	  = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+		key			  = activation_arena.allocate<float>(activation_row_count * kv_dim);
+		value		  = activation_arena.allocate<float>(activation_row_count * kv_dim);
+		gate		  = activation_arena.allocate<float>(activation_row_count * ffn_dim);
+		up			  = activation_arena.allocate<float>(activation_row_count * ffn_dim);
+		scores		  = activation_arena.allocate<float>(max_context_length);
+		logits		  = activation_arena.allocate<float>(max_batch_size * vocab_size);
+		candidates	  = activation_arena.allocate<logit_candidates>(max_batch_size);
+		output_tile	  = activation_arena.allocate<float>(output_tile_row_count * max_batch_size);
+		row_slots	  = activation_arena.allocate<uint32_t>(activation_row_count);
+		row_positions = activation_arena.allocate<uint32_t>(activation_row_count);
+		gather_table  = activation_arena.allocate<uint64_t>(gather_table_capacity(activation_row_count));
+		gemm_pack	  = activation_arena.allocate<float>(compute_gemm_pack_bytes(plan_type::shape, plan_type::limits) / sizeof(float));
+		if constexpr (mixture_of_experts) {
+			router_logits  = activation_arena.allocate<float>(activation_row_count * expert_count);
+			route_experts  = activation_arena.allocate<uint32_t>(activation_row_count * expert_top_k);
+			route_weights  = activation_arena.allocate<float>(activation_row_count * expert_top_k);
+			expert_offsets = activation_arena.allocate<uint32_t>(expert_count + 1);
+			grouped_routes = activation_arena.allocate<uint32_t>(activation_row_count * expert_top_k);
+			expert_input   = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+			expert_output  = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+			expert_sum	   = activation_arena.allocate<float>(activation_row_count * embedding_dim);
+		}
+		if constexpr (adapters_enabled) {
+			row_adapters	= activation_arena.allocate<uint32_t>(activation_row_count);
+			adapter_offsets = activation_arena.allocate<uint32_t>(adapter_capacity + 1);
+			adapter_rows	= activation_arena.allocate<uint32_t>(activation_row_count);
+			adapter_scratch = activation_arena.allocate<float>(activation_row_count * adapter_rank);
+		}
+		if constexpr (vocab_sharded) {
+			shard_logits		= activation_arena.allocate<float>(max_batch_size * local_vocab_size);
+			gathered_logits		= activation_arena.allocate<float>(vocab_shard_count * max_batch_size * local_vocab_size);
+			local_candidates	= activation_arena.allocate<logit_candidate>(max_batch_size * max_sample_top_k);
+			gathered_candidates = activation_arena.allocate<logit_candidate>(vocab_shard_count * max_batch_size * max_sample_top_k);
+		}
+		row_tokens		= activation_arena.allocate<uint32_t>(activation_row_count);
+		segment_offsets = activation_arena.allocate<uint32_t>(activation_row_count + 1);
+		sequence_hidden = activation_arena.allocate<float>(max_batch_size * embedding_dim);
+		if constexpr (scoring) {
+			score_tile	 = activation_arena.allocate<float>(output_tile_row_count * activation_row_count);
+			accumulators = activation_arena.allocate<logprob_accumulator>(activation_row_count);
+			if constexpr (vocab_sharded) {
+				gathered_accumulators = activation_arena.allocate<logprob_accumulator>(vocab_shard_count * activation_row_count);
+			}
+			prompt_logprobs = activation_arena.allocate<float>(config_type::max_prompt_length);
+		}
+	}
+
+	// Uniform weights scaled by 1 / sqrt(fan_in) keep activations bounded through any number of layers
+	// Matrices are generated one f32 row at a time in the same order for every weight_dtype, so all formats quantize the same weights
+	// Experts of a mixture draw from their own generator, seeded by layer and global expert index, so a rank holding a subset of the
+	// experts generates exactly the weights an unsharded instance has for them
+	void initialize_weights() {
+		random_generator generator{ shape_type::weight_seed };
+		const auto fill = [](random_generator& source, float* values, uint64_t rows, uint64_t cols) {
+			const float scale{ 1.0f / std::sqrt(static_cast<float>(cols)) };
+			for (uint64_t index = 0; index < rows * cols; ++index) {
+				values[index] = (source.next_float() * 2.0f - 1.0f) * scale;
+			}
+		};
+		std::vector<float> row_values(std::max(embedding_dim, ffn_dim));
+		const auto fill_matrix = [&]<uint64_t rows, uint64_t cols>(weight_storage_type* values, random_generator& source) {
+			for (uint64_t row = 0; row < rows; ++row) {
+				fill(source, row_values.data(), 1, cols);
+				weight_format_type::template quantize<cols>(values + row * weight_format_type::template row_stride<cols>, row_values.data());
+			}
+		};
+		const auto fill_ones = [](float* values, uint64_t count) {
+			std::fill(values, values + count, 1.0f);
+		};
+		const auto detail = [&](std::string_view name, const auto& detail_start, uint64_t bytes) {
+			if constexpr (config_type::benchmark) {
+				startup.detail(startup_phase::weight_mapping, name, detail_start, bytes);
+			}
+		};
+		auto detail_start{ begin_startup_detail() };
+		for (uint64_t layer_index = 0; layer_index < layer_count; ++layer_index) {
+			layer_weights& layer{ layers[layer_index] };
+			fill_ones(layer.attention_norm, embedding_dim);
+			fill_matrix.template operator()<embedding_dim, embedding_dim>(layer.query, generator);
+			fill_matrix.template operator()<kv_dim, embedding_dim>(layer.key, generator);
+			fill_matrix.template operator()<kv_dim, embedding_dim>(layer.value, generator);
+			fill_matrix.template operator()<embedding_dim, embedding_dim>(layer.attention_output, generator);
+			fill_ones(layer.ffn_norm, embedding_dim);
+			if constexpr (mixture_of_experts) {
+				fill(generator, layer.router, expert_count, embedding_dim);
+			}
+			for (uint64_t local_expert = 0; local_expert < local_expert_count; ++local_expert) {
+				random_generator expert_generator{ fingerprint_values(shape_type::weight_seed, layer_index, first_local_expert + local_expert) };
+				random_generator& source{ mixture_of_experts ? expert_generator : generator };
+				const expert_weights& expert{ layer.experts[local_expert] };
+				fill_matrix.template operator()<ffn_dim, embedding_dim>(expert.gate, source);
+				fill_matrix.template operator()<ffn_dim, embedding_dim>(expert.up, source);
+				fill_matrix.template operator()<embedding_dim, ffn_dim>(expert.down, source);
+			}
+		}
+		detail("layers", detail_start, layer_count * compute_layer_weight_bytes(plan_type::shape, plan_type::limits));
+		detail_start = begin_startup_detail();
+		fill(generator, token_embedding, vocab_size * embedding_dim, 1);
+		detail("token_embedding", detail_start, vocab_size * embedding_dim * sizeof(float));
+		detail_start = begin_startup_detail();
+		fill_ones(output_norm, embedding_dim);
+		// Every output row is drawn so a vocab shard keeps exactly the rows an unsharded instance has in its range
+		for (uint64_t row = 0; row < vocab_size; ++row) {
+			fill(generator, row_values.data(), 1, embedding_dim);
+			if (row - first_local_token < local_token_count) {
+				weight_format_type::template quantize<embedding_dim>(output + (row - first_local_token) * weight_format_type::template row_stride<embedding_dim>,
+					row_values.data());
+			}
+		}
+		detail("output", detail_start, compute_matrix_bytes(plan_type::shape, local_vocab_size, embedding_dim) + embedding_dim * sizeof(float));
+	}
+
+	void generate_tables() {
+		const auto detail_start{ begin_startup_detail() };
+		for (uint64_t position = 0; position < max_context_length; ++position) {
+			generate_rope_row<head_dim>(rope_table + position * head_dim, position);
+		}
+		if constexpr (config_type::benchmark) {
+			startup.detail(startup_phase::table_generation, "rope", detail_start, max_context_length * head_dim * sizeof(float));
+		}
+	}
+
+	// Reads the clock and fault counter only when details are kept
+	static auto begin_startup_detail() noexcept {
+		if constexpr (config_type::benchmark) {
+			return detailed_startup_profile::begin_detail();
+		} else {
+			return 0;
+		}
+	}
+
+	OACC_INLINE float* key_cache_row(uint64_t slot, uint64_t layer, uint64_t position) const noexcept {
+		return key_cache + ((slot * layer_count + layer) * max_context_length + position) * kv_dim;
+	}
+
+	OACC_INLINE float* value_cache_row(uint64_t slot, uint64_t layer, uint64_t position) const noexcept {
+		return value_cache + ((slot * layer_count + layer) * max_context_length + position) * kv_dim;
+	}
+
+	// Copies the KV of positions [0, length) of source_slot into target_slot, layer by layer
+	void copy_kv_prefix(uint64_t target_slot, uint64_t source_slot, uint64_t length) noexcept {
+		for (uint64_t layer_index = 0; layer_index < layer_count; ++layer_index) {
+			std::copy_n(key_cache_row(source_slot, layer_index, 0), length * kv_dim, key_cache_row(target_slot, layer_index, 0));
+			std::copy_n(value_cache_row(source_slot, layer_index, 0), length * kv_dim, value_cache_row(target_slot, layer_index, 0));
+		}
+	}
+
+	// Commits the KV pages of positions [0, position_count) of slots [0, slot_count) instead of on first touch
+	void prefault_kv(uint64_t slot_count, uint64_t position_count) const noexcept {
+		const uint64_t row_bytes{ position_count * kv_dim * sizeof(float) };
+		for (uint64_t slot = 0; slot < slot_count; ++slot) {
+			for (uint64_t layer_index = 0; layer_index < layer_count; ++layer_index) {
+				for (const float* row: { key_cache_row(slot, layer_index, 0), value_cache_row(slot, layer_index, 0) }) {
+					const uint64_t offset{ static_cast<uint64_t>(reinterpret_cast<const uint8_t*>(row) - kv_arena.begin()) };
+					kv_arena.prefault(offset, offset + row_bytes);
+				}
+			}
+		}
+	}
+
+	// Runs token_count rows through every layer - row r is token tokens[r] of slot row_slots[r] at position row_positions[r]
+	// The rows form segment_count segments, segment s being rows [offsets[s], offsets[s + 1]): consecutive positions of one
+	// sequence. Norms and projections are per row, so segments only matter to attention, which runs segment by segment
+	// K and V of every row are cached before attention runs, so rows of the same sequence in one pass attend to each other causally
+	void forward(const uint32_t* tokens, uint64_t token_count, const uint32_t* offsets, uint64_t segment_count) noexcept {
+		gather_rows_dedup<embedding_dim>(hidden, token_embedding, tokens, token_count, gather_table);
+		if constexpr (adapters_enabled) {
+			group_routes_by_expert<adapter_capacity>(row_adapters, token_count, 0, adapter_offsets, adapter_rows);
+		}
+		for (uint64_t layer_index = 0; layer_index < layer_count; ++layer_index) {
+			const layer_weights& layer{ layers[layer_index] };
+			rms_norm<embedding_dim>(normed, hidden, layer.attention_norm, token_count);
+			matmul<embedding_dim, embedding_dim, activation_row_count, weight_format_type>(query, layer.query, normed, token_count, gemm_pack);
+			matmul<kv_dim, embedding_dim, activation_row_count, weight_format_type>(key, layer.key, normed, token_count, gemm_pack);
+			matmul<kv_dim, embedding_dim, activation_row_count, weight_format_type>(value, layer.value, normed, token_count, gemm_pack);
+			if constexpr (adapters_enabled) {
+				apply_adapters(layer_index);
+			}
+			for (uint64_t row = 0; row < token_count; ++row) {
+				const float* table_row{ rope_table + static_cast<uint64_t>(row_positions[row]) * head_dim };
+				apply_rope<head_dim>(query + row * embedding_dim, table_row, head_count);
+				apply_rope<head_dim>(key + row * kv_dim, table_row, kv_head_count);
+				std::copy_n(key + row * kv_dim, kv_dim, key_cache_row(row_slots[row], layer_index, row_positions[row]));
+				std::copy_n(value + row * kv_dim, kv_dim, value_cache_row(row_slots[row], layer_index, row_positions[row]));
+			}
+			for (uint64_t segment = 0; segment < segment_count; ++segment) {
+				const uint64_t first_row{ offsets[segment] };
+				const uint64_t row_count{ offsets[segment + 1] - first_row };
+				const float* keys{ key_cache_row(row_slots[first_row], layer_index, 0) };
+				const float* values{ value_cache_row(row_slots[first_row], layer_index, 0) };
+				for (uint64_t kv_head = 0; kv_head < kv_head_count; ++kv_head) {
+					const uint64_t head_offset{ first_row * embedding_dim + kv_head * kv_group_size * head_dim };
+					attention_segment<head_dim, kv_group_size>(attention + head_offset, query + head_offset, embedding_dim, keys + kv_head * head_dim,
+						values + kv_head * head_dim, kv_dim, row_positions[first_row], row_count, scores);
+				}
+			}
+			matmul<embedding_dim, embedding_dim, activation_row_count, weight_format_type>(normed, layer.attention_output, attention, token_count, gemm_pack);
+			add_in_place(hidden, normed, token_count * embedding_dim);
+			rms_norm<embedding_dim>(normed, hidden, layer.ffn_norm, token_count);
+			if constexpr (mixture_of_experts) {
+				feed_forward_experts(layer, token_count);
+				add_in_place(hidden, expert_sum, token_count * embedding_dim);
+			} else {
+				feed_forward(layer.experts[0], normed, normed, token_count);
+				add_in_place(hidden, normed, token_count * embedding_dim);
+			}
+		}
+	}
+
+	// Segmented low-rank update of the query and value projections - one segment per resident adapter with rows in this pass
+	void apply_adapters(uint64_t layer_index) noexcept {
+		for (uint32_t slot = 0; slot < adapter_capacity; ++slot) {
+			const uint64_t row_count{ adapter_offsets[slot + 1] - adapter_offsets[slot] };
+			if (row_count == 0) {
+				continue;
+			}
+			const uint32_t* rows{ adapter_rows + adapter_offsets[slot] };
+			const auto& adapter{ adapters.get().layer(slot, layer_index) };
+			lora_segment<embedding_dim, embedding_dim, adapter_rank>(query, normed, adapter.query_down, adapter.query_up, rows, row_count, adapter_scratch);
+			lora_segment<kv_dim, embedding_dim, adapter_rank>(value, normed, adapter.value_down, adapter.value_up, rows, row_count, adapter_scratch);
+		}
+	}
+
+	// SwiGLU feed forward of one expert over token_count rows of in - writes out, which may be in
+	OACC_INLINE void feed_forward(const expert_weights& expert, float* out, const float* in, uint64_t token_count) noexcept {
+		matmul<ffn_dim, embedding_dim, activation_row_count, weight_format_type>(gate, expert.gate, in, token_count, gemm_pack);
+		matmul<ffn_dim, embedding_dim, activation_row_count, weight_format_type>(up, expert.up, in, token_count, gemm_pack);
+		silu_mul(gate, up, token_count * ffn_dim);
+		matmul<embedding_dim, ffn_dim, activation_row_count, weight_format_type>(out, expert.down, gate, token_count, gemm_pack);
+	}
+
+	// Routes every row of normed to its expert_top_k experts and leaves the weighted sum of their outputs in expert_sum
+	// Routes are grouped per local expert by a counting sort, so each expert gathers its rows and runs one batched matmul over them
+	void feed_forward_experts(const layer_weights& layer, uint64_t token_count) {
+		gemv<expert_count, embedding_dim>(router_logits, layer.router, normed, token_count);
+		for (uint64_t row = 0; row < token_count; ++row) {
+			gating_top_k<expert_count, expert_top_k>(router_logits + row * expert_count, route_experts + row * expert_top_k, route_weights + row * expert_top_k);
+		}
+		group_routes_by_expert<local_expert_count>(route_experts, token_count * expert_top_k, first_local_expert, expert_offsets, grouped_routes);
+		std::fill_n(expert_sum, token_count * embedding_dim, 0.0f);
+		for (uint64_t local_expert = 0; local_expert < local_expert_count; ++local_expert) {
+			const uint32_t* routes{ grouped_routes + expert_offsets[local_expert] };
+			const uint64_t route_count{ expert_offsets[local_expert + 1] - expert_offsets[local_expert] };
+			if (route_count == 0) {
+				continue;
+			}
+			for (uint64_t index = 0; index < route_count; ++index) {
+				copy_row<embedding_dim>(expert_input + index * embedding_dim, normed + routes[index] / expert_top_k * embedding_dim);
+			}
+			feed_forward(layer.experts[local_expert], expert_output, expert_input, route_count);
+			for (uint64_t index = 0; index < route_count; ++index) {
+				const float weight{ route_weights[routes[index]] };
+				const float* expert_row{ expert_output + index * embedding_dim };
+				float* sum_row{ expert_sum + routes[index] / expert_top_k * embedding_dim };
+				for (uint64_t column = 0; column < embedding_dim; ++column) {
+					sum_row[column] += weight * expert_row[column];
+				}
+			}
+		}
+		if constexpr (config_type::expert_shard_count > 1) {
+			rank_group.get().all_reduce_sum(expert_sum, token_count * embedding_dim);
+		}
+	}
+
+	// Final norm of the selected rows - normed[index] for rows[index]
+	OACC_INLINE void normalize_output_rows(const uint32_t* rows, uint64_t row_count) noexcept {
+		for (uint64_t index = 0; index < row_count; ++index) {
+			rms_norm<embedding_dim>(normed + index * embedding_dim, hidden + static_cast<uint64_t>(rows[index]) * embedding_dim, output_norm, 1);
+		}
+	}
+
+	// Final norm and LM head for the selected rows only - writes logits[index] for rows[index]
+	// A vocab shard computes its own rows and all-gathers every rank's, then lays them out as full rows
+	void compute_logits(const uint32_t* rows, uint64_t row_count) noexcept {
+		normalize_output_rows(rows, row_count);
+		if constexpr (vocab_sharded) {
+			matmul<local_token_count, embedding_dim, activation_row_count, weight_format_type>(shard_logits, output, normed, row_count, gemm_pack);
+			rank_group.get().all_gather(shard_logits, row_count * local_vocab_size, gathered_logits);
+			for (uint64_t shard = 0; shard < vocab_shard_count; ++shard) {
+				const uint64_t first_token{ shard * local_vocab_size };
+				const uint64_t token_count{ std::min(local_vocab_size, vocab_size - first_token) };
+				const float* shard_rows{ gathered_logits + shard * row_count * local_vocab_size };
+				for (uint64_t index = 0; index < row_count; ++index) {
+					std::copy_n(shard_rows + index * token_count, token_count, logits + index * vocab_size + first_token);
+				}
+			}
+		} else {
+			matmul<vocab_size, embedding_dim, activation_row_count, weight_format_type>(logits, output, normed, row_count, gemm_pack);
+		}
+	}
+
+	// Final norm and LM head fused with sampling candidate selection - candidates[index] for rows[index] holds the top
+	// sample_candidate_count(sampling[index]) logits, and the logits buffer is not written
+	// Row counts that take the gemm path still materialize their logits and select from them, with the same result
+	void compute_candidates(const uint32_t* rows, const sampling_params* sampling, uint64_t row_count) noexcept {
+		normalize_output_rows(rows, row_count);
+		for (uint64_t index = 0; index < row_count; ++index) {
+			candidates[index].reset(sample_candidate_count(sampling[index]));
+		}
+		if (row_count < gemm_min_token_count) {
+			gemv_top_k<local_token_count, embedding_dim, weight_format_type>(candidates, output, normed, row_count, output_tile, first_local_token);
+		} else {
+			matmul<local_token_count, embedding_dim, activation_row_count, weight_format_type>(logits, output, normed, row_count, gemm_pack);
+			for (uint64_t index = 0; index < row_count; ++index) {
+				candidates[index].push(logits + index * local_token_count, local_token_count, first_local_token);
+			}
+		}
+		if constexpr (vocab_sharded) {
+			merge_shard_candidates(row_count);
+		}
+	}
+
+	// Distributed top-k - every rank packs each row's local candidates into capacity entries, all-gathers them, and merges the
+	// shards in rank order. Shards are ascending token ranges and insert() keeps the earlier entry on ties, so every rank ends up
+	// with the candidates an unsharded head selects, for capacity x 8 bytes per row instead of a full row of logits
+	void merge_shard_candidates(uint64_t row_count) noexcept {
+		uint64_t entry_count{};
+		for (uint64_t index = 0; index < row_count; ++index) {
+			const logit_candidates& row_candidates{ candidates[index] };
+			for (uint64_t entry = 0; entry < row_candidates.capacity; ++entry) {
+				local_candidates[entry_count++] = entry < row_candidates.count ? logit_candidate{ row_candidates.values[entry], row_candidates.indices[entry] }
+																				: logit_candidate{ 0.0f, no_candidate_index };
+			}
+		}
+		rank_group.get().all_gather(local_candidates, entry_count, gathered_candidates);
+		uint64_t row_offset{};
+		for (uint64_t index = 0; index < row_count; ++index) {
+			logit_candidates& row_candidates{ candidates[index] };
+			const uint64_t capacity{ row_candidates.capacity };
+			row_candidates.reset(capacity);
+			for (uint64_t shard = 0; shard < vocab_shard_count; ++shard) {
+				const logit_candidate* shard_entries{ gathered_candidates + shard * entry_count + row_offset };
+				for (uint64_t entry = 0; entry < capacity && shard_entries[entry].index != no_candidate_index; ++entry) {
+					row_candidates.insert(shard_entries[entry].value, shard_entries[entry].index);
+				}
+			}
+			row_offset += capacity;
+		}
+	}
+
+	// Prefill token_count prompt tokens of one slot starting at start_position, in chunks of prefill_chunk_length
+	// adapter_slot is a slot of adapters, acquired by the caller, or no_adapter_slot for the base model
+	// Returns the logits of the last prompt token (vocab_size floats, valid until the next call)
+	const float* prefill(uint64_t slot, const uint32_t* tokens, uint64_t token_count, uint64_t start_position, uint32_t adapter_slot = no_adapter_slot) {
+		const uint32_t last_row{ prefill_hidden(slot, tokens, token_count, start_position, adapter_slot) };
+		compute_logits(&last_row, 1);
+		return logits;
+	}
+
+	// Same as prefill but returns the sampling candidates of the last prompt token instead of its logits (valid until the next call)
+	logit_candidates* prefill_top_k(uint64_t slot, const uint32_t* tokens, uint64_t token_count, uint64_t start_position, const sampling_params& sampling,
+		uint32_t adapter_slot = no_adapter_slot) {
+		const uint32_t last_row{ prefill_hidden(slot, tokens, token_count, start_position, adapter_slot) };
+		compute_candidates(&last_row, &sampling, 1);
+		return candidates;
+	}
+
+	// Packed prefill of sequence_count prompts with no padding - sequence s prefills the offsets[s + 1] - offsets[s] tokens at
+	// tokens[s] into slots[s] from start_positions[s], with adapter slot adapter_slots[s] if given. offsets are cumulative over
+	// the packed rows, so the batch is offsets[sequence_count] rows cut into passes of prefill_chunk_length: a pass carries the
+	// end of one sequence and the start of the next, and only the last pass can be short
+	// Returns the sampling candidates of every sequence's last token, selected with sampling[s] (valid until the next call)
+	logit_candidates* prefill_packed_top_k(const uint32_t* const* tokens, const uint32_t* offsets, const uint32_t* slots, const uint32_t* start_positions,
+		const sampling_params* sampling, uint64_t sequence_count, const uint32_t* adapter_slots = nullptr) {
+		if (sequence_count == 0 || sequence_count > max_batch_size) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model::prefill_packed: sequence count out of range");
+		}
+		for (uint64_t sequence = 0; sequence < sequence_count; ++sequence) {
+			const uint64_t token_count{ offsets[sequence + 1] - offsets[sequence] };
+			if (slots[sequence] >= kv_slot_count || token_count == 0 || start_positions[sequence] + token_count > max_context_length) {
+				raise_runtime_error<config_type::exceptions>("stand_in_model::prefill_packed: slot or sequence length out of range");
+			}
+			validate_tokens(tokens[sequence], token_count);
+		}
+		const uint64_t row_total{ offsets[sequence_count] };
+		uint64_t sequence{};
+		for (uint64_t pass_begin = 0; pass_begin < row_total; pass_begin += prefill_chunk_length) {
+			const uint64_t pass_length{ std::min(prefill_chunk_length, row_total - pass_begin) };
+			const uint64_t first_sequence{ sequence };
+			uint64_t segment_count{};
+			for (uint64_t row = 0; row < pass_length; ++row) {
+				const uint64_t packed_row{ pass_begin + row };
+				if (packed_row == offsets[sequence + 1]) {
+					++sequence;
+				}
+				if (row == 0 || packed_row == offsets[sequence]) {
+					segment_offsets[segment_count++] = static_cast<uint32_t>(row);
+				}
+				const uint64_t index{ packed_row - offsets[sequence] };
+				row_tokens[row]	   = tokens[sequence][index];
+				row_slots[row]	   = slots[sequence];
+				row_positions[row] = static_cast<uint32_t>(start_positions[sequence] + index);
+				if constexpr (adapters_enabled) {
+					row_adapters[row] = adapter_slots ? adapter_slots[sequence] : no_adapter_slot;
+				}
+			}
+			segment_offsets[segment_count] = static_cast<uint32_t>(pass_length);
+			forward(row_tokens, pass_length, segment_offsets, segment_count);
+			// Keeps the last hidden row of every sequence that ends in this pass - the next pass overwrites hidden
+			for (uint64_t ended = first_sequence; ended <= sequence; ++ended) {
+				if (offsets[ended + 1] > pass_begin && offsets[ended + 1] <= pass_begin + pass_length) {
+					copy_row<embedding_dim>(sequence_hidden + ended * embedding_dim, hidden + (offsets[ended + 1] - 1 - pass_begin) * embedding_dim);
+				}
+			}
+		}
+		std::copy_n(sequence_hidden, sequence_count * embedding_dim, hidden);
+		compute_candidates(decode_rows.data(), sampling, sequence_count);
+		return candidates;
+	}
+
+	// Runs the prompt through every layer - returns the row of hidden holding its last token
+	uint32_t prefill_hidden(uint64_t slot, const uint32_t* tokens, uint64_t token_count, uint64_t start_position, uint32_t adapter_slot) {
+		if (slot >= kv_slot_count || token_count == 0 || start_position + token_count > max_context_length) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model::prefill: slot or sequence length out of range");
+		}
+		validate_tokens(tokens, token_count);
+		uint64_t chunk_length{};
+		for (uint64_t offset = 0; offset < token_count; offset += chunk_length) {
+			chunk_length = std::min(prefill_chunk_length, token_count - offset);
+			for (uint64_t row = 0; row < chunk_length; ++row) {
+				row_slots[row]	   = static_cast<uint32_t>(slot);
+				row_positions[row] = static_cast<uint32_t>(start_position + offset + row);
+			}
+			if constexpr (adapters_enabled) {
+				std::fill_n(row_adapters, chunk_length, adapter_slot);
+			}
+			const uint32_t chunk_offsets[]{ 0, static_cast<uint32_t>(chunk_length) };
+			forward(tokens + offset, chunk_length, chunk_offsets, 1);
+		}
+		return static_cast<uint32_t>(chunk_length - 1);
+	}
+
+	// Scoring mode - prefills the prompt into KV slot 0 and returns token_count - 1 logprobs, entry i the log-probability of
+	// tokens[i + 1] given tokens[0, i] (valid until the next call). Each chunk's output head runs right after the chunk, over
+	// every row but the prompt's last, fused with the log-softmax so no chunk x vocab_size logits are written and nothing is sampled
+	const float* score(const uint32_t* tokens, uint64_t token_count, uint32_t adapter_slot = no_adapter_slot) {
+		static_assert(scoring, "stand_in_model::score: requires a scoring configuration (max_generation_length of zero)");
+		if (token_count == 0 || token_count > config_type::max_prompt_length) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model::score: prompt length out of range");
+		}
+		validate_tokens(tokens, token_count);
+		for (uint64_t offset = 0; offset < token_count; offset += prefill_chunk_length) {
+			const uint64_t chunk_length{ std::min(prefill_chunk_length, token_count - offset) };
+			for (uint64_t row = 0; row < chunk_length; ++row) {
+				row_slots[row]	   = 0;
+				row_positions[row] = static_cast<uint32_t>(offset + row);
+			}
+			if constexpr (adapters_enabled) {
+				std::fill_n(row_adapters, chunk_length, adapter_slot);
+			}
+			const uint32_t chunk_offsets[]{ 0, static_cast<uint32_t>(chunk_length) };
+			forward(tokens + offset, chunk_length, chunk_offsets, 1);
+			const uint64_t scored_count{ std::min(chunk_length, token_count - 1 - offset) };
+			if (scored_count > 0) {
+				compute_logprobs(tokens + offset + 1, scored_count, prompt_logprobs + offset);
+			}
+		}
+		return prompt_logprobs;
+	}
+
+	// Final norm and LM head of hidden rows [0, row_count) fused with the log-softmax of targets[row] - writes out[row]
+	// A vocab shard accumulates its own rows, then merges every rank's accumulators in rank order, 12 bytes per row
+	void compute_logprobs(const uint32_t* targets, uint64_t row_count, float* out) noexcept {
+		rms_norm<embedding_dim>(normed, hidden, output_norm, row_count);
+		for (uint64_t row = 0; row < row_count; ++row) {
+			accumulators[row].reset();
+		}
+		matmul_logprobs<local_token_count, embedding_dim, activation_row_count, weight_format_type>(accumulators, targets, output, normed, row_count, score_tile,
+			gemm_pack, first_local_token);
+		if constexpr (vocab_sharded) {
+			rank_group.get().all_gather(accumulators, row_count, gathered_accumulators);
+			for (uint64_t row = 0; row < row_count; ++row) {
+				accumulators[row] = gathered_accumulators[row];
+				for (uint64_t shard = 1; shard < vocab_shard_count; ++shard) {
+					accumulators[row].merge(gathered_accumulators[shard * row_count + row]);
+				}
+			}
+		}
+		for (uint64_t row = 0; row < row_count; ++row) {
+			out[row] = accumulators[row].logprob();
+		}
+	}
+
+	// One decode step - row r appends tokens[r] to slots[r] at positions[r], with adapter slot adapter_slots[r] if given
+	// Returns batch_size rows of vocab_size logits, valid until the next call
+	const float* decode(const uint32_t* slots, const uint32_t* tokens, const uint32_t* positions, uint64_t batch_size, const uint32_t* adapter_slots = nullptr) {
+		decode_hidden(slots, tokens, positions, batch_size, adapter_slots);
+		compute_logits(decode_rows.data(), batch_size);
+		return logits;
+	}
+
+	// Same as decode but returns the sampling candidates of every row, selected with sampling[r], instead of its logits
+	// For greedy and top-k decoding the batch_size x vocab_size logits are never written
+	logit_candidates* decode_top_k(const uint32_t* slots, const uint32_t* tokens, const uint32_t* positions, const sampling_params* sampling, uint64_t batch_size,
+		const uint32_t* adapter_slots = nullptr) {
+		decode_hidden(slots, tokens, positions, batch_size, adapter_slots);
+		compute_candidates(decode_rows.data(), sampling, batch_size);
+		return candidates;
+	}
+
+	void decode_hidden(const uint32_t* slots, const uint32_t* tokens, const uint32_t* positions, uint64_t batch_size, const uint32_t* adapter_slots) {
+		if (batch_size == 0 || batch_size > max_batch_size) {
+			raise_runtime_error<config_type::exceptions>("stand_in_model::decode: batch size out of range");
+		}
+		validate_tokens(tokens, batch_size);
+		for (uint64_t row = 0; row < batch_size; ++row) {
+			if (slots[row] >= kv_slot_count || positions[row] >= max_context_length) {
+				raise_runtime_error<config_type::exceptions>("stand_in_model::decode: slot or position out of range");
+			}
+			row_slots[row]	   = slots[row];
+			row_positions[row] = positions[row];
+			if constexpr (adapters_enabled) {
+				row_adapters[row] = adapter_slots ? adapter_slots[row] : no_adapter_slot;
+			}
+		}
+		forward(tokens, batch_size, decode_offsets.data(), batch_size);
+	}
+
+	// Decode rows map one to one onto hidden rows
+	static constexpr auto decode_rows{ [] {
+		std::array<uint32_t, max_batch_size> return_value{};
+		for (uint64_t row = 0; row < max_batch_size; ++row) {
+			return_value[row] = static_cast<uint32_t>(row);
+		}
+		return return_value;
+	}() };
+
+	// Every decode row is a segment of its own
+	static constexpr auto decode_offsets{ [] {
+		std::array<uint32_t, max_batch_size + 1> return_value{};
+		for (uint64_t row = 0; row <= max_batch_size; ++row) {
+			return_value[row] = static_cast<uint32_t>(row);
+		}
+		return return_value;
+	}() };
+
+	OACC_INLINE void validate_tokens(const uint32_t* tokens, uint64_t token_count) const {
+		for (uint64_t index = 0; index < token_count; ++index) {
+			if (tokens[index] >= vocab_size) {
+				raise_runtime_error<config_type::exceptions>("stand_in_model: token id out of vocabulary");
+			}
+		}
+	}
+};
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// stand_in_model_example.cpp
+
+#include "stand_in_model.hpp"
+#include <iostream>
+
+// Serving limits and architecture are both order-agnostic compile-time configurations
+static constexpr auto config = generate_model_config(max_batch_size_type{ 4 }, max_context_length_type{ 128 });
+static constexpr auto shape	 = generate_model_shape(vocab_size_type{ 512 }, layer_count_type{ 2 }, head_dim_type{ 32 }, kv_head_count_type{ 2 });
+
+using config_type = model_config_type<config>;
+using shape_type  = model_shape_type<shape>;
+
+// Prefills two sequences into separate slots, then decodes them together so both share every weight read
+int main() {
+	static stand_in_model<config_type, shape_type> model{};
+	std::cout << "parameters: " << shape_type::parameter_count << ", arena bytes: " << memory_plan<config_type, shape_type>::layout.total_bytes() << std::endl;
+	std::cout << "startup: " << model.startup.to_json();
+
+	constexpr uint64_t sequence_count{ 2 };
+	constexpr uint64_t generation_length{ 8 };
+	const uint32_t prompts[sequence_count][4]{ { 1, 2, 3, 4 }, { 7, 11, 13, 17 } };
+
+	uint32_t slots[sequence_count]{ 0, 1 };
+	uint32_t tokens[sequence_count]{};
+	uint32_t positions[sequence_count]{};
+	for (uint64_t sequence = 0; sequence < sequence_count; ++sequence) {
+		const float* logits{ model.prefill(slots[sequence], prompts[sequence], 4, 0) };
+		tokens[sequence]	= argmax(logits, shape_type::vocab_size);
+		positions[sequence] = 4;
+	}
+
+	random_generator generator{ 42 };
+	const sampling_params params{ 0.8f, 16 };
+	for (uint64_t step = 0; step < generation_length; ++step) {
+		const float* logits{ model.decode(slots, tokens, positions, sequence_count) };
+		for (uint64_t sequence = 0; sequence < sequence_count; ++sequence) {
+			std::cout << "slot " << slots[sequence] << " token " << tokens[sequence] << (sequence + 1 == sequence_count ? "\n" : ", ");
+			tokens[sequence] = sample_top_k(logits + sequence * shape_type::vocab_size, shape_type::vocab_size, params, generator);
+			++positions[sequence];
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "request_timeline.hpp"
+#include "json_writer.hpp"
+#include <string_view>
+#include <vector>
+#if !defined(_WIN32)
+	#include <sys/resource.h>
+#endif
+
+// Startup phases in the order a model instance goes through them
+// config_validation is done by static_asserts in model_config_type and model_shape_type, so it costs nothing at runtime;
+// it stays in the report so startup numbers line up with servers that parse their configuration at runtime
+enum class startup_phase : uint8_t {
+	config_validation,
+	arena_reservation,
+	weight_mapping,
+	tokenizer_load,
+	table_generation,
+	warmup,
+};
+
+inline constexpr uint64_t startup_phase_count{ 6 };
+
+inline constexpr std::string_view startup_phase_names[startup_phase_count]{ "config_validation", "arena_reservation", "weight_mapping", "tokenizer_load",
+	"table_generation", "warmup" };
+
+// Minor page faults of the whole process so far - 0 where getrusage is unavailable
+inline uint64_t minor_page_faults() noexcept {
+#if !defined(_WIN32)
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<uint64_t>(usage.ru_minflt);
+#else
+	return 0;
+#endif
+}
+
+// Always on - one clock read per phase boundary and a fixed array, no allocation
+// Phases accumulate, so a phase split across several calls (or repeated by a later subsystem) is summed
+struct startup_profile {
+	uint64_t start_ns{ monotonic_nanoseconds() };
+	uint64_t ready_ns{};
+	std::array<uint64_t, startup_phase_count> phase_ns{};
+
+	// Adds now - phase_start_ns to phase and returns now, so consecutive phases can chain their start times
+	OACC_INLINE uint64_t record(startup_phase phase, uint64_t phase_start_ns) noexcept {
+		const uint64_t now_ns{ monotonic_nanoseconds() };
+		phase_ns[static_cast<uint64_t>(phase)] += now_ns - phase_start_ns;
+		return now_ns;
+	}
+
+	OACC_INLINE void mark_ready() noexcept {
+		ready_ns = monotonic_nanoseconds();
+	}
+
+	OACC_INLINE uint64_t time_to_ready_ns() const noexcept {
+		return ready_ns - start_ns;
+	}
+
+	void write_phases(json_writer& writer) const {
+		writer.member("time_to_ready_us", time_to_ready_ns() / 1000);
+		writer.key("phases_us");
+		writer.begin_object();
+		for (uint64_t index = 0; index < startup_phase_count; ++index) {
+			writer.member(startup_phase_names[index], phase_ns[index] / 1000);
+		}
+		writer.end_object();
+	}
+
+	std::string to_json() const {
+		json_writer writer{};
+		writer.begin_object();
+		write_phases(writer);
+		writer.end_object();
+		writer.buffer += '\n';
+		return writer.buffer;
+	}
+};
+
+// One named step inside a phase - an arena, a weight group, a table
+struct startup_detail {
+	startup_phase phase{};
+	std::string_view name{};
+	uint64_t duration_ns{};
+	uint64_t bytes{};
+	uint64_t minor_faults{};
+};
+
+// benchmark_type::enabled variant - additionally keeps named steps with their byte counts and the page faults they caused
+// Callers bracket a step with begin_detail() and detail(), both only called under if constexpr (config_type::benchmark)
+struct detailed_startup_profile : startup_profile {
+	struct detail_start {
+		uint64_t start_ns{};
+		uint64_t minor_faults{};
+	};
+
+	std::vector<startup_detail> details{};
+
+	static detail_start begin_detail() noexcept {
+		return detail_start{ monotonic_nanoseconds(), minor_page_faults() };
+	}
+
+	void detail(startup_phase phase, std::string_view name, const detail_start& start, uint64_t bytes) {
+		details.emplace_back(startup_detail{ phase, name, monotonic_nanoseconds() - start.start_ns, bytes, minor_page_faults() - start.minor_faults });
+	}
+
+	std::string to_json() const {
+		json_writer writer{};
+		writer.begin_object();
+		write_phases(writer);
+		writer.key("details");
+		writer.begin_array();
+		for (const startup_detail& entry: details) {
+			writer.begin_object();
+			writer.member("phase", startup_phase_names[static_cast<uint64_t>(entry.phase)]);
+			writer.member("name", entry.name);
+			writer.member("duration_us", entry.duration_ns / 1000);
+			writer.member("bytes", entry.bytes);
+			writer.member("minor_faults", entry.minor_faults);
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+		writer.buffer += '\n';
+		return writer.buffer;
+	}
+};
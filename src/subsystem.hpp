@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <optional>
+#include <concepts>
+
+// Optional engine subsystems declare the model_config fields that activate them as static constexpr bool active,
+// computed from model_config_type - e.g. active = config_type::gpu_count > 1
+template<typename subsystem_type>
+concept config_gated_subsystem = std::same_as<std::remove_cvref_t<decltype(subsystem_type::active)>, bool> && std::default_initializable<subsystem_type>;
+
+// Inactive subsystems compile down to an empty member that [[no_unique_address]] makes free - nothing is reserved or constructed
+template<config_gated_subsystem subsystem_type, bool active = subsystem_type::active> struct lazy_subsystem {
+	static constexpr bool enabled{ false };
+
+	OACC_INLINE constexpr bool initialized() const noexcept {
+		return false;
+	}
+
+	OACC_INLINE constexpr void initialize() noexcept {
+	}
+
+	OACC_INLINE constexpr void reset() noexcept {
+	}
+};
+
+// Active subsystems are constructed in place on their first get(), so startup only pays for what a request actually uses
+// initialize() forces construction ahead of time, e.g. during warmup
+template<config_gated_subsystem subsystem_type> struct lazy_subsystem<subsystem_type, true> {
+	static constexpr bool enabled{ true };
+
+	std::optional<subsystem_type> instance{};
+
+	OACC_INLINE subsystem_type& get() {
+		if (!instance) [[unlikely]] {
+			instance.emplace();
+		}
+		return *instance;
+	}
+
+	OACC_INLINE bool initialized() const noexcept {
+		return instance.has_value();
+	}
+
+	OACC_INLINE void initialize() {
+		get();
+	}
+
+	// Destroys the instance, the next get() builds a fresh one
+	OACC_INLINE void reset() noexcept {
+		instance.reset();
+	}
+};
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "random.hpp"
+#include <string_view>
+#include <cstdint>
+#include <array>
+
+// Byte-level stand-in tokenizer - every byte becomes exactly one token, so token count equals byte count
+// The byte -> token table is a seeded permutation of the vocabulary, loaded once per engine like a real vocabulary file
+template<uint64_t vocab_size> struct byte_tokenizer {
+	std::array<uint32_t, 256> byte_to_token{};
+
+	// Upper bound on the tokens encode() produces for byte_count bytes
+	static constexpr uint64_t max_token_count(uint64_t byte_count) noexcept {
+		return byte_count;
+	}
+
+	void load(uint64_t seed) noexcept {
+		random_generator generator{ seed };
+		for (uint64_t byte = 0; byte < byte_to_token.size(); ++byte) {
+			byte_to_token[byte] = static_cast<uint32_t>(byte % vocab_size);
+		}
+		for (uint64_t byte = byte_to_token.size() - 1; byte > 0; --byte) {
+			std::swap(byte_to_token[byte], byte_to_token[generator.next_below(byte + 1)]);
+		}
+	}
+
+	// Writes at most capacity tokens and returns how many were written
+	OACC_INLINE uint64_t encode(std::string_view text, uint32_t* tokens, uint64_t capacity) const noexcept {
+		const uint64_t count{ text.size() < capacity ? text.size() : capacity };
+		for (uint64_t index = 0; index < count; ++index) {
+			tokens[index] = byte_to_token[static_cast<uint8_t>(text[index])];
+		}
+		return count;
+	}
+};
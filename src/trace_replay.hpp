@@ -0,0 +1,188 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "request_trace.hpp"
+#include "benchmark.hpp"
+#include "engine.hpp"
+#include <functional>
+#include <thread>
+#include <queue>
+
+// Open loop submits every request at its (scaled) traced arrival time regardless of how the engine keeps up
+// Closed loop ignores arrival times and keeps exactly concurrency requests outstanding
+enum class replay_mode {
+	open_loop,
+	closed_loop,
+};
+
+struct replay_options {
+	replay_mode mode{ replay_mode::open_loop };
+	limit_policy policy{ limit_policy::clamp };
+	// Multiplies every traced interval - 0.5 replays twice as fast
+	double time_scale{ 1.0 };
+	uint64_t concurrency{ 8 };
+	// Zero replays every record
+	uint64_t sample_count{};
+	uint64_t seed{ 1234 };
+};
+
+// Replays a trace against one engine instance and reports the same metrics as the sweep suite, plus admission counters
+// Prompt contents are not part of a trace - text is drawn from the seed so a replay is reproducible end to end
+// With benchmark_type::enabled on the target the report also carries the per-phase latency breakdown
+template<typename engine_type> benchmark_result replay_trace(engine_type& engine_instance, const std::vector<trace_record>& trace, const replay_options& options) {
+	using config_type = typename engine_type::config_type;
+	using shape_type  = typename engine_type::shape_type;
+	using time_point  = bench_clock::time_point;
+
+	struct replay_request {
+		std::string prompt{};
+		uint64_t generation_length{};
+		uint64_t cancel_delay_us{ no_cancellation };
+		time_point submit_time{};
+		time_point last_token_time{};
+		bool outstanding{};
+	};
+
+	const std::vector<trace_record> records{ sample_trace(trace, options.sample_count, options.seed) };
+	std::vector<replay_request> requests(records.size());
+	random_generator generator{ options.seed };
+	uint64_t rejected_count{};
+	uint64_t clamped_count{};
+	for (uint64_t index = 0; index < records.size(); ++index) {
+		const limit_outcome outcome{ apply_limit_policy<config_type>(records[index], options.policy) };
+		rejected_count += outcome.rejected;
+		clamped_count += outcome.clamped;
+		if (outcome.rejected) {
+			continue;
+		}
+		requests[index].prompt.resize(outcome.prompt_length);
+		for (char& character: requests[index].prompt) {
+			character = static_cast<char>(' ' + generator.next_below(95));
+		}
+		requests[index].generation_length = outcome.generation_length;
+		if (records[index].cancel_us != no_cancellation) {
+			requests[index].cancel_delay_us = records[index].cancel_us - std::min(records[index].cancel_us, records[index].arrival_us);
+		}
+	}
+
+	benchmark_result result{};
+	result.name		   = std::string{ "replay/" } + (options.mode == replay_mode::open_loop ? "open_loop" : "closed_loop");
+	result.fingerprint = fingerprint_values(config_type::fingerprint, shape_type::fingerprint);
+	benchmark_metric& throughput{ result.add_metric("tokens_per_second", "tokens/s", true) };
+	benchmark_metric& ttft{ result.add_metric("ttft_ms", "ms", false) };
+	benchmark_metric& itl{ result.add_metric("itl_ms", "ms", false) };
+	benchmark_metric& latency{ result.add_metric("e2e_ms", "ms", false) };
+	phase_metric_set phases{};
+	if constexpr (config_type::benchmark) {
+		phases.add_to(result);
+		engine_instance.phase_metrics.get().reset();
+	}
+
+	const auto scaled = [&](uint64_t microseconds) {
+		return std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double, std::micro>(static_cast<double>(microseconds) * options.time_scale));
+	};
+	using cancellation = std::pair<time_point, uint64_t>;
+	std::priority_queue<cancellation, std::vector<cancellation>, std::greater<cancellation>> cancellations{};
+
+	const time_point start{ bench_clock::now() };
+	uint64_t next_index{};
+	uint64_t outstanding_count{};
+	uint64_t completed_count{};
+	uint64_t cancelled_count{};
+	uint64_t token_count{};
+	const auto submit = [&](uint64_t index, time_point now) {
+		replay_request& request{ requests[index] };
+		if (engine_instance.submit(request_params{ index, nullptr, 0, request.generation_length, sampling_params{}, options.seed + index, request.prompt }) !=
+			request_status::accepted) {
+			++rejected_count;
+			return;
+		}
+		request.submit_time = now;
+		request.outstanding = true;
+		++outstanding_count;
+		if (request.cancel_delay_us != no_cancellation) {
+			const time_point cancel_time{ options.mode == replay_mode::open_loop ? start + scaled(records[index].arrival_us + request.cancel_delay_us) :
+																				   now + scaled(request.cancel_delay_us) };
+			cancellations.emplace(cancel_time, index);
+		}
+	};
+
+	while (true) {
+		time_point now{ bench_clock::now() };
+		while (next_index < records.size()) {
+			if (requests[next_index].prompt.empty()) {
+				++next_index;
+				continue;
+			}
+			const bool due{ options.mode == replay_mode::open_loop ? start + scaled(records[next_index].arrival_us) <= now : outstanding_count < options.concurrency };
+			if (!due) {
+				break;
+			}
+			submit(next_index++, now);
+		}
+		while (!cancellations.empty() && cancellations.top().first <= now) {
+			const uint64_t index{ cancellations.top().second };
+			cancellations.pop();
+			if (requests[index].outstanding && engine_instance.cancel(index)) {
+				requests[index].outstanding = false;
+				--outstanding_count;
+				++cancelled_count;
+			}
+		}
+		if (engine_instance.idle()) {
+			if (next_index == records.size()) {
+				break;
+			}
+			// Open loop with nothing in flight - sleep until the next arrival or cancellation rather than spinning
+			time_point wake_time{ start + scaled(records[next_index].arrival_us) };
+			if (!cancellations.empty()) {
+				wake_time = std::min(wake_time, cancellations.top().first);
+			}
+			std::this_thread::sleep_until(wake_time);
+			continue;
+		}
+		const std::span<const token_event> events{ engine_instance.step() };
+		now = bench_clock::now();
+		for (const token_event& event: events) {
+			replay_request& request{ requests[event.request_id] };
+			if (event.first) {
+				ttft.samples.emplace_back(elapsed_milliseconds(request.submit_time, now));
+			} else {
+				itl.samples.emplace_back(elapsed_milliseconds(request.last_token_time, now));
+			}
+			request.last_token_time = now;
+			if (event.finished) {
+				latency.samples.emplace_back(elapsed_milliseconds(request.submit_time, now));
+				request.outstanding = false;
+				--outstanding_count;
+				++completed_count;
+			}
+		}
+		token_count += events.size();
+		engine_instance.complete_streaming();
+	}
+	if constexpr (config_type::benchmark) {
+		phases.record(engine_instance.phase_metrics.get());
+	}
+	throughput.samples.emplace_back(static_cast<double>(token_count) / elapsed_seconds(start, bench_clock::now()));
+
+	result.parameters = { { "max_batch_size", config_type::max_batch_size }, { "max_context_length", config_type::max_context_length },
+		{ "trace_requests", records.size() }, { "completed", completed_count }, { "cancelled", cancelled_count }, { "rejected", rejected_count },
+		{ "clamped", clamped_count } };
+	return result;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "model_shape.hpp"
+#include "kernels.hpp"
+#include <bit>
+
+// Row formats for every weight_dtype_type - each one has the members of f32_rows, so gemv and the model are written once
+// Dequantization happens inside the dot product: a row is read from memory in its stored width and expanded in registers,
+// which is what makes narrower formats faster on memory-bound decode. The block formats also quantize each token's input
+// to int8 blocks once per call, so their inner loop is an int16 multiply-add that vectorizes on baseline SSE2
+
+OACC_INLINE float bf16_to_float(uint16_t value) noexcept {
+	return std::bit_cast<float>(static_cast<uint32_t>(value) << 16);
+}
+
+// Round to nearest even on the 16 dropped mantissa bits
+OACC_INLINE uint16_t float_to_bf16(float value) noexcept {
+	const uint32_t bits{ std::bit_cast<uint32_t>(value) };
+	return static_cast<uint16_t>((bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+}
+
+struct bf16_rows {
+	using storage_type = uint16_t;
+
+	template<uint64_t cols> using input_type = const float*;
+
+	static constexpr uint64_t columns_per_element{ 1 };
+
+	template<uint64_t cols> static constexpr uint64_t row_stride{ cols };
+
+	template<uint64_t cols> OACC_INLINE static void prepare_input(const float*& out, const float* in) noexcept {
+		out = in;
+	}
+
+	template<uint64_t cols> OACC_INLINE static float dot(const uint16_t* row, const float* in) noexcept {
+		float accumulators[accumulator_lane_count]{};
+		uint64_t index{};
+		for (; index + accumulator_lane_count <= cols; index += accumulator_lane_count) {
+			for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+				accumulators[lane] += bf16_to_float(row[index + lane]) * in[index + lane];
+			}
+		}
+		float return_value{};
+		for (uint64_t lane = 0; lane < accumulator_lane_count; ++lane) {
+			return_value += accumulators[lane];
+		}
+		for (; index < cols; ++index) {
+			return_value += bf16_to_float(row[index]) * in[index];
+		}
+		return return_value;
+	}
+
+	template<uint64_t cols> OACC_INLINE static void dequantize(float* out, const uint16_t* row) noexcept {
+		for (uint64_t index = 0; index < cols; ++index) {
+			out[index] = bf16_to_float(row[index]);
+		}
+	}
+
+	template<uint64_t cols> static void quantize(uint16_t* out, const float* in) noexcept {
+		for (uint64_t index = 0; index < cols; ++index) {
+			out[index] = float_to_bf16(in[index]);
+		}
+	}
+};
+
+template<uint64_t block_size> struct q8_block {
+	float scale{};
+	int8_t values[block_size]{};
+};
+
+template<uint64_t block_size> struct q4_block {
+	float scale{};
+	// Low nibbles hold values [0, block_size / 2), high nibbles [block_size / 2, block_size), each stored + 8
+	uint8_t values[block_size / 2]{};
+};
+
+// Largest magnitude of one block and the scale that maps it to max_level
+template<uint64_t block_size> OACC_INLINE float block_scale(const float* in, float max_level) noexcept {
+	float max_magnitude{};
+	for (uint64_t index = 0; index < block_size; ++index) {
+		max_magnitude = std::max(max_magnitude, std::fabs(in[index]));
+	}
+	return max_magnitude / max_level;
+}
+
+// One token's input quantized to symmetric int8 blocks aligned with the weight blocks - sums feed the q4 zero-point correction
+template<uint64_t cols, uint64_t block_size> struct block_input {
+	static constexpr uint64_t block_count{ cols / block_size };
+
+	alignas(64) int8_t values[cols];
+	float scales[block_count];
+	int32_t sums[block_count];
+};
+
+template<uint64_t cols, uint64_t block_size> OACC_INLINE void prepare_block_input(block_input<cols, block_size>& out, const float* in) noexcept {
+	for (uint64_t block = 0; block < cols / block_size; ++block) {
+		const float* block_in{ in + block * block_size };
+		const float scale{ block_scale<block_size>(block_in, 127.0f) };
+		const float inverse_scale{ scale > 0.0f ? 1.0f / scale : 0.0f };
+		int32_t sum{};
+		for (uint64_t index = 0; index < block_size; ++index) {
+			const int8_t value{ static_cast<int8_t>(std::lround(block_in[index] * inverse_scale)) };
+			out.values[block * block_size + index] = value;
+			sum += value;
+		}
+		out.scales[block] = scale;
+		out.sums[block]	  = sum;
+	}
+}
+
+// Symmetric 8-bit blocks - value = scale * int8
+template<uint64_t block_size> struct q8_rows {
+	using storage_type = q8_block<block_size>;
+
+	static constexpr uint64_t columns_per_element{ block_size };
+
+	template<uint64_t cols> static constexpr uint64_t row_stride{ cols / block_size };
+
+	template<uint64_t cols> using input_type = block_input<cols, block_size>;
+
+	template<uint64_t cols> OACC_INLINE static void prepare_input(input_type<cols>& out, const float* in) noexcept {
+		prepare_block_input<cols, block_size>(out, in);
+	}
+
+	// Each block is an exact int32 sum of int8 products, scaled once by both block scales
+	template<uint64_t cols> OACC_INLINE static float dot(const storage_type* row, const input_type<cols>& in) noexcept {
+		float return_value{};
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			const int8_t* block_in{ in.values + block * block_size };
+			int32_t block_sum{};
+			for (uint64_t index = 0; index < block_size; ++index) {
+				block_sum += static_cast<int16_t>(row[block].values[index]) * static_cast<int16_t>(block_in[index]);
+			}
+			return_value += row[block].scale * in.scales[block] * static_cast<float>(block_sum);
+		}
+		return return_value;
+	}
+
+	template<uint64_t cols> OACC_INLINE static void dequantize(float* out, const storage_type* row) noexcept {
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			for (uint64_t index = 0; index < block_size; ++index) {
+				out[block * block_size + index] = row[block].scale * static_cast<float>(row[block].values[index]);
+			}
+		}
+	}
+
+	template<uint64_t cols> static void quantize(storage_type* out, const float* in) noexcept {
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			const float* block_in{ in + block * block_size };
+			const float scale{ block_scale<block_size>(block_in, 127.0f) };
+			const float inverse_scale{ scale > 0.0f ? 1.0f / scale : 0.0f };
+			out[block].scale = scale;
+			for (uint64_t index = 0; index < block_size; ++index) {
+				out[block].values[index] = static_cast<int8_t>(std::lround(block_in[index] * inverse_scale));
+			}
+		}
+	}
+};
+
+// Symmetric 4-bit blocks - value = scale * (nibble - 8), levels -7 .. 7 so the scale is shared evenly by both signs
+template<uint64_t block_size> struct q4_rows {
+	using storage_type = q4_block<block_size>;
+
+	static constexpr uint64_t half_block_size{ block_size / 2 };
+
+	static constexpr uint64_t columns_per_element{ block_size };
+
+	template<uint64_t cols> static constexpr uint64_t row_stride{ cols / block_size };
+
+	template<uint64_t cols> using input_type = block_input<cols, block_size>;
+
+	template<uint64_t cols> OACC_INLINE static void prepare_input(input_type<cols>& out, const float* in) noexcept {
+		prepare_block_input<cols, block_size>(out, in);
+	}
+
+	// Low and high nibbles of one byte belong to the two halves of the block, so both unpack with the same index
+	// The nibbles are multiplied unbiased and the + 8 is removed once per block through the input's block sum
+	template<uint64_t cols> OACC_INLINE static float dot(const storage_type* row, const input_type<cols>& in) noexcept {
+		float return_value{};
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			const int8_t* block_in{ in.values + block * block_size };
+			int32_t block_sum{};
+			for (uint64_t index = 0; index < half_block_size; ++index) {
+				const uint8_t packed{ row[block].values[index] };
+				block_sum += static_cast<int16_t>(packed & 0x0f) * static_cast<int16_t>(block_in[index]) +
+					static_cast<int16_t>(packed >> 4) * static_cast<int16_t>(block_in[half_block_size + index]);
+			}
+			return_value += row[block].scale * in.scales[block] * static_cast<float>(block_sum - 8 * in.sums[block]);
+		}
+		return return_value;
+	}
+
+	template<uint64_t cols> OACC_INLINE static void dequantize(float* out, const storage_type* row) noexcept {
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			float* block_out{ out + block * block_size };
+			for (uint64_t index = 0; index < half_block_size; ++index) {
+				const uint8_t packed{ row[block].values[index] };
+				block_out[index]				   = row[block].scale * static_cast<float>(static_cast<int32_t>(packed & 0x0f) - 8);
+				block_out[half_block_size + index] = row[block].scale * static_cast<float>(static_cast<int32_t>(packed >> 4) - 8);
+			}
+		}
+	}
+
+	template<uint64_t cols> static void quantize(storage_type* out, const float* in) noexcept {
+		const auto level = [](float value) {
+			return static_cast<uint8_t>(std::clamp<long>(std::lround(value), -7, 7) + 8);
+		};
+		for (uint64_t block = 0; block < cols / block_size; ++block) {
+			const float* block_in{ in + block * block_size };
+			const float scale{ block_scale<block_size>(block_in, 7.0f) };
+			const float inverse_scale{ scale > 0.0f ? 1.0f / scale : 0.0f };
+			out[block].scale = scale;
+			for (uint64_t index = 0; index < half_block_size; ++index) {
+				out[block].values[index] = static_cast<uint8_t>(level(block_in[index] * inverse_scale) | level(block_in[half_block_size + index] * inverse_scale) << 4);
+			}
+		}
+	}
+};
+
+template<weight_dtype_type dtype> struct weight_format_selector {
+	using type = f32_rows;
+};
+
+template<> struct weight_format_selector<weight_dtype_type::bf16> {
+	using type = bf16_rows;
+};
+
+template<> struct weight_format_selector<weight_dtype_type::q8> {
+	using type = q8_rows<weight_block_size>;
+};
+
+template<> struct weight_format_selector<weight_dtype_type::q4> {
+	using type = q4_rows<weight_block_size>;
+};
+
+// Row format the kernels use for matrices stored as dtype
+template<weight_dtype_type dtype> using weight_format = typename weight_format_selector<dtype>::type;
+
+// The planner sizes weight arenas with weight_row_bytes - the storage types must match it exactly
+static_assert(sizeof(q8_block<weight_block_size>) == weight_row_bytes(weight_dtype_type::q8, weight_block_size));
+static_assert(sizeof(q4_block<weight_block_size>) == weight_row_bytes(weight_dtype_type::q4, weight_block_size));
+
+// ... and plans gemm packing with weight_dtype_block_size, which must be where the formats can split a row
+static_assert(weight_format<weight_dtype_type::bf16>::columns_per_element == weight_dtype_block_size(weight_dtype_type::bf16));
+static_assert(weight_format<weight_dtype_type::q8>::columns_per_element == weight_dtype_block_size(weight_dtype_type::q8));
+static_assert(weight_format<weight_dtype_type::q4>::columns_per_element == weight_dtype_block_size(weight_dtype_type::q4));
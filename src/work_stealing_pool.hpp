@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One unit of pool work - a function pointer and its arguments, so queuing a task never allocates
+struct pool_task {
+	void (*function)(void* context, uint64_t argument){};
+	void* context{};
+	uint64_t argument{};
+};
+
+// Fixed set of worker threads with one task deque each
+// push() from a worker appends to that worker's own deque, from any other thread to the deques in turn. A worker runs its own
+// tasks oldest first and, once its deque is empty, steals the newest task of another worker's deque. Idle workers sleep until
+// the next push, and tasks never spawn threads, so the pool never runs more threads than it was built with
+struct work_stealing_pool {
+	static constexpr uint64_t no_worker{ ~uint64_t{} };
+
+	struct worker_queue {
+		std::mutex mutex{};
+		std::deque<pool_task> tasks{};
+	};
+
+	std::vector<std::unique_ptr<worker_queue>> queues{};
+	std::vector<std::thread> threads{};
+	std::mutex sleep_mutex{};
+	std::condition_variable wake{};
+	std::atomic<uint64_t> queued_count{};
+	std::atomic<uint64_t> next_queue{};
+	std::atomic<uint64_t> executed_count{};
+	std::atomic<uint64_t> steal_count{};
+	bool stopping{};
+
+	explicit work_stealing_pool(uint64_t worker_count) {
+		worker_count = std::max<uint64_t>(worker_count, 1);
+		for (uint64_t index = 0; index < worker_count; ++index) {
+			queues.emplace_back(std::make_unique<worker_queue>());
+		}
+		for (uint64_t index = 0; index < worker_count; ++index) {
+			threads.emplace_back([this, index] {
+				run_worker(index);
+			});
+		}
+	}
+
+	work_stealing_pool(const work_stealing_pool&)			 = delete;
+	work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+	// Runs every queued task, then joins the workers
+	~work_stealing_pool() noexcept {
+		{
+			std::lock_guard lock{ sleep_mutex };
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& thread: threads) {
+			thread.join();
+		}
+	}
+
+	OACC_INLINE uint64_t worker_count() const noexcept {
+		return queues.size();
+	}
+
+	void push(pool_task task) {
+		const uint64_t worker{ current_worker() };
+		const uint64_t index{ worker != no_worker ? worker : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size() };
+		{
+			std::lock_guard lock{ queues[index]->mutex };
+			queues[index]->tasks.emplace_back(task);
+		}
+		queued_count.fetch_add(1, std::memory_order_release);
+		// Taking the sleep mutex orders this push against a worker that has just seen queued_count at zero and is about to wait
+		{
+			std::lock_guard lock{ sleep_mutex };
+		}
+		wake.notify_one();
+	}
+
+	// Pool and index of the worker running on this thread - set once by the worker itself
+	struct worker_binding {
+		const work_stealing_pool* pool{};
+		uint64_t index{ no_worker };
+	};
+
+	static worker_binding& current_binding() noexcept {
+		thread_local worker_binding binding{};
+		return binding;
+	}
+
+	OACC_INLINE uint64_t current_worker() const noexcept {
+		const worker_binding& binding{ current_binding() };
+		return binding.pool == this ? binding.index : no_worker;
+	}
+
+	bool take(uint64_t worker, pool_task& task) {
+		{
+			worker_queue& own{ *queues[worker] };
+			std::lock_guard lock{ own.mutex };
+			if (!own.tasks.empty()) {
+				task = own.tasks.front();
+				own.tasks.pop_front();
+				return true;
+			}
+		}
+		for (uint64_t offset = 1; offset < queues.size(); ++offset) {
+			worker_queue& victim{ *queues[(worker + offset) % queues.size()] };
+			std::lock_guard lock{ victim.mutex };
+			if (!victim.tasks.empty()) {
+				task = victim.tasks.back();
+				victim.tasks.pop_back();
+				steal_count.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void run_worker(uint64_t worker) {
+		current_binding() = worker_binding{ this, worker };
+		pool_task task{};
+		while (true) {
+			if (take(worker, task)) {
+				queued_count.fetch_sub(1, std::memory_order_acq_rel);
+				task.function(task.context, task.argument);
+				executed_count.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			std::unique_lock lock{ sleep_mutex };
+			wake.wait(lock, [&] {
+				return stopping || queued_count.load(std::memory_order_acquire) > 0;
+			});
+			if (stopping && queued_count.load(std::memory_order_acquire) == 0) {
+				return;
+			}
+		}
+	}
+};
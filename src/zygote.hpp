@@ -0,0 +1,246 @@
+/*
+ * Copyright 2026 Nihilai Collective Corp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "engine.hpp"
+#include <memory>
+#include <utility>
+#if !defined(_WIN32)
+	#include <cerrno>
+	#include <csignal>
+	#include <pthread.h>
+	#include <sys/types.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+// Spawn protocol between an engine_zygote and its zygote process - fixed-size records, each far below PIPE_BUF,
+// so replies written by different workers onto the same pipe never interleave
+// The zygote itself writes one reply, carrying its own pid, once its engine is built and before it reads any request
+struct zygote_spawn_request {
+	uint64_t fingerprint{};
+	uint64_t worker_id{};
+};
+
+struct zygote_spawn_reply {
+	int64_t pid{ -1 };
+	uint64_t ready_ns{};
+};
+
+// Why spawn() returned no worker - spawning is runtime input, so failures are reported rather than raised
+enum class zygote_status {
+	ready,
+	not_started,
+	fingerprint_mismatch,
+	spawn_failed,
+	unsupported,
+};
+
+// Forks engine workers from one pre-initialized process
+// start() forks the zygote, which builds a complete engine_type once (weights, tables, tokenizer), makes the weight arena
+// read-only and then waits for spawn requests; start() returns ready only once that engine exists. Every spawn() forks a worker from it, which calls engine::prepare_worker()
+// to take private KV, activation and prompt arenas and then runs worker_function. Weights and tables stay shared
+// copy-on-write between the zygote and all of its workers, so a worker costs one fork plus its own arenas
+// Requests are keyed by the configuration fingerprint - a zygote only forks workers for the configuration it was built with
+// The zygote is single-threaded by construction; call start() before the launching process creates threads of its own
+template<typename engine_type> struct engine_zygote {
+	using config_type = typename engine_type::config_type;
+	using shape_type  = typename engine_type::shape_type;
+
+	static constexpr uint64_t fingerprint{ fingerprint_values(config_type::fingerprint, shape_type::fingerprint) };
+
+	int64_t pid{ -1 };
+	int command_fd{ -1 };
+	int reply_fd{ -1 };
+
+	engine_zygote() noexcept = default;
+
+	engine_zygote(const engine_zygote&)			   = delete;
+	engine_zygote& operator=(const engine_zygote&) = delete;
+
+	~engine_zygote() noexcept {
+		stop();
+	}
+
+	// worker_function(engine_type&, uint64_t worker_id) runs in the worker once it is ready, its return value is the exit code
+	// The zygote's engine and every worker's are built with sizing - size it for the workers plus the zygote itself
+	// Blocks until the zygote has built its engine; spawn_failed if it died first, e.g. because engine_type's constructor failed
+	template<typename worker_function> zygote_status start(worker_function worker, const runtime_sizing& sizing = engine_type::declared_sizing) {
+#if defined(_WIN32)
+		static_cast<void>(worker);
+		static_cast<void>(sizing);
+		return zygote_status::unsupported;
+#else
+		int command_pipe[2]{};
+		int reply_pipe[2]{};
+		if (pipe(command_pipe) != 0) {
+			return zygote_status::spawn_failed;
+		}
+		if (pipe(reply_pipe) != 0) {
+			close_pair(command_pipe);
+			return zygote_status::spawn_failed;
+		}
+		const pid_t child{ fork() };
+		if (child < 0) {
+			close_pair(command_pipe);
+			close_pair(reply_pipe);
+			return zygote_status::spawn_failed;
+		}
+		if (child == 0) {
+			close(command_pipe[1]);
+			close(reply_pipe[0]);
+			serve(command_pipe[0], reply_pipe[1], worker, sizing);
+		}
+		close(command_pipe[0]);
+		close(reply_pipe[1]);
+		zygote_spawn_reply ready{};
+		if (!read_record(reply_pipe[0], ready) || ready.pid != static_cast<int64_t>(child)) {
+			close(command_pipe[1]);
+			close(reply_pipe[0]);
+			waitpid(child, nullptr, 0);
+			return zygote_status::spawn_failed;
+		}
+		pid		   = child;
+		command_fd = command_pipe[1];
+		reply_fd   = reply_pipe[0];
+		return zygote_status::ready;
+#endif
+	}
+
+	// Forks one worker and returns once it is ready to serve, or with the reason it is not
+	zygote_status spawn(uint64_t worker_id, zygote_spawn_reply& reply, uint64_t requested_fingerprint = fingerprint) {
+#if defined(_WIN32)
+		static_cast<void>(worker_id);
+		static_cast<void>(reply);
+		static_cast<void>(requested_fingerprint);
+		return zygote_status::unsupported;
+#else
+		if (pid < 0) {
+			return zygote_status::not_started;
+		}
+		if (requested_fingerprint != fingerprint) {
+			return zygote_status::fingerprint_mismatch;
+		}
+		const zygote_spawn_request request{ requested_fingerprint, worker_id };
+		if (!write_record(command_fd, request) || !read_record(reply_fd, reply) || reply.pid < 0) {
+			return zygote_status::spawn_failed;
+		}
+		return zygote_status::ready;
+#endif
+	}
+
+	// Closes the command pipe, which ends the zygote - workers already spawned keep running
+	void stop() noexcept {
+#if !defined(_WIN32)
+		if (pid < 0) {
+			return;
+		}
+		close(command_fd);
+		close(reply_fd);
+		waitpid(static_cast<pid_t>(pid), nullptr, 0);
+		pid		   = -1;
+		command_fd = -1;
+		reply_fd   = -1;
+#endif
+	}
+
+#if !defined(_WIN32)
+	static void close_pair(int (&fds)[2]) noexcept {
+		close(fds[0]);
+		close(fds[1]);
+	}
+
+	// A write to a pipe whose reader is gone fails with EPIPE instead of killing the caller - SIGPIPE is blocked around the
+	// write and the one it raised is discarded before the mask is restored, unless the caller already had it blocked
+	template<typename record_type> static bool write_record(int fd, const record_type& record) noexcept {
+		sigset_t pipe_signal{};
+		sigset_t previous_mask{};
+		sigemptyset(&pipe_signal);
+		sigaddset(&pipe_signal, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &pipe_signal, &previous_mask);
+		const ssize_t written{ write(fd, &record, sizeof(record)) };
+		if (written < 0 && errno == EPIPE && !sigismember(&previous_mask, SIGPIPE)) {
+			sigset_t pending{};
+			int signal_number{};
+			if (sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE)) {
+				sigwait(&pipe_signal, &signal_number);
+			}
+		}
+		pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+		return written == static_cast<ssize_t>(sizeof(record));
+	}
+
+	template<typename record_type> static bool read_record(int fd, record_type& record) noexcept {
+		return read(fd, &record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+	}
+
+	// Body of the zygote process - never returns
+	// Workers are reaped by the kernel (SIGCHLD ignored), so neither the zygote nor the launcher has to wait for them
+	// No exception leaves a forked child, it would unwind into the stack of whatever called start(): a zygote whose engine throws
+	// exits before its ready record, a worker whose prepare_worker() throws replies with a failed spawn first, and a worker_function
+	// that throws ends its worker with exit code 1
+	template<typename worker_function> [[noreturn]] static void serve(int command_fd_new, int reply_fd_new, worker_function& worker, const runtime_sizing& sizing) {
+		std::signal(SIGCHLD, SIG_IGN);
+		std::unique_ptr<engine_type> instance{};
+		try {
+			instance = std::make_unique<engine_type>(sizing);
+		} catch (...) {
+			_exit(1);
+		}
+		instance->model.weight_arena.protect_read_only();
+		if (!write_record(reply_fd_new, zygote_spawn_reply{ static_cast<int64_t>(getpid()), monotonic_nanoseconds() })) {
+			_exit(1);
+		}
+		zygote_spawn_request request{};
+		while (read_record(command_fd_new, request)) {
+			if (request.fingerprint != fingerprint) {
+				write_record(reply_fd_new, zygote_spawn_reply{});
+				continue;
+			}
+			const pid_t child{ fork() };
+			if (child < 0) {
+				write_record(reply_fd_new, zygote_spawn_reply{});
+				continue;
+			}
+			if (child == 0) {
+				close(command_fd_new);
+				std::signal(SIGCHLD, SIG_DFL);
+				serve_worker(reply_fd_new, *instance, worker, request.worker_id);
+			}
+		}
+		_exit(0);
+	}
+
+	// Body of one worker process - never returns
+	template<typename worker_function> [[noreturn]] static void serve_worker(int reply_fd_new, engine_type& instance, worker_function& worker, uint64_t worker_id) {
+		try {
+			instance.prepare_worker();
+		} catch (...) {
+			write_record(reply_fd_new, zygote_spawn_reply{});
+			_exit(1);
+		}
+		write_record(reply_fd_new, zygote_spawn_reply{ static_cast<int64_t>(getpid()), monotonic_nanoseconds() });
+		close(reply_fd_new);
+		int exit_code{ 1 };
+		try {
+			exit_code = worker(instance, worker_id);
+		} catch (...) {
+		}
+		_exit(exit_code);
+	}
+#endif
+};